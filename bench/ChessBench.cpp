@@ -0,0 +1,361 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+// Microbenchmarks for the board and move generation primitives. Prints one JSON object per line
+// (or CSV with --format csv) so two runs can be diffed directly
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "../include/ArgParse.h"
+#include "../include/BatchMoveGen.h"
+#include "../include/GameBoard.h"
+#include "../include/MoveSearcher.h"
+
+namespace {
+    // Fixed corpus: openings, middlegames, endgames and the special moves
+    constexpr const char* CORPUS_FENS[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b KQkq - 0 1",
+        "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+        "2r2rk1/1bqnbppp/p2ppn2/1p6/3NPP2/1BN1B3/PPPQ2PP/2KR3R w - - 0 14",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+        "rnbqkbnr/pp1ppppp/8/8/2pPP3/8/PPP2PPP/RNBQKBNR b KQkq d3 0 3",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N w - - 0 1",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+        "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    };
+
+    constexpr MoveType MOVE_TYPES[] = {MoveType::Standard, MoveType::DoublePawnPush, MoveType::ShortCastle, MoveType::LongCastle, MoveType::Promotion, MoveType::EnPassant};
+    constexpr PieceType PIECE_TYPES[] = {PieceType::King, PieceType::Queen, PieceType::Rook, PieceType::Knight, PieceType::Bishop, PieceType::Pawn};
+    // Work lists are repeated up to this size so one repetition is long enough to time
+    constexpr size_t MIN_WORK_ITEMS = 4096;
+
+    struct BenchOptions {
+        int warmup = 5;
+        int repetitions = 50;
+        int cpu = 0; // -1 leaves the thread unpinned
+        std::string filter;
+        std::string format = "json";
+
+        bool ParseArgs(int argc, char** argv) {
+            for (int i = 1; i < argc; i++) {
+                std::string arg = argv[i];
+                bool hasValue = i + 1 < argc;
+                if (arg == "--warmup" && hasValue) {
+                    if (!ParseNumber(arg, argv[++i], warmup)) return false;
+                } else if (arg == "--repetitions" && hasValue) {
+                    if (!ParseNumber(arg, argv[++i], repetitions)) return false;
+                    repetitions = std::max(1, repetitions);
+                } else if (arg == "--cpu" && hasValue) {
+                    if (!ParseNumber(arg, argv[++i], cpu)) return false;
+                } else if (arg == "--filter" && hasValue) {
+                    filter = argv[++i];
+                } else if (arg == "--format" && hasValue) {
+                    format = argv[++i];
+                }
+            }
+            return true;
+        }
+    };
+
+    template<typename T>
+    void DoNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T* sink;
+        sink = &value;
+#endif
+    }
+
+    bool PinThread(int cpu) {
+#ifdef __linux__
+        if (cpu < 0) return false;
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(cpu, &cpuSet);
+        return sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    const char* GetPieceName(PieceType pieceType) {
+        switch (pieceType) {
+            case PieceType::King: return "King";
+            case PieceType::Queen: return "Queen";
+            case PieceType::Rook: return "Rook";
+            case PieceType::Knight: return "Knight";
+            case PieceType::Bishop: return "Bishop";
+            case PieceType::Pawn: return "Pawn";
+            default: return "None";
+        }
+    }
+
+    const char* GetMoveTypeName(MoveType moveType) {
+        switch (moveType) {
+            case MoveType::Standard: return "Standard";
+            case MoveType::DoublePawnPush: return "DoublePawnPush";
+            case MoveType::ShortCastle: return "ShortCastle";
+            case MoveType::LongCastle: return "LongCastle";
+            case MoveType::Promotion: return "Promotion";
+            case MoveType::EnPassant: return "EnPassant";
+        }
+        return "Unknown";
+    }
+
+    template<typename T>
+    void RepeatToMinimum(std::vector<T> &items) {
+        if (items.empty()) return;
+        size_t count = items.size();
+        while (items.size() < MIN_WORK_ITEMS) {
+            items.push_back(items[items.size() % count]);
+        }
+    }
+
+    class BenchRunner {
+    public:
+        explicit BenchRunner(BenchOptions options) : options(std::move(options)) {}
+
+        void PrintHeader(bool pinned) const {
+            if (options.format == "csv") {
+                std::cout << "name,ops,repetitions,min_ns,median_ns,p99_ns,mean_ns\n";
+                return;
+            }
+            std::cout << "{\"benchmark\":\"chess_bench\",\"repetitions\":" << options.repetitions << ",\"warmup\":" << options.warmup
+                      << ",\"cpu\":" << options.cpu << ",\"pinned\":" << (pinned ? "true" : "false") << "}\n";
+        }
+
+        // setup runs untimed before every repetition, body returns the number of operations it did
+        void Run(const std::string &name, const std::function<void()> &setup, const std::function<uint64_t()> &body) {
+            if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+            uint64_t ops = 0;
+            for (int i = 0; i < options.warmup; i++) {
+                setup();
+                ops = body();
+            }
+
+            std::vector<double> nanosecondsPerOp;
+            nanosecondsPerOp.reserve(options.repetitions);
+            for (int i = 0; i < options.repetitions; i++) {
+                setup();
+                auto startTime = std::chrono::steady_clock::now();
+                ops = body();
+                auto endTime = std::chrono::steady_clock::now();
+                double nanoseconds = std::chrono::duration<double, std::nano>(endTime - startTime).count();
+                nanosecondsPerOp.push_back(nanoseconds / std::max<uint64_t>(ops, 1));
+            }
+            Print(name, ops, nanosecondsPerOp);
+        }
+
+    private:
+        void Print(const std::string &name, uint64_t ops, std::vector<double> &nanosecondsPerOp) const {
+            std::sort(nanosecondsPerOp.begin(), nanosecondsPerOp.end());
+            size_t count = nanosecondsPerOp.size();
+            double median = count % 2 == 1 ? nanosecondsPerOp[count / 2] : (nanosecondsPerOp[count / 2 - 1] + nanosecondsPerOp[count / 2]) / 2;
+            double p99 = nanosecondsPerOp[std::min(count - 1, static_cast<size_t>(std::ceil(count * 0.99)) - 1)];
+            double mean = std::accumulate(nanosecondsPerOp.begin(), nanosecondsPerOp.end(), 0.0) / count;
+
+            if (options.format == "csv") {
+                std::cout << name << ',' << ops << ',' << count << ',' << nanosecondsPerOp.front() << ','
+                          << median << ',' << p99 << ',' << mean << '\n';
+                return;
+            }
+            std::cout << "{\"name\":\"" << name << "\",\"ops\":" << ops << ",\"repetitions\":" << count
+                      << ",\"min_ns\":" << nanosecondsPerOp.front() << ",\"median_ns\":" << median
+                      << ",\"p99_ns\":" << p99 << ",\"mean_ns\":" << mean << "}\n";
+        }
+
+        BenchOptions options;
+    };
+
+    std::vector<std::unique_ptr<GameBoard>> LoadCorpus() {
+        std::vector<std::unique_ptr<GameBoard>> corpus;
+        for (const char* fen : CORPUS_FENS) {
+            std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+            if (!gameBoard->LoadFen(fen)) {
+                std::cerr << "Invalid corpus FEN: " << fen << '\n';
+                continue;
+            }
+            corpus.push_back(std::move(gameBoard));
+        }
+        return corpus;
+    }
+
+    void BenchValidMoves(BenchRunner &runner, const std::vector<std::unique_ptr<GameBoard>> &corpus) {
+        struct WorkItem {
+            size_t board;
+            PiecePosition position;
+        };
+
+        for (PieceType pieceType : PIECE_TYPES) {
+            std::vector<WorkItem> items;
+            for (size_t board = 0; board < corpus.size(); board++) {
+                for (short row = 0; row < GRID_SIZE; row++) {
+                    for (short col = 0; col < GRID_SIZE; col++) {
+                        PiecePosition position{row, col};
+                        if (corpus[board]->GetPiece(position).type == pieceType) items.push_back(WorkItem{board, position});
+                    }
+                }
+            }
+            RepeatToMinimum(items);
+
+            PieceMoveQuery moveQuery;
+            runner.Run(std::string("GetValidMoves/") + GetPieceName(pieceType), [] {}, [&] {
+                for (const WorkItem& item : items) {
+                    MoveSearcher::GetValidMoves(item.position, moveQuery, *corpus[item.board]);
+                    DoNotOptimize(moveQuery.moveCount);
+                }
+                return static_cast<uint64_t>(items.size());
+            });
+        }
+    }
+
+    void BenchExecuteMove(BenchRunner &runner, const std::vector<std::unique_ptr<GameBoard>> &corpus) {
+        struct WorkItem {
+            size_t board;
+            BoardMove boardMove;
+        };
+
+        BoardMoveQuery moveQuery;
+        for (MoveType moveType : MOVE_TYPES) {
+            std::vector<WorkItem> items;
+            for (size_t board = 0; board < corpus.size(); board++) {
+                MoveSearcher::GetAllMoves(moveQuery, *corpus[board]);
+                for (int i = 0; i < moveQuery.moveCount; i++) {
+                    if (moveQuery.moves[i].move.type == moveType) items.push_back(WorkItem{board, moveQuery.moves[i]});
+                }
+            }
+            if (items.empty()) {
+                std::cerr << "No " << GetMoveTypeName(moveType) << " moves in the corpus\n";
+                continue;
+            }
+            RepeatToMinimum(items);
+
+            // Every repetition starts from fresh copies, the copy itself is not timed
+            std::vector<GameBoard> boards(items.size());
+            runner.Run(std::string("ExecuteMove/") + GetMoveTypeName(moveType), [&] {
+                for (size_t i = 0; i < items.size(); i++) {
+                    boards[i] = *corpus[items[i].board];
+                }
+            }, [&] {
+                for (size_t i = 0; i < items.size(); i++) {
+                    boards[i].ExecuteMove(items[i].boardMove.move, items[i].boardMove.from);
+                    DoNotOptimize(boards[i]);
+                }
+                return static_cast<uint64_t>(items.size());
+            });
+        }
+    }
+
+    void BenchBoard(BenchRunner &runner, const std::vector<std::unique_ptr<GameBoard>> &corpus) {
+        std::vector<GameBoard> boards;
+        while (boards.size() < MIN_WORK_ITEMS / 4) {
+            boards.push_back(*corpus[boards.size() % corpus.size()]);
+        }
+
+        runner.Run("CalculateBitBoards", [] {}, [&] {
+            for (GameBoard& gameBoard : boards) {
+                ColorBitBoards whiteBitBoard = gameBoard.CalculateBitBoards(PieceColor::White);
+                ColorBitBoards blackBitBoard = gameBoard.CalculateBitBoards(PieceColor::Black);
+                DoNotOptimize(whiteBitBoard);
+                DoNotOptimize(blackBitBoard);
+            }
+            return static_cast<uint64_t>(boards.size() * 2);
+        });
+
+        std::vector<GameBoard> copies(boards.size());
+        runner.Run("BoardCopy", [] {}, [&] {
+            for (size_t i = 0; i < boards.size(); i++) {
+                copies[i] = boards[i];
+                DoNotOptimize(copies[i]);
+            }
+            return static_cast<uint64_t>(boards.size());
+        });
+
+        // Storage is pieces[col][row], so the column-major sweep walks memory in order
+        std::vector<PiecePosition> rowMajor;
+        std::vector<PiecePosition> columnMajor;
+        for (short row = 0; row < GRID_SIZE; row++) {
+            for (short col = 0; col < GRID_SIZE; col++) {
+                rowMajor.push_back(PiecePosition{row, col});
+            }
+        }
+        for (short col = 0; col < GRID_SIZE; col++) {
+            for (short row = 0; row < GRID_SIZE; row++) {
+                columnMajor.push_back(PiecePosition{row, col});
+            }
+        }
+        std::vector<PiecePosition> shuffled = rowMajor;
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+
+        auto runGetPiece = [&](const std::string &name, const std::vector<PiecePosition> &positions) {
+            runner.Run("GetPiece/" + name, [] {}, [&] {
+                int sum = 0;
+                for (const GameBoard& gameBoard : boards) {
+                    for (PiecePosition position : positions) {
+                        sum += static_cast<int>(gameBoard.GetPiece(position).type);
+                    }
+                }
+                DoNotOptimize(sum);
+                return static_cast<uint64_t>(boards.size() * positions.size());
+            });
+        };
+        runGetPiece("RowMajor", rowMajor);
+        runGetPiece("ColumnMajor", columnMajor);
+        runGetPiece("Random", shuffled);
+    }
+    void BenchCountLegalMoves(BenchRunner &runner, const std::vector<std::unique_ptr<GameBoard>> &corpus) {
+        std::vector<Position> positions;
+        while (positions.size() < MIN_WORK_ITEMS) {
+            positions.push_back(*corpus[positions.size() % corpus.size()]);
+        }
+        std::vector<uint32_t> counts(positions.size());
+
+        for (MoveGenKernel kernel : {MoveGenKernel::Reference, MoveGenKernel::Scalar, MoveGenKernel::Avx2, MoveGenKernel::Avx512}) {
+            if (!BatchMoveGen::IsSupported(kernel)) continue;
+            runner.Run(std::string("CountLegalMoves/") + BatchMoveGen::GetKernelName(kernel), [] {}, [&] {
+                BatchMoveGen::CountLegalMoves(positions, counts, kernel);
+                DoNotOptimize(counts.data());
+                return static_cast<uint64_t>(positions.size());
+            });
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!options.ParseArgs(argc, argv)) return 1;
+    bool pinned = PinThread(options.cpu);
+    if (options.cpu >= 0 && !pinned) std::cerr << "Could not pin to CPU " << options.cpu << ", timings may be noisy\n";
+
+    std::vector<std::unique_ptr<GameBoard>> corpus = LoadCorpus();
+    if (corpus.empty()) return 1;
+
+    BenchRunner runner(options);
+    runner.PrintHeader(pinned);
+    BenchValidMoves(runner, corpus);
+    BenchExecuteMove(runner, corpus);
+    BenchBoard(runner, corpus);
+    BenchCountLegalMoves(runner, corpus);
+    return 0;
+}
@@ -0,0 +1,73 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_ANALYSISCACHE_H
+#define CHESSENGINE_ANALYSISCACHE_H
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "TranspositionTable.h"
+
+static constexpr uint32_t ANALYSIS_CACHE_VERSION = 1;
+static constexpr size_t ANALYSIS_CACHE_DEFAULT_SIZE_MB = 64;
+// Shallower results are cheaper to search again than to keep
+static constexpr int ANALYSIS_CACHE_MIN_DEPTH = 3;
+// Searches running longer than this flush the mapping between iterations
+static constexpr std::chrono::seconds ANALYSIS_CACHE_FLUSH_INTERVAL{1};
+// Open addressing looks this many records past the home slot
+static constexpr uint64_t ANALYSIS_CACHE_PROBE_LENGTH = 4;
+
+struct AnalysisCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t entryCount;
+    uint8_t reserved[48]; // keeps the records cache line aligned
+};
+static_assert(sizeof(AnalysisCacheHeader) == 64);
+
+// The key is stored xored with the data, so a record torn by a concurrent writer fails the key check
+// instead of handing out another position's score
+struct AnalysisCacheRecord {
+    uint64_t checkedKey;
+    uint64_t data; // move, score, depth and bound as in TTEntry
+};
+static_assert(sizeof(AnalysisCacheRecord) == 16);
+
+// A transposition table in a shared file mapping, so deep results outlive the process. One process writes,
+// the file lock turns any other into a reader, and readers never block the writer
+class AnalysisCache {
+public:
+    AnalysisCache() = default;
+    ~AnalysisCache();
+    AnalysisCache(const AnalysisCache&) = delete;
+    AnalysisCache& operator=(const AnalysisCache&) = delete;
+
+    // Creates the file at the given size when missing, an existing file keeps its own size
+    bool Open(const std::string &path, size_t megabytes);
+    void Close();
+    bool IsOpen() const { return records != nullptr; }
+    bool IsWritable() const { return writable; }
+
+    // Scores are stored relative to the node, as TTEntry scores are
+    std::optional<TTEntry> Probe(uint64_t key) const;
+    void Store(const TTEntry &entry);
+    // Starts writing dirty pages back without waiting for them
+    void Flush() const;
+
+private:
+    static uint64_t PackData(const TTEntry &entry);
+    static TTEntry UnpackData(uint64_t key, uint64_t data);
+
+    int fileDescriptor = -1;
+    void* mapping = nullptr;
+    size_t mappingSize = 0;
+    AnalysisCacheRecord* records = nullptr;
+    uint64_t mask = 0;
+    bool writable = false;
+};
+
+
+#endif //CHESSENGINE_ANALYSISCACHE_H
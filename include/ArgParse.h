@@ -0,0 +1,26 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_ARGPARSE_H
+#define CHESSENGINE_ARGPARSE_H
+#include <charconv>
+#include <iostream>
+#include <string_view>
+#include <system_error>
+
+// Reads a whole flag value as a number. On bad input it reports a usage error and leaves value untouched
+template<typename T>
+bool ParseNumber(std::string_view flag, std::string_view text, T &value) {
+    T parsed {};
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed);
+    if (text.empty() || error != std::errc() || end != text.data() + text.size()) {
+        std::cerr << "Invalid value for " << flag << ": '" << text << "'\n";
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+
+#endif //CHESSENGINE_ARGPARSE_H
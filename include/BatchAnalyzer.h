@@ -0,0 +1,78 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_BATCHANALYZER_H
+#define CHESSENGINE_BATCHANALYZER_H
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Search.h"
+
+struct BatchOptions {
+    std::string inputPath = "-"; // "-" reads from stdin
+    int queueCapacity = 0; // lines read but not yet written, 0 picks a small multiple of the pool's worker count
+    SearchLimits limits {4};
+    std::string bitbaseDirectory;
+    std::string cachePath; // empty runs without the persistent analysis cache
+    size_t cacheSizeMb = ANALYSIS_CACHE_DEFAULT_SIZE_MB;
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+struct BatchJob {
+    uint64_t index;
+    std::string fen;
+};
+
+// Results arrive out of order from the workers; a fixed window of slots puts them back in input order
+class BatchReorderBuffer {
+public:
+    explicit BatchReorderBuffer(size_t capacity);
+
+    void Put(uint64_t index, std::string line);
+    // Returns false once every line up to the final count has been taken
+    bool TakeNext(std::string &line);
+    void SetTotal(uint64_t total);
+
+private:
+    std::vector<std::optional<std::string>> slots;
+    uint64_t nextIndex = 0;
+    std::optional<uint64_t> totalCount;
+    std::mutex mutex;
+    std::condition_variable slotReady;
+    std::condition_variable slotFree;
+};
+
+// Built on the pool worker that first needs it, so its table and stacks sit on that worker's node
+struct BatchWorker {
+    Searcher searcher;
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+};
+
+// Every FEN is one task on the shared thread pool, each worker reuses its own searcher
+class BatchAnalyzer {
+public:
+    explicit BatchAnalyzer(BatchOptions options);
+
+    // Streams one JSON object per input FEN, returns the process exit code
+    int Run(std::istream &input, std::ostream &output);
+    int Run();
+
+private:
+    std::unique_ptr<BatchWorker> CreateWorker();
+    std::string AnalyzeFen(Searcher &searcher, const std::unique_ptr<GameBoard> &gameBoard, const BatchJob &job) const;
+
+    BatchOptions options;
+    Bitbases bitbases;
+    AnalysisCache analysisCache;
+};
+
+
+#endif //CHESSENGINE_BATCHANALYZER_H
@@ -0,0 +1,63 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_BATCHMOVEGEN_H
+#define CHESSENGINE_BATCHMOVEGEN_H
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "MoveSearcher.h"
+
+enum class MoveGenKernel {
+    Reference, // MoveSearcher::GetLegalMoves one board at a time
+    Scalar, // the bitboard kernel one lane at a time, runs anywhere
+    Avx2, // four positions per instruction
+    Avx512 // eight positions per instruction
+};
+
+// Positions per kernel call, the widest kernel fills every lane at once
+static constexpr int MOVEGEN_BATCH_LANES = 8;
+
+// Bitboards of one batch, structure of arrays so each field loads straight into a vector register. Every lane is
+// flipped so the side to move plays up the board, which leaves the kernels a single pawn direction
+struct alignas(64) MoveGenBatch {
+    uint64_t ourPawns[MOVEGEN_BATCH_LANES];
+    uint64_t ourKnights[MOVEGEN_BATCH_LANES];
+    uint64_t ourDiagonal[MOVEGEN_BATCH_LANES]; // bishops and queens
+    uint64_t ourOrthogonal[MOVEGEN_BATCH_LANES]; // rooks and queens
+    uint64_t ourKing[MOVEGEN_BATCH_LANES];
+    uint64_t ourPieces[MOVEGEN_BATCH_LANES];
+    uint64_t theirPawns[MOVEGEN_BATCH_LANES];
+    uint64_t theirKnights[MOVEGEN_BATCH_LANES];
+    uint64_t theirDiagonal[MOVEGEN_BATCH_LANES];
+    uint64_t theirOrthogonal[MOVEGEN_BATCH_LANES];
+    uint64_t theirKing[MOVEGEN_BATCH_LANES];
+    uint64_t theirPieces[MOVEGEN_BATCH_LANES];
+    uint64_t castleTargets[MOVEGEN_BATCH_LANES]; // king destinations the castling rights still allow
+    uint64_t extraMoves[MOVEGEN_BATCH_LANES]; // counted outside the kernel: en passant, or every move of an odd lane
+};
+
+// Legal move counts for many independent positions at once, for perft leaves and bulk move counting. The kernels
+// give the same counts as MoveSearcher, en passant and positions without exactly one king per side are counted
+// by MoveSearcher while packing
+class BatchMoveGen {
+public:
+    // The widest kernel this CPU runs
+    static MoveGenKernel DetectKernel();
+    static bool IsSupported(MoveGenKernel kernel);
+    static const char* GetKernelName(MoveGenKernel kernel);
+    // Accepts the kernel names and "auto"
+    static std::optional<MoveGenKernel> ParseKernel(std::string_view name);
+
+    static void CountLegalMoves(std::span<const Position> positions, std::span<uint32_t> counts, MoveGenKernel kernel);
+    static uint32_t CountLegalMoves(const Position &position);
+
+private:
+    static void PackLane(const Position &position, MoveGenBatch &batch, int lane);
+};
+
+
+#endif //CHESSENGINE_BATCHMOVEGEN_H
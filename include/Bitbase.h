@@ -0,0 +1,110 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_BITBASE_H
+#define CHESSENGINE_BITBASE_H
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "GameBoard.h"
+#include "MappedFile.h"
+
+static constexpr int BITBASE_MAX_PIECES = 4;
+static constexpr uint32_t BITBASE_VERSION = 1;
+static constexpr const char* BITBASE_EXTENSION = ".bb";
+// A material key holds a 3 bit count per piece type and side, the first side in the low bits
+static constexpr int BITBASE_KEY_SIDE_SHIFT = 15;
+
+// Always from the point of view of the side to move
+enum class BitbaseResult : uint8_t {
+    Draw = 0,
+    Win = 1,
+    Loss = 2,
+    Unknown = 3
+};
+
+// Squares count from a1 = 0 to h8 = 63. The strong side moves up the board like white
+struct BitbasePiece {
+    PieceType type;
+    bool strong;
+    int square;
+};
+
+// Kings come first (strong, weak), then the other pieces in the order their material name lists them
+struct BitbasePosition {
+    std::array<BitbasePiece, BITBASE_MAX_PIECES> pieces;
+    int pieceCount;
+    bool strongToMove;
+};
+
+struct BitbaseMaterial {
+    std::string name;
+    std::vector<PieceType> strongPieces;
+    std::vector<PieceType> weakPieces;
+    bool hasPawns = false;
+    uint32_t key = 0; // GetKey of any position with this material, strong side first
+
+    // Names look like KRKP: strong king and pieces, then the weak king and pieces, in Q R B N P order
+    static std::optional<BitbaseMaterial> Parse(std::string_view materialName);
+    static std::string GetName(const BitbasePosition &position, bool strongFirst);
+    // Same material as GetName without building a string, for probing from the search
+    static uint32_t GetKey(const BitbasePosition &position, bool strongFirst);
+    static int GetPieceOrder(PieceType pieceType);
+    // Swaps the strong and weak sides, mirroring ranks so the new strong side still moves up
+    static BitbasePosition Flip(const BitbasePosition &position);
+
+    uint64_t GetPositionCount() const;
+    // Folds the position onto its symmetry class first, so any orientation can be indexed
+    uint64_t GetIndex(BitbasePosition position) const;
+    void Decode(uint64_t index, BitbasePosition &position) const;
+    void SortPieces(BitbasePosition &position) const;
+};
+
+struct BitbaseHeader {
+    char magic[4];
+    uint32_t version;
+    char material[8];
+    uint32_t bitsPerEntry;
+    uint32_t reserved;
+    uint64_t entryCount;
+};
+
+class BitbaseTable {
+public:
+    bool Open(const std::string &path);
+    const BitbaseMaterial& GetMaterial() const { return material; }
+    BitbaseResult Probe(uint64_t index, bool strongToMove) const;
+
+private:
+    MappedFile mappedFile;
+    BitbaseMaterial material;
+    const uint8_t* data = nullptr;
+    uint32_t bitsPerEntry = 0;
+    uint64_t entryCount = 0;
+};
+
+// Read-only after loading, one instance can be shared by every search thread
+class Bitbases {
+public:
+    // Loads every table file found in the directory, returns how many were loaded
+    int LoadDirectory(const std::string &directory);
+    bool IsEmpty() const { return tables.empty(); }
+    std::optional<BitbaseResult> Probe(const GameBoard &gameBoard) const;
+
+    // Describes the board with white as the strong side, nullopt above the piece limit
+    static std::optional<BitbasePosition> GetPosition(const GameBoard &gameBoard);
+
+private:
+    std::vector<std::unique_ptr<BitbaseTable>> tables;
+    std::unordered_map<uint32_t, const BitbaseTable*> tablesByKey;
+};
+
+
+#endif //CHESSENGINE_BITBASE_H
@@ -0,0 +1,66 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_BITBASEGENERATOR_H
+#define CHESSENGINE_BITBASEGENERATOR_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Bitbase.h"
+
+static constexpr int BITBASE_MAX_CHILDREN = 64;
+
+struct BitbaseGeneratorOptions {
+    std::string outputDirectory;
+    // Tables are generated in this order, a table can only look up the ones listed before it
+    // KRKR, KRKB and KRKN are only here so underpromotions in KRKP resolve exactly
+    std::vector<std::string> materials = {"KQK", "KRK", "KPK", "KBNK", "KQKR", "KRKR", "KRKB", "KRKN", "KRKP"};
+    int verifySamples = 2000;
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// Retrograde analysis by repeated forward passes over the index space until no position changes
+class BitbaseGenerator {
+public:
+    explicit BitbaseGenerator(BitbaseGeneratorOptions options);
+
+    int Run();
+    bool Generate(const std::string &materialName);
+    bool Write(const std::string &materialName) const;
+    // Compares the generator's legal move counts with MoveSearcher on random positions, returns mismatches
+    int Verify(const std::string &materialName) const;
+
+private:
+    // Extra states used only while generating, results keep the BitbaseResult values
+    static constexpr uint8_t UNRESOLVED = 4;
+    static constexpr uint8_t INVALID = 5;
+
+    struct GeneratedTable {
+        BitbaseMaterial material;
+        std::vector<std::atomic<uint8_t>> results;
+    };
+
+    // The body is called once per chunk of indices, [start, end)
+    void ParallelFor(uint64_t count, const std::function<void(uint64_t, uint64_t)> &body) const;
+    bool IsValid(const BitbasePosition &position) const;
+    int GetChildren(const BitbasePosition &position, std::array<BitbasePosition, BITBASE_MAX_CHILDREN> &children) const;
+    uint8_t GetChildState(const GeneratedTable &table, const BitbasePosition &parent, BitbasePosition child) const;
+    uint8_t Evaluate(const GeneratedTable &table, const BitbasePosition &position) const;
+    static bool IsAttacked(const BitbasePosition &position, int square, bool byStrong);
+    static bool IsInsufficientMaterial(const std::string &materialName);
+    static std::string GetFen(const BitbasePosition &position);
+
+    BitbaseGeneratorOptions options;
+    std::map<std::string, std::unique_ptr<GeneratedTable>> tables;
+};
+
+
+#endif //CHESSENGINE_BITBASEGENERATOR_H
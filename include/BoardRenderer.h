@@ -5,6 +5,7 @@
 #ifndef CHESSENGINE_BOARDRENDERER_H
 #define CHESSENGINE_BOARDRENDERER_H
 #include <bitset>
+#include <chrono>
 
 #include "GameBoard.h"
 #include "SFML/Graphics/RectangleShape.hpp"
@@ -12,9 +13,17 @@
 #include <unordered_map>
 
 #include "Debug.h"
+#include "FrameProfiler.h"
+#include "GameIndex.h"
 #include "MoveSearcher.h"
+#include "PositionPublisher.h"
+#include "Search.h"
+#include "Stats.h"
+#include "SFML/Graphics/Font.hpp"
 #include "SFML/Graphics/Sprite.hpp"
+#include "SFML/Graphics/Text.hpp"
 #include "SFML/Graphics/Texture.hpp"
+#include "SFML/Graphics/VertexArray.hpp"
 
 class MoveSearcher;
 
@@ -83,15 +92,43 @@ enum PieceLoadFlipMode {
 };
 
 static constexpr int TILE_SIZE = 60;
+static constexpr std::chrono::milliseconds STATS_REFRESH_INTERVAL{500};
+// Analysis arrows thin out and fade as a line falls this many centipawns behind the best one
+static constexpr int ARROW_SCORE_RANGE = 200;
+static constexpr float ARROW_MIN_WIDTH = 4;
+static constexpr float ARROW_MAX_WIDTH = 12;
+// Opening arrows and lines for the most played moves, the rest only count towards the total
+static constexpr size_t OPENING_SHOWN_MOVES = 6;
+
+// Rates over the last refresh interval, drawn over the board with --debug-stats
+struct StatsOverlayState {
+    std::optional<sf::Font> font;
+    bool fontSearched = false; // a missing font is reported once
+    std::optional<sf::Text> text;
+    StatsSnapshot lastSnapshot;
+    std::chrono::steady_clock::time_point lastRefresh;
+};
 
 class BoardRenderer {
 public:
-    BoardRenderer(std::unique_ptr<GameBoard> &gameboard, PieceColor viewColor,DebugOptions debugOptions);
+    // Starts from the published position and publishes every move it plays
+    BoardRenderer(PositionPublisher &positionPublisher, PieceColor viewColor,DebugOptions debugOptions);
 
     void Render(const std::unique_ptr<sf::RenderWindow>& window);
     void OnMouseDown(sf::Mouse::Button button, sf::Vector2i mousePosition);
     void OnMouseRelease(sf::Mouse::Button button, sf::Vector2i mousePosition);
     void LoadChessIcon(const std::unique_ptr<sf::RenderWindow> &window);
+    // Plays a move that did not come from the mouse, such as the engine's reply
+    void ApplyMove(const BoardMove &boardMove);
+    // Stops the mouse from moving pieces of a side the engine plays
+    void LockColor(PieceColor color);
+    // Rebuilds the analysis arrows, one per line from its first move
+    void SetAnalysisLines(const std::vector<PvLine> &lines);
+    // Rebuilds the opening arrows, wider for more games and greener for a better score of the side to move
+    void SetOpeningStats(const GameIndexQuery &query);
+    // Called once the frame is on screen, closing the frame and input latency measurements
+    void OnFrameDisplayed();
+    bool WriteFrameTimes(const std::string &path) const;
 private:
     sf::RectangleShape squares[GRID_SIZE][GRID_SIZE];
     std::unique_ptr<sf::Sprite> pieceSprites[GRID_SIZE][GRID_SIZE];
@@ -100,10 +137,23 @@ private:
     RenderTextures textures;
     std::optional<PiecePosition> selectedPiecePosition;
     SelectedPieceFollowState selectedPieceFollowState = Inactive;
-    std::unique_ptr<GameBoard>& gameBoard;
+    PositionPublisher& positionPublisher;
+    // The writer's own board, other threads only see the snapshots published from it
+    std::unique_ptr<GameBoard> gameBoard;
     PieceMoveQuery pieceMoveQuery;
     PieceColor viewColor;
+    std::optional<PieceColor> lockedColor;
     DebugOptions debugOptions;
+    StatsOverlayState statsOverlay;
+    // Every arrow in one triangle list, so the whole overlay is a single draw call
+    sf::VertexArray analysisArrows{sf::PrimitiveType::Triangles};
+    sf::VertexArray openingArrows{sf::PrimitiveType::Triangles};
+    // Needs the stats font, without one the arrows alone show the statistics
+    std::optional<sf::Text> openingText;
+    // Only exists with --debug-frame-times, every timer is a no-op without it
+    std::unique_ptr<FrameProfiler> frameProfiler;
+    std::optional<sf::Text> frameTimesText;
+    std::chrono::steady_clock::time_point frameTimesRefresh;
 
     void LoadGrid();
     void RenderGrid(const std::unique_ptr<sf::RenderWindow>& window);
@@ -113,6 +163,13 @@ private:
 
     void RenderPieces(const std::unique_ptr<sf::RenderWindow>& window);
     void RenderMovePositions(const std::unique_ptr<sf::RenderWindow>& window) const;
+    void RenderStats(const std::unique_ptr<sf::RenderWindow>& window);
+    void RenderFrameTimes(const std::unique_ptr<sf::RenderWindow>& window);
+    static void RenderTextPanel(const std::unique_ptr<sf::RenderWindow>& window, const sf::Text &text);
+    static void AppendArrow(sf::VertexArray &arrows, sf::Vector2f from, sf::Vector2f to, float width, sf::Color color);
+    sf::Vector2f GetSquareCenter(PiecePosition piecePosition) const;
+    void LoadStatsFont();
+    static std::string GetStatsSummary(const StatsSnapshot &snapshot, const StatsSnapshot &lastSnapshot);
     void LoadTextures();
     void LoadPieceTexture(PieceType piece, PieceColor pieceColor, const std::string &spriteName);
     void SelectSquare(PiecePosition piecePosition);
@@ -0,0 +1,166 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_CLUSTER_H
+#define CHESSENGINE_CLUSTER_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Search.h"
+
+static constexpr int CLUSTER_DEFAULT_PORT = 7460;
+// Root children are handed out, and below the first of them its own children as well
+static constexpr int CLUSTER_SPLIT_PLIES = 2;
+// Shared entries are collected this long before they go out as one message
+static constexpr std::chrono::milliseconds CLUSTER_SHARE_INTERVAL{20};
+static constexpr size_t CLUSTER_ENTRIES_PER_MESSAGE = 256;
+// Longer lines are a broken peer, the connection is dropped
+static constexpr size_t CLUSTER_MAX_LINE_LENGTH = 1 << 20;
+
+struct ClusterOptions {
+    std::string mode; // "worker" serves a coordinator, "search" coordinates
+    int port = CLUSTER_DEFAULT_PORT;
+    // The protocol has no authentication, a worker listens on loopback unless told otherwise
+    std::string bindAddress = "127.0.0.1";
+    std::vector<std::string> peers; // host:port of every worker
+    std::string fen; // the starting position when empty
+    int depth = 8;
+    size_t hashMb = TT_DEFAULT_SIZE_MB;
+    bool compare = false; // also search on this node alone and report the speedup
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// One TCP stream carrying newline separated messages, owned by a single thread
+struct ClusterConnection {
+    int fileDescriptor = -1;
+    std::string readBuffer;
+    std::string writeBuffer;
+
+    // Both return false once the other side is gone
+    bool ReadAvailable();
+    bool Flush();
+    bool TakeLine(std::string &line);
+    void Close();
+};
+
+// A subtree searched on one node: the moves from the root and the window, both from the subtree's side to move
+struct ClusterItem {
+    uint64_t id = 0;
+    std::vector<BoardMove> line;
+    Position position;
+    int depth = 0;
+    int alpha = -INFINITE_SCORE;
+    int beta = INFINITE_SCORE;
+};
+
+struct ClusterItemResult {
+    int score = 0;
+    uint64_t nodes = 0;
+};
+
+struct ClusterPeer {
+    std::string address;
+    ClusterConnection connection;
+    bool alive = false;
+    std::optional<ClusterItem> running;
+    uint64_t itemsSearched = 0;
+};
+
+// Serves one coordinator at a time, searching the subtrees it sends with its own board and table
+class ClusterWorker {
+public:
+    explicit ClusterWorker(ClusterOptions options);
+
+    int Run();
+
+private:
+    void Serve(ClusterConnection &connection);
+    void HandleLine(ClusterConnection &connection, const std::string &line);
+    void RunSearches();
+    void StopSearches();
+
+    ClusterOptions options;
+    Searcher searcher;
+    SharedEntries sharedEntries;
+    std::unique_ptr<GameBoard> rootBoard = std::make_unique<GameBoard>();
+    int wakeDescriptor = -1;
+
+    std::mutex mutex;
+    std::condition_variable itemReady;
+    std::deque<ClusterItem> items;
+    std::vector<std::string> replies;
+    std::optional<uint64_t> runningId;
+    std::atomic<bool> stopItem = false;
+    bool stopping = false;
+};
+
+// Splits the root young brothers wait style: the first move of a split node is searched before its siblings go out
+// with a null window, and a sibling that fails high is searched again with the full one. Items land round robin in
+// one queue per node, an idle node takes from its own queue first and steals from the longest one otherwise. A peer
+// that disconnects hands its running and queued items back to this node
+class ClusterCoordinator {
+public:
+    explicit ClusterCoordinator(ClusterOptions options);
+    ~ClusterCoordinator();
+
+    int Run();
+
+private:
+    void ConnectPeers();
+    int SearchNode(const Position &position, std::vector<BoardMove> &line, int depth, int alpha, int beta, int splitPlies);
+    ClusterItem MakeItem(const Position &position, std::vector<BoardMove> &line, const BoardMove &boardMove, int depth, int alpha, int beta);
+    std::vector<uint64_t> Submit(std::vector<ClusterItem> newItems);
+    std::pair<uint64_t, ClusterItemResult> WaitForAny(const std::unordered_set<uint64_t> &ids);
+    void Cancel(const std::unordered_set<uint64_t> &ids);
+    std::optional<ClusterItem> TakeItem(size_t node);
+    void Complete(uint64_t id, ClusterItemResult result);
+
+    void RunNetwork();
+    void RunLocalSearches();
+    void AssignPeerItems();
+    void HandlePeerLine(size_t peer, const std::string &line);
+    void DropPeer(size_t peer);
+    void Wake() const;
+
+    ClusterOptions options;
+    std::unique_ptr<GameBoard> rootBoard = std::make_unique<GameBoard>();
+    std::vector<BoardMove> rootOrder; // best first after every iteration
+    std::unordered_map<uint16_t, int> rootScores;
+    std::optional<BoardMove> bestMove;
+    int wakeDescriptor = -1;
+    std::thread networkThread;
+    std::thread localThread;
+    SharedEntries sharedEntries;
+
+    // Node 0 is this process, node i is peers[i - 1]
+    std::mutex mutex;
+    std::condition_variable itemReady;
+    std::condition_variable resultReady;
+    std::vector<ClusterPeer> peers;
+    std::vector<std::deque<ClusterItem>> queues;
+    std::unordered_set<uint64_t> activeIds;
+    std::unordered_map<uint64_t, ClusterItemResult> results;
+    std::vector<std::pair<size_t, uint64_t>> pendingStops;
+    std::optional<uint64_t> localRunningId;
+    std::atomic<bool> stopLocalItem = false;
+    uint64_t nextItemId = 1;
+    size_t nextQueue = 0;
+    uint64_t totalNodes = 0;
+    uint64_t localItemsSearched = 0;
+    uint64_t stolenItems = 0;
+    bool stopping = false;
+};
+
+
+#endif //CHESSENGINE_CLUSTER_H
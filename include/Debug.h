@@ -7,16 +7,40 @@
 #include <cstdint>
 #include <string>
 
+#include "ArgParse.h"
+
 enum DebugFlag : uint8_t {
     DebugNone       = 0,
     Occupancy  = 1 << 0,
     Attacks    = 1 << 1,
     Pinned     = 1 << 2,
     FreeMove    = 1 << 3,
+    StatsOverlay = 1 << 4,
+    FrameTimes = 1 << 5,
 };
 
 struct DebugOptions {
     uint8_t flags = DebugNone;
+    std::string tracePath; // empty leaves tracing off
+    uint32_t traceSampleInterval = 64;
+    std::string frameCsvPath = "frame_times.csv"; // written on exit with --debug-frame-times
+
+    bool ParseArgs(int argc, char** argv) {
+        for (int i = 0; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--debug-trace" && hasValue) {
+                tracePath = argv[++i];
+            } else if (arg == "--debug-trace-sample" && hasValue) {
+                if (!ParseNumber(arg, argv[++i], traceSampleInterval)) return false;
+            } else if (arg == "--debug-frame-csv" && hasValue) {
+                frameCsvPath = argv[++i];
+            } else {
+                ParseArg(arg);
+            }
+        }
+        return true;
+    }
 
     void ParseArg(const std::string& arg) {
         if (arg == "--debug-occupancy") {
@@ -27,6 +51,10 @@ struct DebugOptions {
             flags |= Pinned;
         } else if (arg == "--debug-free-move") {
             flags |= FreeMove;
+        } else if (arg == "--debug-stats") {
+            flags |= StatsOverlay;
+        } else if (arg == "--debug-frame-times") {
+            flags |= FrameTimes;
         }
     }
 };
@@ -0,0 +1,60 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_ENGINEOPPONENT_H
+#define CHESSENGINE_ENGINEOPPONENT_H
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "PolyglotBook.h"
+#include "PositionPublisher.h"
+#include "Search.h"
+#include "TimeManager.h"
+
+struct EngineOpponentOptions {
+    std::optional<PieceColor> color; // side the engine plays, none leaves both sides to the mouse
+    TimeControl timeControl {.baseMs = 300000, .incrementMs = 2000};
+    std::string bookPath = POLYGLOT_BOOK_PATH; // the engine searches every move when it is missing
+    std::string bookKeysPath = POLYGLOT_KEYS_PATH;
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// Plays one side of the GUI game on the engine's own clock, from the book while it has the position. Searches run
+// on a separate thread so the window keeps drawing, the main loop polls for the finished move
+class EngineOpponent {
+public:
+    explicit EngineOpponent(EngineOpponentOptions options);
+    ~EngineOpponent();
+
+    bool IsEnabled() const;
+    // Starts a search when it is the engine's turn and it has a legal move
+    void Update(const PositionPublisher &positionPublisher);
+    // Returns the finished move once, after charging the search to the engine clock
+    std::optional<BoardMove> PollMove();
+
+private:
+    EngineOpponentOptions options;
+    PolyglotBook book;
+    std::mt19937_64 bookRandom {std::random_device{}()};
+    Searcher searcher;
+    std::unique_ptr<GameBoard> searchBoard;
+    std::thread searchThread;
+    std::atomic<bool> searchDone = false;
+    std::atomic<bool> stopRequested = false; // the search's stop signal, set when the window closes mid-think
+    bool searching = false;
+    bool playedFromBook = false;
+    SearchResult searchResult;
+    std::chrono::steady_clock::time_point searchStart;
+    int64_t remainingMs = 0;
+    int movesMade = 0;
+};
+
+
+#endif //CHESSENGINE_ENGINEOPPONENT_H
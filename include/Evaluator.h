@@ -0,0 +1,41 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_EVALUATOR_H
+#define CHESSENGINE_EVALUATOR_H
+#include <array>
+#include <memory>
+#include <span>
+
+#include "GameBoard.h"
+
+// Tuner layout: one value per piece type, then one table per piece type from white's side, rank 8 first and file a first
+static constexpr int EVAL_PIECE_TYPES = 6;
+static constexpr int EVAL_TABLE_OFFSET = EVAL_PIECE_TYPES;
+static constexpr int EVAL_PARAMETER_COUNT = EVAL_TABLE_OFFSET + EVAL_PIECE_TYPES * BOARD_SIZE;
+// A table entry for each of at most 32 pieces plus the piece counts
+static constexpr int EVAL_MAX_COEFFICIENTS = EVAL_PIECE_TYPES + 4 * GRID_SIZE;
+
+struct EvalCoefficient {
+    int index;
+    int value;
+};
+
+class Evaluator {
+public:
+    // Centipawn score from the point of view of the side to move
+    static int Evaluate(const std::unique_ptr<GameBoard> &gameBoard);
+    static int GetPieceValue(PieceType pieceType);
+
+    static std::array<int, EVAL_PARAMETER_COUNT> GetParameters();
+    // The evaluation from white's side is the dot product of these coefficients with GetParameters(), returns the count
+    static int GetCoefficients(const GameBoard &gameBoard, std::span<EvalCoefficient, EVAL_MAX_COEFFICIENTS> coefficients);
+
+private:
+    static int GetSquareBonus(const Piece &piece, PiecePosition piecePosition);
+    static int GetTableIndex(const Piece &piece, PiecePosition piecePosition);
+};
+
+
+#endif //CHESSENGINE_EVALUATOR_H
@@ -0,0 +1,105 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_FRAMEPROFILER_H
+#define CHESSENGINE_FRAMEPROFILER_H
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// Values below 2^HISTOGRAM_SUB_BUCKET_BITS nanoseconds are exact, above that every power of two is split into
+// half as many linear buckets, so any recorded value is off by at most 1/32 (about 3%)
+static constexpr int HISTOGRAM_SUB_BUCKET_BITS = 6;
+static constexpr int HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+static constexpr int HISTOGRAM_HALF_SUB_BUCKETS = HISTOGRAM_SUB_BUCKETS / 2;
+// Values from 2^40 ns (about 18 minutes) on land in the last bucket
+static constexpr int HISTOGRAM_MAX_VALUE_BITS = 40;
+static constexpr int HISTOGRAM_BUCKET_COUNT = (HISTOGRAM_MAX_VALUE_BITS - HISTOGRAM_SUB_BUCKET_BITS + 2) * HISTOGRAM_HALF_SUB_BUCKETS;
+
+enum class FramePhase : uint8_t {
+    Grid,
+    MovePositions,
+    Pieces,
+    LoadGameBoard,
+    LoadMoveSprites,
+    Frame, // from the start of Render until display returns
+    InputLatency, // from a mouse press until the first frame drawn after it is displayed
+    Count
+};
+
+static constexpr int FRAME_PHASE_COUNT = static_cast<int>(FramePhase::Count);
+
+struct HistogramSummary {
+    uint64_t count = 0;
+    double meanNanoseconds = 0;
+    uint64_t maxNanoseconds = 0;
+    uint64_t p50Nanoseconds = 0;
+    uint64_t p90Nanoseconds = 0;
+    uint64_t p99Nanoseconds = 0;
+    uint64_t p999Nanoseconds = 0;
+};
+
+// Log-linear histogram of nanosecond durations in the style of HdrHistogram. Recording is a few relaxed atomic
+// adds, so any thread may record while another one summarises
+class LatencyHistogram {
+public:
+    void Record(uint64_t nanoseconds);
+    HistogramSummary Summarize() const;
+
+    static int GetBucketIndex(uint64_t nanoseconds);
+    // The smallest value landing in the bucket
+    static uint64_t GetBucketValue(int index);
+
+private:
+    std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKET_COUNT> buckets {};
+    std::atomic<uint64_t> count = 0;
+    std::atomic<uint64_t> totalNanoseconds = 0;
+    std::atomic<uint64_t> maxNanoseconds = 0;
+};
+
+// One histogram per GUI phase, shown with --debug-frame-times and written as CSV on exit
+class FrameProfiler {
+public:
+    void Record(FramePhase phase, std::chrono::steady_clock::duration duration);
+    void BeginFrame();
+    // Closes the frame and any input waiting for it, called once display returns
+    void EndFrame();
+    // Only the first press before a frame is timed, later ones are drawn by the same frame
+    void MarkInput();
+
+    HistogramSummary Summarize(FramePhase phase) const;
+    std::string GetOverlaySummary() const;
+    bool WriteCsv(const std::string &path) const;
+
+    static const char* GetPhaseName(FramePhase phase);
+
+private:
+    std::array<LatencyHistogram, FRAME_PHASE_COUNT> histograms;
+    std::chrono::steady_clock::time_point frameStart;
+    std::optional<std::chrono::steady_clock::time_point> pendingInput;
+};
+
+// Times its scope into the profiler, a null profiler leaves it as two dead pointer checks
+class ScopedFrameTimer {
+public:
+    ScopedFrameTimer(FrameProfiler* profiler, FramePhase phase) : profiler(profiler), phase(phase) {
+        if (profiler != nullptr) startTime = std::chrono::steady_clock::now();
+    }
+    ~ScopedFrameTimer() {
+        if (profiler != nullptr) profiler->Record(phase, std::chrono::steady_clock::now() - startTime);
+    }
+    ScopedFrameTimer(const ScopedFrameTimer&) = delete;
+    ScopedFrameTimer& operator=(const ScopedFrameTimer&) = delete;
+
+private:
+    FrameProfiler* profiler;
+    FramePhase phase;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+
+#endif //CHESSENGINE_FRAMEPROFILER_H
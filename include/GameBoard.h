@@ -10,6 +10,8 @@
 #include <locale>
 #include <memory>
 #include <optional>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 class GameBoard;
@@ -58,7 +60,7 @@ struct PiecePosition {
     short col;
 
     bool OutOfBounds() const {
-        return row >= BOARD_SIZE || col >= BOARD_SIZE || row < 0 || col < 0;
+        return row >= GRID_SIZE || col >= GRID_SIZE || row < 0 || col < 0;
     }
 
     PiecePosition operator+(const PiecePosition& other) const {
@@ -167,24 +169,37 @@ class GameBoard {
 public:
     void LoadDefaultBoard();
     void ClearBoard();
-
-    Piece &GetPiece(PiecePosition position);
+    // Returns false (leaving the board cleared) if the FEN string is malformed
+    bool LoadFen(const std::string& fen);
+
+    const Piece &GetPiece(PiecePosition position) const;
+    void SetPiece(PiecePosition position, Piece piece);
+    PieceColor GetSideToMove() const;
+    // Plies since the last capture or pawn move, for the fifty-move rule
+    int GetHalfmoveClock() const;
+    void SetHalfmoveClock(int clock);
     void MovePiece(PiecePosition from, PiecePosition to);
     void ExecuteMove(PieceMove move, PiecePosition piecePosition);
     void SetLastMove(PieceMove move, Piece piece);
-    PieceMoveHistory& GetLastMove();
-    bool RowOccupied(PiecePosition initialPosition, int direction, int checkCount);
-    ColorBitBoards& GetColorBitBoards(PieceColor pieceColor);
-    ColorBitBoards CalculateBitBoards(PieceColor pieceColor);
+    const PieceMoveHistory& GetLastMove() const;
+    const ColorBitBoards& GetColorBitBoards(PieceColor pieceColor) const;
+    void SetColorBitBoards(PieceColor pieceColor, ColorBitBoards colorBitBoards);
+    ColorBitBoards CalculateBitBoards(PieceColor pieceColor) const;
 
 private:
     void LoadPieceDeclarations(const std::vector<PieceDeclaration>& pieceDeclarations, PieceColor pieceColor, short row);
 
     Piece pieces[GRID_SIZE][GRID_SIZE] = {};
     PieceMoveHistory pieceMoveHistory = {};
+    int halfmoveClock = 0;
     ColorBitBoards whiteBitBoard = {};
     ColorBitBoards blackBitBoard = {};
 };
 
+// A board read through a const reference is a position. It holds no pointers, so a plain copy is a snapshot
+// that later moves on the original never touch
+using Position = GameBoard;
+static_assert(std::is_trivially_copyable_v<Position>);
+
 
 #endif //CHESSENGINE_GAMEBOARD_H
\ No newline at end of file
@@ -0,0 +1,181 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_GAMEINDEX_H
+#define CHESSENGINE_GAMEINDEX_H
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MoveSearcher.h"
+#include "PgnReader.h"
+#include "PositionPublisher.h"
+
+static constexpr uint32_t GAME_INDEX_VERSION = 1;
+// Records sorted in memory before they are spilled as one run, split across the reader threads
+static constexpr size_t GAME_INDEX_DEFAULT_MEMORY_MB = 256;
+// A query decodes whole blocks, so this bounds the work spent before the first matching record
+static constexpr size_t GAME_INDEX_BLOCK_RECORDS = 128;
+static constexpr size_t GAME_INDEX_DEFAULT_GAME_LIMIT = 10;
+
+enum class IndexedResult : uint8_t {
+    BlackWins,
+    Draw,
+    WhiteWins,
+    Unknown
+};
+
+struct GameIndexHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t recordCount;
+    uint64_t gameCount;
+    uint64_t blockCount;
+    uint64_t dataEnd; // the end of the last block
+    uint64_t blockTableOffset; // the GameIndexBlock table, aligned after the last block
+    uint8_t reserved[16];
+};
+static_assert(sizeof(GameIndexHeader) == 64);
+
+// Blocks are found by binary search on the first key. Inside a block every record is three varints: the key
+// as a delta from the previous one, the game offset as a delta when the key repeats and whole otherwise, and
+// the packed move shifted left by two with the result in the low bits
+struct GameIndexBlock {
+    uint64_t firstKey;
+    uint64_t offset;
+};
+static_assert(sizeof(GameIndexBlock) == 16);
+
+// One position of one game in the sort runs. The move is packed as in TTEntry, 0 where the game ended
+struct GameIndexRecord {
+    uint64_t key;
+    uint64_t gameOffset;
+    uint16_t move;
+    IndexedResult result;
+    uint8_t reserved[5];
+
+    bool operator<(const GameIndexRecord &other) const {
+        if (key != other.key) return key < other.key;
+        if (gameOffset != other.gameOffset) return gameOffset < other.gameOffset;
+        return move < other.move;
+    }
+};
+static_assert(sizeof(GameIndexRecord) == 24);
+
+struct GameIndexScore {
+    uint64_t games = 0;
+    uint64_t whiteWins = 0;
+    uint64_t draws = 0;
+    uint64_t blackWins = 0;
+
+    void Add(IndexedResult result);
+    // Points per decided game for the given side, 0.5 when no game has a known result
+    double GetScore(PieceColor color) const;
+};
+
+struct GameIndexMoveStats {
+    BoardMove boardMove;
+    GameIndexScore score;
+};
+
+struct GameIndexQuery {
+    GameIndexScore total; // every game reaching the position, including those that ended there
+    std::vector<GameIndexMoveStats> moves; // most played first
+    std::vector<uint64_t> gameOffsets; // byte offsets into the indexed PGN, up to the requested limit
+};
+
+struct GameIndexOptions {
+    std::string mode; // "build" writes an index, "query" reads one
+    std::string pgnPath;
+    std::string indexPath;
+    std::string fen; // the starting position when empty
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t memoryMb = GAME_INDEX_DEFAULT_MEMORY_MB;
+    std::string tempDirectory; // next to the index when empty
+    int maxPly = 0; // 0 indexes every position of every game
+    size_t gameLimit = GAME_INDEX_DEFAULT_GAME_LIMIT;
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// Read-only view of an index file, queries only touch the blocks holding the position
+class GameIndex {
+public:
+    bool Open(const std::string &path);
+    bool IsOpen() const { return header != nullptr; }
+    uint64_t GetGameCount() const { return header->gameCount; }
+
+    GameIndexQuery Query(const Position &position, size_t gameLimit = 0) const;
+
+private:
+    size_t FindFirstBlock(uint64_t key) const;
+
+    MappedFile mappedFile;
+    const GameIndexHeader* header = nullptr;
+    const GameIndexBlock* blocks = nullptr;
+};
+
+// Replays the games on every reader thread, each thread sorts and spills its own runs, then one k-way merge
+// streams the runs into the block file. Only the runs' buffers live in memory, so the collection may be
+// larger than RAM
+class GameIndexBuilder {
+public:
+    explicit GameIndexBuilder(GameIndexOptions options);
+
+    int Run();
+
+private:
+    struct ThreadRun {
+        std::vector<GameIndexRecord> records;
+        std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    };
+
+    void IndexGame(const PgnGame &game);
+    bool SpillRun(std::vector<GameIndexRecord> &records);
+    bool MergeRuns();
+    std::string GetRunPath(size_t run) const;
+    void RemoveRuns() const;
+
+    GameIndexOptions options;
+    size_t runCapacity = 0;
+    uint64_t recordCount = 0;
+    uint64_t gameCount = 0;
+    std::atomic<bool> failed = false;
+
+    std::mutex mutex;
+    std::unordered_map<std::thread::id, ThreadRun> threadRuns;
+    size_t runCount = 0;
+};
+
+struct OpeningExplorerOptions {
+    std::string indexPath; // empty leaves the explorer off
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// Looks up the GUI position in an index whenever a new one is published
+class OpeningExplorer {
+public:
+    explicit OpeningExplorer(OpeningExplorerOptions options);
+
+    bool IsEnabled() const;
+    // The statistics of a newly published position, nothing while the position is unchanged
+    std::optional<GameIndexQuery> Update(const PositionPublisher &positionPublisher);
+
+private:
+    OpeningExplorerOptions options;
+    GameIndex gameIndex;
+    uint64_t positionVersion = 0;
+};
+
+
+#endif //CHESSENGINE_GAMEINDEX_H
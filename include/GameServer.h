@@ -0,0 +1,149 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_GAMESERVER_H
+#define CHESSENGINE_GAMESERVER_H
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Search.h"
+
+// Longer lines are a broken or hostile client, the session is dropped
+static constexpr size_t SERVER_MAX_LINE_LENGTH = 4096;
+// Unprocessed input a session may hold, reading pauses above it and a client still past it is dropped
+static constexpr size_t SERVER_MAX_BUFFERED_INPUT = 4 * SERVER_MAX_LINE_LENGTH;
+// Unsent replies a session may hold, reading and command handling pause above it
+static constexpr size_t SERVER_MAX_BUFFERED_OUTPUT = 64 * 1024;
+// A client that leaves its replies unread this long past the output limit is dropped
+static constexpr std::chrono::seconds SERVER_OUTPUT_STALL_TIMEOUT{10};
+// Move latencies kept for the percentiles
+static constexpr size_t SERVER_LATENCY_WINDOW = 1 << 16;
+
+struct GameServerOptions {
+    int port = 0; // 0 leaves TCP off
+    std::string unixPath; // empty leaves the Unix socket off
+    int workers = 0; // 0 uses every hardware thread
+    size_t maxSessions = 10000; // boards are allocated for this many up front
+    size_t queueCapacity = 0; // 0 picks a small multiple of the worker count
+    uint64_t nodeBudget = 200000; // per engine request
+    uint64_t sessionNodeBudget = 0; // per session over its lifetime, 0 means unlimited
+    size_t hashMb = 4; // per worker
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// Boards for every session are made at startup, so connecting never allocates one
+class GameBoardPool {
+public:
+    explicit GameBoardPool(size_t capacity);
+
+    // Returns nothing when every board is in use
+    std::unique_ptr<GameBoard> Acquire();
+    void Release(std::unique_ptr<GameBoard> gameBoard);
+    size_t GetFreeCount() const { return freeBoards.size(); }
+
+private:
+    std::vector<std::unique_ptr<GameBoard>> freeBoards;
+};
+
+enum class EngineRequest {
+    Go, // reports the best move
+    Play, // reports and plays it
+    Analyze // reports every multi-PV line
+};
+
+struct ServerSession {
+    int fileDescriptor = -1;
+    std::unique_ptr<GameBoard> gameBoard;
+    std::string readBuffer;
+    std::string writeBuffer;
+    bool waitingForEngine = false; // reads pause until the reply, so replies keep their order
+    bool closeAfterWrite = false;
+    bool watchingReads = true;
+    bool watchingWrites = false;
+    std::optional<std::chrono::steady_clock::time_point> outputFullSince; // set while over SERVER_MAX_BUFFERED_OUTPUT
+    uint64_t nodesUsed = 0;
+};
+
+struct EngineJob {
+    uint64_t sessionId;
+    EngineRequest request;
+    GameBoard gameBoard;
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point queuedTime;
+};
+
+struct EngineReply {
+    uint64_t sessionId;
+    EngineRequest request;
+    SearchResult result;
+    std::chrono::steady_clock::time_point queuedTime;
+};
+
+// One epoll loop owns every socket and session, searches run on a fixed pool of workers. A session has at most
+// one request queued or running, so the FIFO queue serves sessions round robin, and a full queue refuses work
+// instead of letting latency grow without bound
+class GameServer {
+public:
+    explicit GameServer(GameServerOptions options);
+    ~GameServer();
+
+    // Runs until SIGINT or SIGTERM, returns the process exit code
+    int Run();
+
+private:
+    bool OpenListeners();
+    void AcceptConnections(int listenDescriptor);
+    void ReadSession(uint64_t sessionId);
+    void ProcessLines(uint64_t sessionId);
+    void HandleCommand(uint64_t sessionId, ServerSession &session, const std::string &line);
+    void QueueEngineJob(uint64_t sessionId, ServerSession &session, EngineRequest request, std::istringstream &arguments);
+    void DeliverReplies();
+    void WriteReply(ServerSession &session, const EngineReply &reply);
+    void Send(uint64_t sessionId, ServerSession &session, const std::string &text);
+    void FlushSession(uint64_t sessionId, ServerSession &session);
+    void CloseSession(uint64_t sessionId);
+    void UpdateInterest(uint64_t sessionId, ServerSession &session);
+    void DropStalledSessions();
+    std::string GetStats();
+
+    void RunWorker();
+    void StopWorkers();
+
+    GameServerOptions options;
+    GameBoardPool boardPool;
+    int epollDescriptor = -1;
+    int wakeDescriptor = -1;
+    int signalDescriptor = -1;
+    std::vector<int> listenDescriptors;
+    std::unordered_map<uint64_t, ServerSession> sessions;
+    uint64_t nextSessionId = 0;
+    size_t fullSessions = 0; // sessions with outputFullSince set
+
+    std::deque<EngineJob> jobs;
+    std::vector<EngineReply> replies;
+    bool stopping = false;
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::mutex replyMutex;
+    std::vector<std::thread> workers;
+
+    std::vector<double> latencies; // milliseconds, a ring of the latest SERVER_LATENCY_WINDOW
+    uint64_t completedRequests = 0;
+    uint64_t rejectedRequests = 0;
+    size_t peakSessions = 0;
+};
+
+
+#endif //CHESSENGINE_GAMESERVER_H
@@ -0,0 +1,45 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_GAMETRACKER_H
+#define CHESSENGINE_GAMETRACKER_H
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "MoveSearcher.h"
+
+static constexpr int FIFTY_MOVE_PLIES = 100;
+
+enum class GameResult {
+    WhiteWins,
+    BlackWins,
+    Draw
+};
+
+struct GameEnd {
+    GameResult result;
+    std::string reason;
+};
+
+// Position history of one game, shared by the headless game loops to apply the rules of chess
+class GameTracker {
+public:
+    void Reset(const GameBoard &gameBoard);
+    // Call after every executed move
+    void Push(const GameBoard &gameBoard);
+    // Fills moveQuery with the legal moves, returns why the game is over if it is
+    std::optional<GameEnd> GetGameEnd(const std::unique_ptr<GameBoard> &gameBoard, BoardMoveQuery &moveQuery) const;
+    int GetRepetitions(const GameBoard &gameBoard) const;
+
+    static bool IsInsufficientMaterial(const GameBoard &gameBoard);
+
+private:
+    std::vector<uint64_t> keys;
+};
+
+
+#endif //CHESSENGINE_GAMETRACKER_H
@@ -0,0 +1,119 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_GEOMETRY_H
+#define CHESSENGINE_GEOMETRY_H
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#include "GameBoard.h"
+
+// Bit masks indexed by square (row * GRID_SIZE + col, as in ColorBitBoards). Everything is computed by the
+// compiler, so the tables sit in read-only data and cost nothing at startup
+
+enum CastleSide {
+    ShortCastleSide,
+    LongCastleSide
+};
+
+struct CastleGeometry {
+    int kingSquare;
+    int rookSquare;
+    int kingTarget;
+    uint64_t path; // squares between king and rook, all must be empty
+    uint64_t safety; // the king's square and the one it passes, neither may be attacked
+};
+
+struct GeometryTables {
+    std::array<uint64_t, BOARD_SIZE> knightAttacks;
+    std::array<uint64_t, BOARD_SIZE> kingAttacks;
+    // Indexed by the pawn's color, so [defender][square] also holds where enemy pawns attack the square from
+    std::array<std::array<uint64_t, BOARD_SIZE>, 2> pawnAttacks;
+    std::array<uint64_t, BOARD_SIZE> orthogonalRays; // everything a rook reaches on an empty board
+    std::array<uint64_t, BOARD_SIZE> diagonalRays;
+    // Squares strictly between two squares sharing a line, 0 when they share none
+    std::array<std::array<uint64_t, BOARD_SIZE>, BOARD_SIZE> between;
+    // The whole line through two squares, both included, 0 when they share none
+    std::array<std::array<uint64_t, BOARD_SIZE>, BOARD_SIZE> line;
+    std::array<std::array<CastleGeometry, 2>, 2> castles; // [color][CastleSide]
+};
+
+class Geometry {
+public:
+    static constexpr int GetSquare(int row, int col) {
+        return row * GRID_SIZE + col;
+    }
+
+    static constexpr PiecePosition GetPosition(int square) {
+        return PiecePosition{static_cast<short>(square / GRID_SIZE), static_cast<short>(square % GRID_SIZE)};
+    }
+
+    static constexpr uint64_t GetSquareMask(int row, int col) {
+        return row < 0 || row >= GRID_SIZE || col < 0 || col >= GRID_SIZE ? 0 : 1ULL << GetSquare(row, col);
+    }
+
+    static constexpr GeometryTables BuildTables() {
+        constexpr int KNIGHT_OFFSETS[8][2] = {{2, 1}, {1, 2}, {-1, 2}, {-2, 1}, {-2, -1}, {-1, -2}, {1, -2}, {2, -1}};
+        constexpr int DIRECTIONS[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+        GeometryTables tables{};
+        for (int square = 0; square < BOARD_SIZE; square++) {
+            int row = square / GRID_SIZE;
+            int col = square % GRID_SIZE;
+            for (const auto& offset : KNIGHT_OFFSETS) {
+                tables.knightAttacks[square] |= GetSquareMask(row + offset[0], col + offset[1]);
+            }
+            for (const auto& direction : DIRECTIONS) {
+                tables.kingAttacks[square] |= GetSquareMask(row + direction[0], col + direction[1]);
+            }
+            tables.pawnAttacks[static_cast<int>(PieceColor::White)][square] = GetSquareMask(row + 1, col - 1) | GetSquareMask(row + 1, col + 1);
+            tables.pawnAttacks[static_cast<int>(PieceColor::Black)][square] = GetSquareMask(row - 1, col - 1) | GetSquareMask(row - 1, col + 1);
+
+            for (int d = 0; d < 8; d++) {
+                uint64_t ray = 0;
+                for (int distance = 1; GetSquareMask(row + DIRECTIONS[d][0] * distance, col + DIRECTIONS[d][1] * distance) != 0; distance++) {
+                    int target = GetSquare(row + DIRECTIONS[d][0] * distance, col + DIRECTIONS[d][1] * distance);
+                    tables.between[square][target] = ray;
+                    ray |= 1ULL << target;
+                }
+                (d < 4 ? tables.orthogonalRays : tables.diagonalRays)[square] |= ray;
+
+                // The full line is this ray, the opposite one and the square itself
+                uint64_t opposite = 0;
+                for (int distance = 1; GetSquareMask(row - DIRECTIONS[d][0] * distance, col - DIRECTIONS[d][1] * distance) != 0; distance++) {
+                    opposite |= GetSquareMask(row - DIRECTIONS[d][0] * distance, col - DIRECTIONS[d][1] * distance);
+                }
+                for (uint64_t targets = ray; targets != 0; targets &= targets - 1) {
+                    tables.line[square][std::countr_zero(targets)] = ray | opposite | 1ULL << square;
+                }
+            }
+        }
+
+        // The king starts on col 3 with the short side rook on col 0 and the long side rook on col 7
+        for (int color = 0; color < 2; color++) {
+            int homeRow = color == static_cast<int>(PieceColor::White) ? 0 : GRID_SIZE - 1;
+            int kingSquare = GetSquare(homeRow, 3);
+            tables.castles[color][ShortCastleSide] = MakeCastle(tables, kingSquare, GetSquare(homeRow, 0), GetSquare(homeRow, 1));
+            tables.castles[color][LongCastleSide] = MakeCastle(tables, kingSquare, GetSquare(homeRow, GRID_SIZE - 1), GetSquare(homeRow, 5));
+        }
+        return tables;
+    }
+
+private:
+    static constexpr CastleGeometry MakeCastle(const GeometryTables &tables, int kingSquare, int rookSquare, int kingTarget) {
+        uint64_t passed = tables.between[kingSquare][kingTarget];
+        return CastleGeometry{kingSquare, rookSquare, kingTarget, tables.between[kingSquare][rookSquare], 1ULL << kingSquare | passed};
+    }
+};
+
+inline constexpr GeometryTables GEOMETRY = Geometry::BuildTables();
+
+static_assert(GEOMETRY.knightAttacks[0] == (1ULL << 10 | 1ULL << 17));
+static_assert(GEOMETRY.between[0][63] == 0x0040201008040200ULL);
+static_assert(GEOMETRY.line[9][18] == 0x8040201008040201ULL);
+static_assert(GEOMETRY.between[0][10] == 0 && GEOMETRY.line[0][10] == 0);
+
+
+#endif //CHESSENGINE_GEOMETRY_H
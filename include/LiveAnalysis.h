@@ -0,0 +1,63 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_LIVEANALYSIS_H
+#define CHESSENGINE_LIVEANALYSIS_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "PositionPublisher.h"
+#include "Search.h"
+
+// The GUI picks up new lines at most this often, however fast the search finds them
+static constexpr std::chrono::milliseconds ANALYSIS_REFRESH_INTERVAL{100};
+
+struct LiveAnalysisOptions {
+    int multiPv = 0; // lines to show, 0 leaves analysis off
+    std::string cachePath; // empty forgets the analysis on exit
+    size_t cacheSizeMb = ANALYSIS_CACHE_DEFAULT_SIZE_MB;
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// Searches the GUI position without limit on a background thread, restarting whenever the position changes.
+// The search publishes each finished line and never waits for the GUI to take it
+class LiveAnalysis {
+public:
+    explicit LiveAnalysis(LiveAnalysisOptions options);
+    ~LiveAnalysis();
+
+    bool IsEnabled() const;
+    // Restarts the search when a new position has been published
+    void Update(const PositionPublisher &positionPublisher);
+    // The latest lines when they changed and the refresh interval has passed
+    std::optional<SearchResult> PollResult();
+
+private:
+    void Stop();
+    void Publish(const SearchResult &result, bool wait);
+
+    LiveAnalysisOptions options;
+    AnalysisCache analysisCache;
+    Searcher searcher;
+    std::unique_ptr<GameBoard> searchBoard;
+    std::thread searchThread;
+    std::atomic<bool> stopSignal = false;
+    uint64_t positionVersion = 0;
+
+    std::mutex resultMutex;
+    SearchResult latestResult;
+    uint64_t latestVersion = 0;
+    uint64_t polledVersion = 0;
+    std::chrono::steady_clock::time_point lastPoll;
+};
+
+
+#endif //CHESSENGINE_LIVEANALYSIS_H
@@ -0,0 +1,42 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_MAPPEDFILE_H
+#define CHESSENGINE_MAPPEDFILE_H
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+enum class MappedFileAccess {
+    Sequential,
+    Random
+};
+
+// Read-only view of a whole file. Pages are shared with every other process mapping the same file, except on
+// platforms without mmap, where the file is read into memory
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::string &path, MappedFileAccess access);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr || (fileDescriptor >= 0 && size == 0); }
+    const char* GetData() const { return static_cast<const char*>(data); }
+    size_t GetSize() const { return size; }
+    std::string_view GetView() const { return {GetData(), size}; }
+
+private:
+    int fileDescriptor = -1;
+    void* data = nullptr;
+    size_t size = 0;
+};
+
+
+#endif //CHESSENGINE_MAPPEDFILE_H
@@ -0,0 +1,111 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_MATCHRUNNER_H
+#define CHESSENGINE_MATCHRUNNER_H
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "GameTracker.h"
+#include "PolyglotBook.h"
+#include "Search.h"
+
+// Games are capped here even without a draw rule firing, a safety net for broken openings
+static constexpr int MATCH_MAX_PLIES = 1024;
+
+struct EngineConfig {
+    std::string name;
+    SearchLimits limits;
+    std::string bitbaseDirectory;
+    std::string bookPath; // Polyglot book played from before searching, the engine searches every move without one
+
+    // Comma separated key=value pairs, e.g. name=dev,depth=6,nodes=20000,bitbases=../bitbases,book=book.bin
+    bool Parse(const std::string &spec);
+    bool HasLimit() const;
+};
+
+struct SprtOptions {
+    bool enabled = false;
+    double elo0 = 0;
+    double elo1 = 5;
+    double alpha = 0.05;
+    double beta = 0.05;
+
+    double GetLowerBound() const;
+    double GetUpperBound() const;
+};
+
+struct MatchOptions {
+    std::array<EngineConfig, 2> engines {EngineConfig{"engine1"}, EngineConfig{"engine2"}};
+    TimeControl timeControl;
+    SprtOptions sprt;
+    std::string openingsPath; // EPD, or PGN when the name ends in .pgn, empty starts every game from the initial position
+    int openingPlies = 8; // moves taken from each PGN opening
+    int games = 1000; // upper bound, SPRT usually stops earlier
+    std::string pgnPath;
+    std::string bookKeysPath = POLYGLOT_KEYS_PATH;
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+struct MatchOpening {
+    std::string fen; // empty for the initial position
+    std::vector<BoardMove> moves;
+};
+
+struct GameRecord {
+    uint64_t round = 0;
+    int whiteEngine = 0;
+    std::string fen;
+    std::vector<std::string> sanMoves;
+    GameResult result = GameResult::Draw;
+    std::string reason;
+    bool timeForfeit = false;
+};
+
+// Pairs of games share an opening with colours reversed, so SPRT counts pair scores (pentanomial)
+struct MatchScore {
+    uint64_t wins = 0;
+    uint64_t draws = 0;
+    uint64_t losses = 0;
+    std::array<uint64_t, 5> pairs {}; // indexed by half points the first engine scored in the pair
+
+    double GetEloDifference() const;
+    double GetLogLikelihoodRatio(double elo0, double elo1) const;
+};
+
+// Every game is one task on the shared thread pool, an SPRT decision cancels the games not yet started
+class MatchRunner {
+public:
+    explicit MatchRunner(MatchOptions options);
+
+    // Returns the process exit code
+    int Run();
+
+private:
+    bool LoadOpenings();
+    std::unique_ptr<std::array<Searcher, 2>> CreateSearchers() const;
+    GameRecord PlayGame(std::array<Searcher, 2> &searchers, uint64_t gameIndex) const;
+    // Returns true once SPRT has accepted either hypothesis
+    bool RecordGame(const GameRecord &gameRecord);
+    std::string GetPgn(const GameRecord &gameRecord) const;
+
+    MatchOptions options;
+    std::array<Bitbases, 2> bitbases;
+    std::array<PolyglotBook, 2> books;
+    std::vector<MatchOpening> openings;
+
+    std::mutex resultMutex;
+    MatchScore score;
+    std::vector<int8_t> gamePoints; // half points of the first engine per finished game, -1 while running
+    std::ofstream pgnOutput;
+};
+
+
+#endif //CHESSENGINE_MATCHRUNNER_H
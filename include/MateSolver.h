@@ -0,0 +1,113 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_MATESOLVER_H
+#define CHESSENGINE_MATESOLVER_H
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MoveSearcher.h"
+#include "Zobrist.h"
+
+static constexpr int MATE_SOLVER_MAX_MOVES = 30;
+static constexpr size_t MATE_SOLVER_DEFAULT_TABLE_MB = 64;
+// Proof and disproof numbers saturate here, a proven node has a disproof number of infinity and the reverse
+static constexpr uint32_t PROOF_INFINITY = 1u << 30;
+
+struct MateSolverOptions {
+    std::string fen;
+    int maxMoves = 10;
+    size_t tableMb = MATE_SOLVER_DEFAULT_TABLE_MB;
+    uint64_t nodes = 0; // 0 means unlimited
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// depth counts the attacker moves left: the fewest needed once proven, the most tried once disproven,
+// and the exact budget while still open
+struct ProofEntry {
+    uint64_t key;
+    uint32_t proofNumber;
+    uint32_t disproofNumber;
+    uint32_t work; // nodes spent below this one, garbage collection keeps the expensive entries
+    uint16_t depth;
+};
+static_assert(sizeof(ProofEntry) == 24);
+
+// Buckets of a few entries. A full bucket evicts its cheapest entry, and a table that fills up
+// sweeps out every entry that took little work to find
+class ProofTable {
+public:
+    static constexpr int BUCKET_SIZE = 4;
+
+    void Resize(size_t megabytes);
+    void Clear();
+
+    const ProofEntry* Probe(uint64_t key, int depth) const;
+    void Store(uint64_t key, int depth, uint32_t proofNumber, uint32_t disproofNumber, uint32_t work);
+
+private:
+    void CollectGarbage();
+
+    std::vector<ProofEntry> entries;
+    uint64_t bucketMask = 0;
+    size_t used = 0;
+    uint32_t collectThreshold = 1;
+};
+
+struct ProofNumbers {
+    uint32_t proofNumber;
+    uint32_t disproofNumber;
+    int depth;
+};
+
+struct MateSolverResult {
+    bool mate = false;
+    int moves = 0; // mate in this many attacker moves
+    std::vector<BoardMove> line;
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+};
+
+// Depth-first proof-number search over the attacker's checks and the defender's evasions only. Each mate length
+// is tried in turn, so the first proof is the shortest mate. Positions repeating the current line count as
+// disproven, which can hide a mate reached through a transposition but never reports a false one
+class MateSolver {
+public:
+    explicit MateSolver(MateSolverOptions options);
+
+    // Returns the process exit code
+    int Run();
+    MateSolverResult Solve(const std::unique_ptr<GameBoard> &gameBoard, int maxMoves);
+
+private:
+    struct ChildNode {
+        BoardMove move;
+        uint64_t key;
+        ProofNumbers numbers;
+    };
+
+    // Searches below the node until either number reaches its threshold
+    ProofNumbers SearchNode(int ply, int depth, uint32_t proofThreshold, uint32_t disproofThreshold);
+    // Fills the frame and returns true, or returns false with the numbers of a node that has no children to search
+    bool GenerateChildren(int ply, int depth, ProofNumbers &numbers);
+    ProofNumbers GetNodeNumbers(int ply, int depth) const;
+    std::vector<BoardMove> GetMatingLine(const std::unique_ptr<GameBoard> &gameBoard, int moves);
+    bool IsOnPath(uint64_t key, int ply) const;
+    static bool IsAttackerToMove(int ply) { return ply % 2 == 0; }
+
+    MateSolverOptions options;
+    ProofTable table;
+    std::vector<std::unique_ptr<GameBoard>> boardStack;
+    std::vector<std::vector<ChildNode>> frames;
+    std::vector<uint64_t> pathKeys;
+    uint64_t nodes = 0;
+    uint64_t nodeLimit = 0;
+    bool stopped = false;
+};
+
+
+#endif //CHESSENGINE_MATESOLVER_H
@@ -9,35 +9,64 @@
 #include "GameBoard.h"
 
 
+static constexpr int MAX_BOARD_MOVES = 256;
+
 struct PieceMoveQuery {
     std::array<PieceMove, BOARD_SIZE> moves;
     int moveCount;
 };
 
+struct BoardMove {
+    PiecePosition from;
+    PieceMove move;
+
+    bool operator==(const BoardMove& other) const {
+        return from == other.from && move.position == other.move.position && move.type == other.move.type && move.promotion == other.move.promotion;
+    }
+};
+
+struct BoardMoveQuery {
+    std::array<BoardMove, MAX_BOARD_MOVES> moves;
+    int moveCount;
+};
+
 class MoveSearcher {
 public:
-    static void GetValidMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard);
+    static void GetValidMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard);
+    // Every move of the side to move, promotions expanded. Moves may still leave the own king in check
+    static void GetAllMoves(BoardMoveQuery &moveQuery, const Position &gameBoard);
+    static void GetLegalMoves(BoardMoveQuery &moveQuery, const Position &gameBoard);
+    static bool IsSquareAttacked(PiecePosition piecePosition, PieceColor attackerColor, const Position &gameBoard);
+    static bool IsInCheck(PieceColor kingColor, const Position &gameBoard);
+    // Every square a piece of attackerColor attacks, whether or not it holds a piece
+    static uint64_t GetAttackedSquares(PieceColor attackerColor, const Position &gameBoard);
 
 private:
-    static void GetKingMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece);
-    static void GetQueenMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece);
-    static void GetRookMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece);
+    // Square of the king, -1 when the board has none
+    static int GetKingSquare(PieceColor kingColor, const Position &gameBoard);
+    // Own pieces that are the only blocker between their king and an enemy slider
+    static uint64_t GetPinnedPieces(int kingSquare, PieceColor color, const Position &gameBoard);
 
-    static void GetKnightMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece);
+    static void GetKingMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, const Piece& piece);
+    static void GetQueenMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, const Piece& piece);
+    static void GetRookMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, const Piece& piece);
 
-    static void GetBishopMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece);
+    static void GetKnightMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, const Piece& piece);
 
-    static void GetPawnMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece);
+    static void GetBishopMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, const Piece& piece);
 
-    static void GenerateSlidingMoves(const Piece& piece, PiecePosition piecePosition,PieceMoveQuery &moveQuery,const std::unique_ptr<GameBoard> &gameBoard,const int directions[][2], int directionCount);
+    static void GetPawnMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, const Piece& piece);
 
-    static void AddPawnPushMove(const Piece& piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, int movement, int& idx, int direction, MoveType
+    static void GenerateSlidingMoves(const Piece& piece, PiecePosition piecePosition,PieceMoveQuery &moveQuery,const Position &gameBoard,const int directions[][2], int directionCount);
+
+    static void AddPawnPushMove(const Piece& piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, int movement, int& idx, int direction, MoveType
                                 moveType);
-    static void TryAddEnPassantMove(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, int
+    static void TryAddEnPassantMove(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, int
                                     &idx, int horizontalDirection, int verticalDirection);
 
-    static void TryAddCastle(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, int
-                             &idx, int castleDirection, int castleLength, MoveType moveType);
+    static void TryAddCastle(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, int &idx, MoveType moveType);
+
+    static bool CanCastleThrough(const PieceMove &move, PieceColor color, const Position &gameBoard);
 };
 
 
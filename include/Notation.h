@@ -0,0 +1,30 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_NOTATION_H
+#define CHESSENGINE_NOTATION_H
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "MoveSearcher.h"
+
+class Notation {
+public:
+    static std::string GetSquareName(PiecePosition piecePosition);
+    static std::optional<PiecePosition> ParseSquare(std::string_view squareName);
+    // Long algebraic coordinates as used by UCI, e.g. e2e4 or a7a8q
+    static std::string GetMoveName(const BoardMove &boardMove);
+    // Resolves standard algebraic notation (e.g. Nbd7, exd8=Q+, O-O) against the moves of the side to move
+    static std::optional<BoardMove> ParseSanMove(std::string_view san, const std::unique_ptr<GameBoard> &gameBoard);
+    // Standard algebraic notation for a legal move, with + or # appended
+    static std::string GetSanName(const BoardMove &boardMove, const std::unique_ptr<GameBoard> &gameBoard);
+
+private:
+    static std::optional<PieceType> ParsePieceLetter(char letter);
+    static char GetPieceLetter(PieceType pieceType);
+};
+
+
+#endif //CHESSENGINE_NOTATION_H
@@ -0,0 +1,68 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_PERFT_H
+#define CHESSENGINE_PERFT_H
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "BatchMoveGen.h"
+
+// Leaf parents gathered before one batched count, enough to keep every lane of the widest kernel busy
+static constexpr size_t PERFT_PENDING_POSITIONS = 1024;
+// The tree is split into about this many subtrees per worker, so stealing can even out their sizes
+static constexpr size_t PERFT_TASKS_PER_WORKER = 8;
+
+struct PerftOptions {
+    std::string fen; // the starting position when empty
+    std::string inputPath; // one FEN per line, replaces fen
+    int depth = 5;
+    std::string kernel = "auto";
+    bool verify = false; // recount every batched position with MoveSearcher
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// A subtree counted as one task
+struct PerftSplit {
+    Position position;
+    int depth;
+    std::vector<BoardMove> line;
+};
+
+struct PerftResult {
+    uint64_t nodes = 0;
+    uint64_t countedPositions = 0; // positions whose moves were counted by the kernel instead of played
+    uint64_t mismatches = 0;
+};
+
+// Walks the move tree with MoveSearcher and counts the moves of the last ply in batches. Run splits the tree
+// over the shared thread pool, each subtree gets its own Perft
+class Perft {
+public:
+    explicit Perft(const PerftOptions& options);
+
+    int Run();
+    PerftResult Count(const Position &position, int depth);
+
+private:
+    std::vector<PerftSplit> Split(std::vector<PerftSplit> splits, size_t targetCount) const;
+    void Walk(const Position &position, int depth);
+    void Flush();
+
+    PerftOptions options;
+    MoveGenKernel kernel = MoveGenKernel::Reference;
+    PerftResult result;
+    // From the worker arena, a task's batch buffers are reused by the next task on the same worker
+    std::pmr::vector<Position> pending;
+    std::pmr::vector<uint32_t> counts;
+    // Moves from the root to each pending position, only kept to report mismatches
+    std::vector<BoardMove> line;
+    std::vector<std::string> pendingLines;
+};
+
+
+#endif //CHESSENGINE_PERFT_H
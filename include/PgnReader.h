@@ -0,0 +1,53 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_PGNREADER_H
+#define CHESSENGINE_PGNREADER_H
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MoveSearcher.h"
+
+// Views point into the mapped file and are only valid during the callback
+struct PgnGame {
+    uint64_t offset = 0;
+    std::string_view tagSection;
+    std::string_view result;
+    std::vector<BoardMove> moves;
+    std::string_view errorToken; // first move that could not be resolved, empty if the game replayed cleanly
+
+    std::string_view GetTag(std::string_view name) const;
+    bool LoadStartBoard(const std::unique_ptr<GameBoard> &gameBoard) const;
+};
+
+struct PgnReadStats {
+    uint64_t games = 0;
+    uint64_t moves = 0;
+    uint64_t errors = 0;
+};
+
+// Called from every reader thread at once, the final board is the position after the last replayed move
+using PgnGameCallback = std::function<void(const PgnGame &game, const std::unique_ptr<GameBoard> &finalBoard)>;
+
+class PgnReader {
+public:
+    bool Open(const std::string &path);
+    PgnReadStats Read(int threads, const PgnGameCallback &callback) const;
+
+private:
+    std::vector<std::string_view> SplitChunks(int chunkCount) const;
+    static PgnReadStats ReadChunk(std::string_view chunk, uint64_t chunkOffset, const PgnGameCallback &callback);
+    static size_t ReadTags(std::string_view text, size_t position);
+    static size_t ReadMoveText(std::string_view text, size_t position, PgnGame &game, const std::unique_ptr<GameBoard> &gameBoard);
+
+    MappedFile mappedFile;
+};
+
+
+#endif //CHESSENGINE_PGNREADER_H
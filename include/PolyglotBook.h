@@ -0,0 +1,60 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_POLYGLOTBOOK_H
+#define CHESSENGINE_POLYGLOTBOOK_H
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "MappedFile.h"
+#include "MoveSearcher.h"
+#include "Zobrist.h"
+
+// Polyglot's Random64 table, one hexadecimal key per line in pg_key.c order. Not shipped with the engine, a relative
+// path is looked up from the working directory and then from the executable's directory
+static constexpr const char* POLYGLOT_KEYS_PATH = "../assets/polyglot_random64.txt";
+// Book the GUI engine consults before searching when there is no --book, looked up like the keys
+static constexpr const char* POLYGLOT_BOOK_PATH = "../assets/book.bin";
+static constexpr uint64_t POLYGLOT_START_POSITION_KEY = 0x463B96181691FC9CULL;
+static constexpr int POLYGLOT_ENTRY_SIZE = 16;
+
+enum class BookSelection {
+    BestWeight,
+    WeightedRandom
+};
+
+struct BookMove {
+    BoardMove boardMove;
+    uint16_t weight;
+};
+
+// Probing only reads the shared mapping, so one book can serve every thread
+class PolyglotBook {
+public:
+    // Quiet opens leave the book closed without a word when the book or the key table is missing, for engines
+    // that only prefer book moves and search otherwise
+    bool Open(const std::string &bookPath, const std::string &keysPath = POLYGLOT_KEYS_PATH, bool quiet = false);
+    bool IsOpen() const;
+
+    uint64_t GetKey(const std::unique_ptr<GameBoard> &gameBoard) const;
+    // Fills moves with every playable book move for the position and returns how many were written
+    int GetBookMoves(const std::unique_ptr<GameBoard> &gameBoard, std::span<BookMove> moves) const;
+    // randomValue is only consulted for WeightedRandom, any uniformly distributed 64 bit value works
+    std::optional<BoardMove> Probe(const std::unique_ptr<GameBoard> &gameBoard, BookSelection selection, uint64_t randomValue = 0) const;
+
+private:
+    size_t FindFirstEntry(uint64_t key) const;
+    uint64_t ReadBigEndian(size_t offset, int bytes) const;
+    static std::optional<BoardMove> DecodeMove(uint16_t polyglotMove, const std::unique_ptr<GameBoard> &gameBoard);
+
+    MappedFile mappedFile;
+    ZobristKeys polyglotKeys {};
+    size_t entryCount = 0;
+};
+
+
+#endif //CHESSENGINE_POLYGLOTBOOK_H
@@ -0,0 +1,42 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_POSITIONPUBLISHER_H
+#define CHESSENGINE_POSITIONPUBLISHER_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+#include "GameBoard.h"
+
+struct PositionSnapshot {
+    Position position;
+    uint64_t version; // grows with every publish, so readers can tell a new position without comparing boards
+};
+
+static_assert(std::is_trivially_copyable_v<PositionSnapshot>);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+// One writer publishes positions, any number of threads read them. A seqlock: the snapshot is copied word by
+// word through relaxed atomics between two bumps of a sequence counter, and a reader retries when the counter
+// moved under its copy. Neither side takes a lock or allocates, and the writer never waits for readers
+class PositionPublisher {
+public:
+    explicit PositionPublisher(const Position &position);
+
+    void Publish(const Position &position);
+    // A copy, so the caller keeps a consistent position however often the writer publishes afterwards
+    PositionSnapshot Load() const;
+
+private:
+    static constexpr size_t SNAPSHOT_WORDS = (sizeof(PositionSnapshot) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> sequence = 0; // odd while a publish is writing the words
+    std::array<std::atomic<uint64_t>, SNAPSHOT_WORDS> words {};
+    uint64_t version = 0; // only the writer touches it
+};
+
+
+#endif //CHESSENGINE_POSITIONPUBLISHER_H
@@ -0,0 +1,113 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_SEARCH_H
+#define CHESSENGINE_SEARCH_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+#include "AnalysisCache.h"
+#include "Bitbase.h"
+#include "GameBoard.h"
+#include "MoveSearcher.h"
+#include "TimeManager.h"
+#include "TranspositionTable.h"
+#include "Zobrist.h"
+
+static constexpr int MAX_SEARCH_PLY = 64;
+static constexpr int MATE_SCORE = 32000;
+static constexpr int INFINITE_SCORE = 32001;
+// Bitbase wins score below every mate so a real mate is still preferred
+static constexpr int KNOWN_WIN_SCORE = 20000;
+
+struct SearchResult;
+
+struct SearchLimits {
+    int depth = MAX_SEARCH_PLY;
+    uint64_t nodes = 0; // 0 means unlimited
+    int64_t moveTimeMs = 0; // 0 means unlimited
+    SearchClock clock; // when running, the time manager picks the time to spend within moveTimeMs
+    int multiPv = 1; // root moves to give full lines for, each one searched with the better ones excluded
+    const std::atomic<bool>* stopSignal = nullptr; // lets another thread end the search, polled with the clock
+    // Root window, a score outside it is only a bound. Cluster nodes search subtrees with the window of their parent
+    int alpha = -INFINITE_SCORE;
+    int beta = INFINITE_SCORE;
+    // Called on the searching thread after every finished line, so it has to be quick
+    std::function<void(const SearchResult&)> onProgress;
+};
+
+struct PvLine {
+    int score = 0;
+    std::vector<BoardMove> moves;
+};
+
+struct SearchResult {
+    std::optional<BoardMove> bestMove;
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+    std::vector<PvLine> lines; // best first, multiPv of them unless there are fewer legal moves
+
+    bool IsMateScore() const {
+        return score >= MATE_SCORE - MAX_SEARCH_PLY || score <= -MATE_SCORE + MAX_SEARCH_PLY;
+    }
+};
+
+// Owns all per-search state so one instance can be reused position after position
+class Searcher {
+public:
+    Searcher();
+
+    SearchResult Search(const std::unique_ptr<GameBoard> &gameBoard, const SearchLimits &searchLimits);
+    void SetBitbases(const Bitbases* bitbases);
+    // Deep results are read from and, when writable, written to the cache; it may be shared between searchers
+    void SetAnalysisCache(AnalysisCache* analysisCache);
+    // Deep entries are published to it and entries from other searchers merged from it while searching
+    void SetSharedEntries(SharedEntries* sharedEntries);
+    // The table persists between searches, callers that need repeatable results clear it
+    void SetHashSize(size_t megabytes);
+    void ClearHash();
+    size_t GetHashSizeMb() const;
+
+private:
+    int Negamax(int ply, int depth, int alpha, int beta);
+    int Quiescence(int ply, int alpha, int beta);
+    bool ShouldStop();
+    int64_t GetElapsedMs() const;
+    std::optional<int> ProbeBitbases(int ply) const;
+    bool IsRootMoveExcluded(const BoardMove &boardMove, const std::unique_ptr<GameBoard> &nextBoard) const;
+    std::vector<BoardMove> GetPrincipalVariation(const BoardMove &rootMove);
+    void OrderMoves(BoardMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, const std::optional<BoardMove> &firstMove) const;
+
+    TranspositionTable transpositionTable;
+    const ZobristKeys& zobristKeys;
+    std::vector<std::unique_ptr<GameBoard>> boardStack;
+    std::pmr::vector<BoardMoveQuery> moveStack; // from the worker arena when built on a pool worker
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point startTime;
+    TimeManager timeManager;
+    int64_t timeLimitMs = 0; // the tighter of moveTimeMs and the hard limit, 0 means unlimited
+    uint64_t nodes = 0;
+    bool stopped = false;
+    std::optional<BoardMove> rootBestMove;
+    std::optional<BoardMove> previousBestMove;
+    // Multi-PV lines found so far this iteration, searched past at the root
+    std::vector<BoardMove> excludedRootMoves;
+    const Bitbases* bitbases = nullptr;
+    AnalysisCache* analysisCache = nullptr;
+    SharedEntries* sharedEntries = nullptr;
+    std::chrono::steady_clock::time_point lastCacheFlush;
+    // Inside a known endgame the probes cannot tell moves apart, so the root keeps only result-preserving moves
+    std::optional<BitbaseResult> rootBitbaseResult;
+};
+
+
+#endif //CHESSENGINE_SEARCH_H
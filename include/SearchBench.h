@@ -0,0 +1,58 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_SEARCHBENCH_H
+#define CHESSENGINE_SEARCHBENCH_H
+#include <cstdint>
+#include <string>
+
+#include "GameBoard.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+
+static constexpr int SEARCH_BENCH_DEPTH = 4;
+
+struct SearchBenchOptions {
+    int depth = SEARCH_BENCH_DEPTH;
+    size_t hashMb = TT_DEFAULT_SIZE_MB;
+    std::string jsonPath; // empty writes no record
+    bool scaling = false;
+    // The scaling run doubles the worker count up to threadPool.threads, pinned as the shared pool would be
+    ThreadPoolOptions threadPool;
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+struct SearchBenchResult {
+    uint64_t nodes = 0;
+    int64_t timeMs = 0;
+    uint64_t nodesPerSecond = 0;
+};
+
+// Searches a fixed position list to a fixed depth on one thread. The node total is the signature:
+// it changes exactly when search behaviour changes, whatever the machine. With --scaling it instead times
+// the same searches, and a perft split into nested task groups, on thread pools of growing size
+class SearchBench {
+public:
+    explicit SearchBench(SearchBenchOptions options);
+
+    // Returns the process exit code
+    int Run();
+
+private:
+    int RunScaling();
+    SearchBenchResult RunScalingSearches(ThreadPool &threadPool);
+    SearchBenchResult RunScalingPerft(ThreadPool &threadPool);
+    bool WriteJson(const SearchBenchResult &result) const;
+
+    static uint64_t CountPerft(ThreadPool &threadPool, const Position &position, int depth);
+
+    static std::string GetCompiler();
+    static std::string GetCpuModel();
+
+    SearchBenchOptions options;
+};
+
+
+#endif //CHESSENGINE_SEARCHBENCH_H
@@ -0,0 +1,135 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_STATS_H
+#define CHESSENGINE_STATS_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+#include "GameBoard.h"
+
+// Hot path instrumentation. Only builds with CHESSENGINE_STATS defined record anything,
+// everywhere else the macros expand to nothing and the engine carries no cost at all
+
+enum class StatCounter : uint8_t {
+    // Moves generated per piece type, in PieceType order
+    KingMoves,
+    QueenMoves,
+    RookMoves,
+    KnightMoves,
+    BishopMoves,
+    PawnMoves,
+    ExecuteMoves,
+    BitBoardRecomputes,
+    Nodes,
+    QuiescenceNodes,
+    BetaCutoffs,
+    TTProbes,
+    TTHits,
+    Count
+};
+
+enum class StatTimer : uint8_t {
+    Search,
+    MoveGeneration,
+    Evaluation,
+    Count
+};
+
+static constexpr int STAT_COUNTER_COUNT = static_cast<int>(StatCounter::Count);
+static constexpr int STAT_TIMER_COUNT = static_cast<int>(StatTimer::Count);
+static constexpr size_t STATS_CACHE_LINE = 64;
+
+// One block per thread, only its owner writes it so no two threads share a cache line
+struct alignas(STATS_CACHE_LINE) ThreadStats {
+    std::array<std::atomic<uint64_t>, STAT_COUNTER_COUNT> counters {};
+    std::array<std::atomic<uint64_t>, STAT_TIMER_COUNT> timerTicks {};
+    std::array<std::atomic<uint64_t>, STAT_TIMER_COUNT> timerCalls {};
+};
+
+struct StatsSnapshot {
+    std::array<uint64_t, STAT_COUNTER_COUNT> counters {};
+    std::array<uint64_t, STAT_TIMER_COUNT> timerTicks {};
+    std::array<uint64_t, STAT_TIMER_COUNT> timerCalls {};
+    double seconds = 0; // since the process started
+    double ticksPerSecond = 1;
+};
+
+class Stats {
+public:
+    static constexpr bool IsEnabled() {
+#ifdef CHESSENGINE_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static void Add(StatCounter counter, uint64_t amount);
+    static void AddTime(StatTimer timer, uint64_t ticks);
+    // Sums the blocks of every thread that ever recorded, including finished ones
+    static StatsSnapshot Snapshot();
+    static void WriteJson(std::ostream &output, const StatsSnapshot &snapshot);
+
+    static StatCounter GetMoveCounter(PieceType pieceType);
+    static const char* GetCounterName(StatCounter counter);
+    static const char* GetTimerName(StatTimer timer);
+    // Time stamp counter where the CPU has one, nanoseconds otherwise
+    static uint64_t ReadTicks();
+    // Measured against the steady clock since the process started
+    static double GetTicksPerSecond();
+
+private:
+    static ThreadStats& GetThreadStats();
+    static ThreadStats* RegisterThread();
+};
+
+class ScopedStatTimer {
+public:
+    explicit ScopedStatTimer(StatTimer timer) : timer(timer), startTicks(Stats::ReadTicks()) {}
+    ~ScopedStatTimer() { Stats::AddTime(timer, Stats::ReadTicks() - startTicks); }
+    ScopedStatTimer(const ScopedStatTimer&) = delete;
+    ScopedStatTimer& operator=(const ScopedStatTimer&) = delete;
+
+private:
+    StatTimer timer;
+    uint64_t startTicks;
+};
+
+#ifdef CHESSENGINE_STATS
+#define STATS_CONCAT_INNER(a, b) a##b
+#define STATS_CONCAT(a, b) STATS_CONCAT_INNER(a, b)
+#define STATS_ADD(counter, amount) Stats::Add(counter, amount)
+#define STATS_TIMER(timer) ScopedStatTimer STATS_CONCAT(statTimer, __LINE__)(timer)
+
+inline ThreadStats& Stats::GetThreadStats() {
+    thread_local ThreadStats* threadStats = RegisterThread();
+    return *threadStats;
+}
+
+inline void Stats::Add(StatCounter counter, uint64_t amount) {
+    // Plain load and store, only this thread writes the value and readers tolerate a stale count
+    std::atomic<uint64_t>& value = GetThreadStats().counters[static_cast<int>(counter)];
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline void Stats::AddTime(StatTimer timer, uint64_t ticks) {
+    ThreadStats& threadStats = GetThreadStats();
+    std::atomic<uint64_t>& timerTicks = threadStats.timerTicks[static_cast<int>(timer)];
+    std::atomic<uint64_t>& timerCalls = threadStats.timerCalls[static_cast<int>(timer)];
+    timerTicks.store(timerTicks.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+    timerCalls.store(timerCalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+#else
+#define STATS_ADD(counter, amount) ((void)0)
+#define STATS_TIMER(timer) ((void)0)
+
+inline void Stats::Add(StatCounter, uint64_t) {}
+inline void Stats::AddTime(StatTimer, uint64_t) {}
+#endif
+
+
+#endif //CHESSENGINE_STATS_H
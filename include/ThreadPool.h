@@ -0,0 +1,181 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_THREADPOOL_H
+#define CHESSENGINE_THREADPOOL_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Slots in a new worker deque, it doubles whenever the owner pushes past it
+static constexpr int64_t THREAD_DEQUE_INITIAL_CAPACITY = 256;
+// Arena blocks up to this size are pooled and reused, a Perft batch or a searcher's move stack fits
+static constexpr size_t THREAD_ARENA_LARGEST_BLOCK = 4 << 20;
+
+enum class ThreadPinning : uint8_t {
+    None,
+    Cpu, // one worker per allowed CPU, wrapping around when there are more workers than CPUs
+    Node // workers spread over the NUMA nodes, free to move between the CPUs of their node
+};
+
+struct ThreadPoolOptions {
+    int threads = 0; // 0 uses every hardware thread
+    ThreadPinning pinning = ThreadPinning::None;
+
+    // Engine wide, so --threads sizes the shared pool whatever the command
+    bool ParseArgs(int argc, char** argv);
+};
+
+class TaskGroup;
+
+struct ThreadTask {
+    std::function<void()> function;
+    TaskGroup* group;
+};
+
+// Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models"). The owning worker
+// pushes and pops at the bottom without locking, thieves take from the top with one compare and swap
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(int64_t capacity = THREAD_DEQUE_INITIAL_CAPACITY);
+
+    // Owner only
+    void Push(ThreadTask* task);
+    ThreadTask* Pop();
+    // Any thread, nullptr when empty or when another thief won the race
+    ThreadTask* Steal();
+
+private:
+    struct Ring {
+        explicit Ring(int64_t capacity);
+
+        ThreadTask* Get(int64_t index) const {
+            return slots[index & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+        void Put(int64_t index, ThreadTask* task) {
+            slots[index & (capacity - 1)].store(task, std::memory_order_relaxed);
+        }
+
+        int64_t capacity;
+        std::unique_ptr<std::atomic<ThreadTask*>[]> slots;
+    };
+
+    Ring* Grow(Ring* ring, int64_t top, int64_t bottom);
+
+    alignas(64) std::atomic<int64_t> top = 0;
+    alignas(64) std::atomic<int64_t> bottom = 0;
+    std::atomic<Ring*> ring;
+    // A thief may still read from a ring that was grown out of, so old rings live as long as the deque
+    std::vector<std::unique_ptr<Ring>> rings;
+};
+
+struct ThreadPoolStats {
+    uint64_t executed = 0;
+    uint64_t stolen = 0;
+};
+
+// Engine wide scheduler: one deque per worker, idle workers steal from their own NUMA node first. Tasks are
+// submitted through a TaskGroup, threads outside the pool go through a shared injection queue
+class ThreadPool {
+public:
+    explicit ThreadPool(ThreadPoolOptions options = {});
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int GetWorkerCount() const;
+    int GetNodeCount() const;
+    ThreadPoolStats GetStats() const;
+
+    // Takes effect when the shared pool is first used, later calls are ignored
+    static void Configure(const ThreadPoolOptions &options);
+    static ThreadPool& GetShared();
+    // Index of the calling worker in its pool, -1 on any other thread
+    static int GetWorkerIndex();
+    // The calling worker's arena, allocated and first touched on its node. Other threads get the default resource
+    static std::pmr::memory_resource* GetMemoryResource();
+
+private:
+    friend class TaskGroup;
+
+    struct Worker {
+        WorkStealingDeque deque;
+        std::thread thread;
+        std::unique_ptr<std::pmr::synchronized_pool_resource> arena;
+        std::vector<int> cpus; // empty leaves the worker unpinned
+        int node = 0;
+        uint64_t randomState = 0;
+        std::atomic<uint64_t> executed = 0;
+        std::atomic<uint64_t> stolen = 0;
+    };
+
+    void Submit(ThreadTask* task);
+    // Runs one queued task on the calling worker, false when there was nothing to run
+    bool RunPendingTask();
+    ThreadTask* FindTask(Worker &worker);
+    ThreadTask* StealTask(Worker &worker, bool sameNode);
+    void Execute(Worker &worker, ThreadTask* task);
+    void RunWorker(int index);
+    void AssignCpus();
+
+    ThreadPoolOptions options;
+    std::vector<std::unique_ptr<Worker>> workers;
+    int nodeCount = 1;
+    std::mutex injectionMutex;
+    std::deque<ThreadTask*> injectedTasks;
+    std::atomic<bool> hasInjectedTasks = false;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<uint64_t> wakeEpoch = 0; // written under sleepMutex
+    std::atomic<int> sleepingWorkers = 0;
+    bool stopping = false; // guarded by sleepMutex
+    size_t startedWorkers = 0; // guarded by sleepMutex
+    std::condition_variable started;
+};
+
+// Tasks that finish together. Cancelling only stops tasks that have not started, running ones poll
+// IsCancelled or hand GetCancelSignal to a search as its stop signal
+class TaskGroup {
+public:
+    TaskGroup();
+    explicit TaskGroup(ThreadPool &threadPool);
+    // Waits, a group never outlives its tasks
+    ~TaskGroup();
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Callable from any thread, including from inside a task of this group
+    void Run(std::function<void()> function);
+    // Calls body(start, end) over [0, count) in pieces of at most grain. Ranges are halved as they are run,
+    // so only a few tasks exist at a time and a thief always takes the largest piece left
+    void RunRange(uint64_t count, uint64_t grain, std::function<void(uint64_t, uint64_t)> body);
+    // Pool workers keep running tasks while they wait, other threads block
+    void Wait();
+    void Cancel();
+    bool IsCancelled() const;
+    const std::atomic<bool>* GetCancelSignal() const;
+    ThreadPool& GetThreadPool() const;
+
+private:
+    friend class ThreadPool;
+    void SplitRange(uint64_t start, uint64_t end, uint64_t grain, const std::shared_ptr<std::function<void(uint64_t, uint64_t)>> &body);
+    void Finish();
+
+    ThreadPool& threadPool;
+    std::atomic<bool> cancelled = false;
+    std::atomic<uint64_t> pendingTasks = 0;
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done = true; // guarded by mutex, set by the task that brings pendingTasks to 0
+};
+
+
+#endif //CHESSENGINE_THREADPOOL_H
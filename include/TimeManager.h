@@ -0,0 +1,63 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_TIMEMANAGER_H
+#define CHESSENGINE_TIMEMANAGER_H
+#include <cstdint>
+#include <string>
+
+static constexpr int64_t TIME_DEFAULT_MOVE_OVERHEAD_MS = 30;
+// Sudden death plays as if this many moves were left
+static constexpr int TIME_DEFAULT_MOVES_TO_GO = 30;
+
+// Clock of the side to move, as a tournament or the GUI reports it
+struct SearchClock {
+    int64_t remainingMs = 0; // 0 when no clock is running
+    int64_t incrementMs = 0;
+    int movesToGo = 0; // moves until the next time control, 0 for sudden death
+    int64_t moveOverheadMs = TIME_DEFAULT_MOVE_OVERHEAD_MS; // lag between deciding and the clock stopping
+
+    bool IsEnabled() const { return remainingMs > 0; }
+};
+
+struct TimeControl {
+    int movesPerPeriod = 0; // 0 for sudden death, otherwise base is added again every this many moves
+    int64_t baseMs = 10000;
+    int64_t incrementMs = 100;
+    int64_t moveOverheadMs = TIME_DEFAULT_MOVE_OVERHEAD_MS;
+
+    // Seconds as [moves/]base+increment, e.g. 10+0.1 or 40/60+0.5, or 0 to play on engine limits alone
+    bool Parse(const std::string &text);
+    bool IsEnabled() const;
+    std::string ToString() const;
+    // The clock a side sees before its next move, having made movesMade moves
+    SearchClock GetClock(int64_t remainingMs, int movesMade) const;
+    // Charges a finished move to the clock, returns false when the flag fell
+    bool OnMoveMade(int64_t &remainingMs, int64_t elapsedMs, int movesMade) const;
+};
+
+// Splits the clock into a soft limit, checked between iterations and scaled by how settled the search is,
+// and a hard limit the search never runs past
+class TimeManager {
+public:
+    void Start(const SearchClock &clock);
+    // Feeds the result of each finished iteration, returns false when the next one should not start
+    bool OnIteration(int64_t elapsedMs, bool bestMoveChanged, int score);
+
+    int64_t GetSoftLimitMs() const { return softLimitMs; }
+    int64_t GetHardLimitMs() const { return hardLimitMs; }
+    int64_t GetScaledSoftLimitMs() const;
+
+private:
+    int64_t softLimitMs = 0;
+    int64_t hardLimitMs = 0;
+    double bestMoveChanges = 0; // decays each iteration so old changes count less
+    int stableIterations = 0;
+    int previousScore = 0;
+    double scoreDropFactor = 1;
+    int iterations = 0;
+};
+
+
+#endif //CHESSENGINE_TIMEMANAGER_H
@@ -0,0 +1,132 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_TRACER_H
+#define CHESSENGINE_TRACER_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "Stats.h"
+
+// Timeline tracing in the Chrome trace_event format. Builds without CHESSENGINE_TRACE compile every
+// TRACE_SCOPE away, builds with it record only between Tracer::Start and Tracer::Stop
+
+enum class TraceEvent : uint8_t {
+    Iteration,
+    RootMove,
+    MoveGeneration,
+    PieceMoves,
+    ExecuteMove,
+    Evaluation,
+    Count
+};
+
+static constexpr int TRACE_EVENT_COUNT = static_cast<int>(TraceEvent::Count);
+static constexpr size_t TRACE_BUFFER_RECORDS = 1 << 18; // per thread, the oldest records are overwritten
+static constexpr uint32_t TRACE_DEFAULT_SAMPLE_INTERVAL = 64;
+
+// One complete event, written once when its scope closes
+struct TraceRecord {
+    uint64_t startTicks;
+    uint64_t endTicks;
+    int32_t value;
+    TraceEvent event;
+};
+
+// Single producer ring, only the owning thread writes records and bumps head
+struct alignas(STATS_CACHE_LINE) TraceBuffer {
+    std::array<TraceRecord, TRACE_BUFFER_RECORDS> records;
+    std::atomic<uint64_t> head = 0;
+    std::array<uint32_t, TRACE_EVENT_COUNT> sampleCounters {};
+    int threadIndex = 0;
+};
+
+class Tracer {
+public:
+    static constexpr bool IsCompiled() {
+#ifdef CHESSENGINE_TRACE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Events that fire millions of times a second are kept once every sampleInterval occurrences
+    static void Start(uint32_t sampleInterval = TRACE_DEFAULT_SAMPLE_INTERVAL);
+    static void Stop();
+    static bool IsActive() { return active.load(std::memory_order_relaxed); }
+    // Call once the traced threads are idle, a record being written while it is read may come out torn
+    static bool WriteJson(const std::string &path);
+
+    static bool ShouldSample(TraceEvent event);
+    static void Record(TraceEvent event, int32_t value, uint64_t startTicks, uint64_t endTicks);
+    static const char* GetEventName(TraceEvent event);
+
+private:
+    static TraceBuffer& GetTraceBuffer();
+    static TraceBuffer* RegisterThread();
+
+    // Constant initialised so the hot path skips the thread_local guard
+    static inline thread_local TraceBuffer* threadBuffer = nullptr;
+    static inline std::atomic<bool> active = false;
+    static inline std::atomic<uint32_t> sampleInterval = TRACE_DEFAULT_SAMPLE_INTERVAL;
+};
+
+class ScopedTrace {
+public:
+    ScopedTrace(TraceEvent event, int32_t value, bool enabled = true) : event(event), value(value) {
+        recording = enabled && Tracer::IsActive() && Tracer::ShouldSample(event);
+        if (recording) startTicks = Stats::ReadTicks();
+    }
+    ~ScopedTrace() {
+        if (recording) Tracer::Record(event, value, startTicks, Stats::ReadTicks());
+    }
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+private:
+    TraceEvent event;
+    int32_t value;
+    bool recording;
+    uint64_t startTicks = 0;
+};
+
+#ifdef CHESSENGINE_TRACE
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(event, value) ScopedTrace TRACE_CONCAT(traceScope, __LINE__)(event, static_cast<int32_t>(value))
+#define TRACE_SCOPE_IF(condition, event, value) ScopedTrace TRACE_CONCAT(traceScope, __LINE__)(event, static_cast<int32_t>(value), condition)
+
+inline TraceBuffer& Tracer::GetTraceBuffer() {
+    if (threadBuffer == nullptr) [[unlikely]] threadBuffer = RegisterThread();
+    return *threadBuffer;
+}
+
+inline bool Tracer::ShouldSample(TraceEvent event) {
+    // Iterations and root moves are rare enough to keep every one
+    if (event == TraceEvent::Iteration || event == TraceEvent::RootMove) return true;
+    uint32_t& sampleCounter = GetTraceBuffer().sampleCounters[static_cast<int>(event)];
+    if (++sampleCounter < sampleInterval.load(std::memory_order_relaxed)) return false;
+    sampleCounter = 0;
+    return true;
+}
+
+inline void Tracer::Record(TraceEvent event, int32_t value, uint64_t startTicks, uint64_t endTicks) {
+    TraceBuffer& traceBuffer = GetTraceBuffer();
+    uint64_t head = traceBuffer.head.load(std::memory_order_relaxed);
+    traceBuffer.records[head % TRACE_BUFFER_RECORDS] = TraceRecord{startTicks, endTicks, value, event};
+    traceBuffer.head.store(head + 1, std::memory_order_release);
+}
+#else
+#define TRACE_SCOPE(event, value) ((void)0)
+#define TRACE_SCOPE_IF(condition, event, value) ((void)0)
+
+inline bool Tracer::ShouldSample(TraceEvent) { return false; }
+inline void Tracer::Record(TraceEvent, int32_t, uint64_t, uint64_t) {}
+#endif
+
+
+#endif //CHESSENGINE_TRACER_H
@@ -0,0 +1,94 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_TRAININGDATA_H
+#define CHESSENGINE_TRAININGDATA_H
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameTracker.h"
+#include "MappedFile.h"
+
+static constexpr const char* TRAINING_DATA_EXTENSION = ".pos";
+// Positions a worker collects before handing them to the writer thread (2 MB)
+static constexpr size_t TRAINING_BUFFER_POSITIONS = 1 << 16;
+
+// Fixed 32 byte little endian record without a file header, so files can be split or joined at any record boundary
+struct PackedPosition {
+    uint64_t occupancy; // bit row*8+col, the same layout as ColorBitBoards
+    uint8_t pieces[16]; // 4 bit piece code per occupied square in bit order, low nibble first
+    int16_t score; // search score from white's point of view
+    uint8_t result; // 0 black wins, 1 draw, 2 white wins
+    uint8_t flags; // bit 0 black to move, bits 1-4 CastleRight
+    uint8_t enPassantFile; // 0 for none, otherwise file + 1
+    uint8_t halfmoveClock;
+    uint16_t ply;
+};
+static_assert(sizeof(PackedPosition) == 32);
+
+class TrainingData {
+public:
+    static PackedPosition Pack(const GameBoard &gameBoard, int score, GameResult result, int ply);
+    // Returns false if the record does not hold a valid position
+    static bool Unpack(const PackedPosition &packedPosition, GameBoard &gameBoard);
+    static GameResult GetResult(const PackedPosition &packedPosition);
+    static void SetResult(PackedPosition &packedPosition, GameResult result);
+    static std::string GetShardPath(const std::string &prefix, int shard);
+    // Two passes: records are scattered to random shards, then every shard is shuffled in memory
+    static bool Shuffle(const std::vector<std::string> &inputPaths, const std::string &outputPrefix, int shardCount, uint64_t seed);
+};
+
+// Workers hand over whole buffers, all file I/O happens on one background thread
+class TrainingDataWriter {
+public:
+    ~TrainingDataWriter();
+
+    // Starts a new shard every shardPositions records
+    bool Open(const std::string &prefix, uint64_t shardPositions);
+    // Takes the contents of buffer and leaves it empty with its capacity reserved
+    void Submit(std::vector<PackedPosition> &buffer);
+    // Returns false if any write failed
+    bool Close();
+    uint64_t GetWritten() const;
+
+private:
+    void WriteLoop();
+    bool OpenShard();
+
+    std::string prefix;
+    uint64_t shardPositions = 0;
+    int shardIndex = 0;
+    uint64_t shardWritten = 0;
+    uint64_t written = 0;
+    bool failed = false;
+    std::ofstream output;
+
+    std::deque<std::vector<PackedPosition>> pending;
+    std::vector<std::vector<PackedPosition>> spareBuffers;
+    bool closing = false;
+    mutable std::mutex mutex;
+    std::condition_variable pendingReady;
+    std::thread writerThread;
+};
+
+// Records are read in place from the mapping
+class TrainingDataReader {
+public:
+    bool Open(const std::string &path, MappedFileAccess access = MappedFileAccess::Sequential);
+    std::span<const PackedPosition> GetPositions() const;
+    uint64_t GetCount() const;
+
+private:
+    MappedFile mappedFile;
+};
+
+
+#endif //CHESSENGINE_TRAININGDATA_H
@@ -0,0 +1,56 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_TRAININGDATAGENERATOR_H
+#define CHESSENGINE_TRAININGDATAGENERATOR_H
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Search.h"
+#include "TrainingData.h"
+
+// Games that reach this length are scored as draws
+static constexpr int TRAINING_MAX_PLIES = 400;
+
+struct TrainingDataOptions {
+    std::string outputPrefix = "training";
+    uint64_t games = 1000;
+    SearchLimits limits {MAX_SEARCH_PLY, 5000};
+    int randomPlies = 8; // random opening moves so games do not repeat
+    uint64_t shardPositions = 1 << 24; // 512 MB per file
+    uint64_t seed = 1;
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// Built on the pool worker that first plays a game, positions are buffered until a full batch is submitted
+struct TrainingWorker {
+    Searcher searcher;
+    std::vector<PackedPosition> buffer;
+    std::vector<PackedPosition> gamePositions;
+};
+
+// Self-play games labelled with the search score and the final result, only quiet positions are kept
+// Every game is one task on the shared thread pool
+class TrainingDataGenerator {
+public:
+    explicit TrainingDataGenerator(TrainingDataOptions options);
+
+    // Returns the process exit code
+    int Run();
+
+private:
+    void RunGame(TrainingWorker &worker, uint64_t gameIndex);
+    void PlayGame(Searcher &searcher, uint64_t gameIndex, std::vector<PackedPosition> &gamePositions) const;
+
+    TrainingDataOptions options;
+    TrainingDataWriter writer;
+    std::atomic<uint64_t> finishedGames = 0;
+};
+
+
+#endif //CHESSENGINE_TRAININGDATAGENERATOR_H
@@ -0,0 +1,77 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_TRANSPOSITIONTABLE_H
+#define CHESSENGINE_TRANSPOSITIONTABLE_H
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "MoveSearcher.h"
+
+static constexpr size_t TT_DEFAULT_SIZE_MB = 16;
+// Shallower entries are cheaper to search again than to send to another process
+static constexpr int SHARED_ENTRY_MIN_DEPTH = 4;
+// Entries waiting in either direction, the oldest are dropped when the other side falls behind
+static constexpr size_t SHARED_ENTRY_CAPACITY = 1 << 16;
+
+enum class TTBound : uint8_t {
+    None = 0,
+    Upper = 1, // score is at most the stored value
+    Lower = 2, // score is at least the stored value
+    Exact = 3
+};
+
+struct TTEntry {
+    uint64_t key;
+    uint16_t move; // from, to and promotion, 0 when there is none
+    int16_t score; // mate and known win scores relative to this node, not the root
+    int8_t depth;
+    TTBound bound;
+};
+static_assert(sizeof(TTEntry) == 16);
+
+// Always-replace buckets of one entry, except that a shallower result never evicts a deeper one for the same position
+class TranspositionTable {
+public:
+    void Resize(size_t megabytes);
+    void Clear();
+    size_t GetSizeMb() const;
+    bool IsEmpty() const { return entries.empty(); }
+
+    const TTEntry* Probe(uint64_t key) const;
+    void Store(uint64_t key, int depth, int score, TTBound bound, const std::optional<BoardMove> &move, int ply);
+    // An entry from another table, the score is already relative to its node
+    void Store(const TTEntry &entry);
+
+    // The stored move only keeps squares, the generated list supplies the move type
+    static uint16_t PackMove(const BoardMove &boardMove);
+    static std::optional<BoardMove> FindMove(uint16_t packedMove, const BoardMoveQuery &moveQuery);
+    static int ToStoredScore(int score, int ply);
+    static int FromStoredScore(int score, int ply);
+
+private:
+    std::vector<TTEntry> entries;
+    uint64_t mask = 0;
+};
+
+// Deep entries passed between searchers that each own a table, such as cluster nodes. The searcher publishes what
+// it stores and merges what arrived whenever it checks the clock, the network side can run on any thread
+class SharedEntries {
+public:
+    void Publish(const TTEntry &entry);
+    std::vector<TTEntry> TakePublished();
+    void Receive(const std::vector<TTEntry> &entries);
+    void MergeInto(TranspositionTable &table);
+
+private:
+    std::mutex mutex;
+    std::vector<TTEntry> published;
+    std::vector<TTEntry> received;
+    std::atomic<bool> hasReceived = false;
+};
+
+#endif //CHESSENGINE_TRANSPOSITIONTABLE_H
@@ -0,0 +1,68 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_TUNER_H
+#define CHESSENGINE_TUNER_H
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Evaluator.h"
+
+// A term packs the parameter index into the high bits and a signed coefficient into the low bits
+static constexpr int TUNER_COEFFICIENT_BITS = 6;
+static_assert(EVAL_PARAMETER_COUNT < (1 << (16 - TUNER_COEFFICIENT_BITS)));
+
+struct TunerOptions {
+    std::vector<std::string> inputPaths;
+    int threads = 0; // slices per pass, each one a task on the shared pool. 0 uses one per pool worker
+    int epochs = 1000;
+    double learningRate = 1.0; // centipawns per Adam step
+    double lambda = 1.0; // weight of the game result against the search score in the target
+    double scalingFactor = 0; // K in 1 / (1 + 10^(-K * eval / 400)), 0 fits it first
+    uint64_t maxPositions = 0; // 0 loads everything
+    std::string outputPath = "tuned_eval.txt";
+
+    bool ParseArgs(int argc, char** argv);
+};
+
+// Structure of arrays so the epoch loops stream through memory
+struct TuningSet {
+    std::vector<uint64_t> termOffsets; // terms of position i are [termOffsets[i], termOffsets[i + 1])
+    std::vector<uint16_t> terms;
+    std::vector<float> results; // 0, 0.5 or 1 from white's side
+    std::vector<float> scores; // search score from white's side
+    std::vector<float> targets;
+
+    size_t GetPositionCount() const { return results.size(); }
+};
+
+// Texel tuning: minimises the squared error between a sigmoid of the linear evaluation and the game results
+class Tuner {
+public:
+    explicit Tuner(TunerOptions options);
+
+    // Returns the process exit code
+    int Run();
+
+private:
+    bool Load();
+    double FitScalingFactor();
+    // Mean squared error, also the gradient with respect to every parameter when gradient is not null
+    double ComputeError(double scalingFactor, std::vector<double>* gradient) const;
+    void ParallelFor(size_t count, const std::function<void(int, size_t, size_t)> &body) const;
+    bool WriteParameters() const;
+
+    static uint16_t PackTerm(int index, int coefficient);
+    static int GetTermIndex(uint16_t term);
+    static int GetTermCoefficient(uint16_t term);
+
+    TunerOptions options;
+    TuningSet tuningSet;
+    std::vector<double> parameters;
+};
+
+
+#endif //CHESSENGINE_TUNER_H
@@ -0,0 +1,47 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#ifndef CHESSENGINE_ZOBRIST_H
+#define CHESSENGINE_ZOBRIST_H
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "GameBoard.h"
+
+// Layout follows Polyglot: 768 piece-square keys, 4 castling keys, 8 en passant file keys, 1 side key
+static constexpr int ZOBRIST_PIECE_KEYS = 768;
+static constexpr int ZOBRIST_CASTLE_OFFSET = 768;
+static constexpr int ZOBRIST_EN_PASSANT_OFFSET = 772;
+static constexpr int ZOBRIST_TURN_OFFSET = 780;
+static constexpr int ZOBRIST_KEY_COUNT = 781;
+
+struct ZobristKeys {
+    std::array<uint64_t, ZOBRIST_KEY_COUNT> keys;
+};
+
+enum CastleRight : uint8_t {
+    CastleNone = 0,
+    WhiteShort = 1 << 0,
+    WhiteLong = 1 << 1,
+    BlackShort = 1 << 2,
+    BlackLong = 1 << 3,
+};
+
+class Zobrist {
+public:
+    static uint64_t ComputeKey(const GameBoard &gameBoard, const ZobristKeys &zobristKeys);
+    // Reads one hexadecimal key per line
+    static bool LoadKeys(const std::string &path, ZobristKeys &zobristKeys);
+    // Fixed seeded keys for hashing inside the engine, where matching Polyglot does not matter
+    static const ZobristKeys& GetEngineKeys();
+
+    static int GetPieceKeyIndex(const Piece &piece, PiecePosition piecePosition);
+    static uint8_t GetCastleRights(const GameBoard &gameBoard);
+    // Only set when a pawn of the side to move stands ready to take, as Polyglot requires
+    static std::optional<int> GetEnPassantFile(const GameBoard &gameBoard);
+};
+
+
+#endif //CHESSENGINE_ZOBRIST_H
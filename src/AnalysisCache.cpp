@@ -0,0 +1,171 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/AnalysisCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char ANALYSIS_CACHE_MAGIC[4] = {'C', 'E', 'A', 'C'};
+
+    // Records are written and read a word at a time, possibly by several threads and processes at once
+    uint64_t LoadWord(uint64_t &word) {
+        return std::atomic_ref(word).load(std::memory_order_relaxed);
+    }
+
+    void StoreWord(uint64_t &word, uint64_t value) {
+        std::atomic_ref(word).store(value, std::memory_order_relaxed);
+    }
+}
+
+AnalysisCache::~AnalysisCache() {
+    Close();
+}
+
+bool AnalysisCache::Open(const std::string &path, size_t megabytes) {
+    Close();
+
+    fileDescriptor = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    writable = fileDescriptor >= 0;
+    if (!writable) fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0) {
+        std::cerr << "Failed to open analysis cache: " << path << '\n';
+        return false;
+    }
+    if (writable && flock(fileDescriptor, LOCK_EX | LOCK_NB) != 0) {
+        std::cerr << "Analysis cache " << path << " has another writer, reading only\n";
+        writable = false;
+    }
+
+    struct stat fileStat {};
+    if (fstat(fileDescriptor, &fileStat) != 0) {
+        Close();
+        return false;
+    }
+    if (fileStat.st_size == 0) {
+        if (!writable) {
+            std::cerr << "Analysis cache " << path << " is empty\n";
+            Close();
+            return false;
+        }
+        // Power of two records so the home slot is a mask
+        uint64_t count = std::max<size_t>(megabytes, 1) * 1024 * 1024 / sizeof(AnalysisCacheRecord);
+        uint64_t entryCount = 1;
+        while (entryCount * 2 <= count) {
+            entryCount *= 2;
+        }
+        AnalysisCacheHeader header {};
+        std::memcpy(header.magic, ANALYSIS_CACHE_MAGIC, sizeof(header.magic));
+        header.version = ANALYSIS_CACHE_VERSION;
+        header.entryCount = entryCount;
+        // The file grows sparse and zeroed, which reads as empty records
+        off_t fileSize = static_cast<off_t>(sizeof(header) + entryCount * sizeof(AnalysisCacheRecord));
+        if (ftruncate(fileDescriptor, fileSize) != 0 || pwrite(fileDescriptor, &header, sizeof(header), 0) != sizeof(header)) {
+            std::cerr << "Failed to create analysis cache: " << path << '\n';
+            Close();
+            return false;
+        }
+        fileStat.st_size = fileSize;
+    }
+
+    AnalysisCacheHeader header {};
+    if (static_cast<size_t>(fileStat.st_size) < sizeof(header) || pread(fileDescriptor, &header, sizeof(header), 0) != sizeof(header)
+        || std::memcmp(header.magic, ANALYSIS_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != ANALYSIS_CACHE_VERSION
+        || header.entryCount == 0 || (header.entryCount & (header.entryCount - 1)) != 0
+        || static_cast<size_t>(fileStat.st_size) != sizeof(header) + header.entryCount * sizeof(AnalysisCacheRecord)) {
+        std::cerr << "Not an analysis cache: " << path << '\n';
+        Close();
+        return false;
+    }
+
+    mappingSize = static_cast<size_t>(fileStat.st_size);
+    int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* mapped = mmap(nullptr, mappingSize, protection, MAP_SHARED, fileDescriptor, 0);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map analysis cache: " << path << '\n';
+        Close();
+        return false;
+    }
+    mapping = mapped;
+    madvise(mapping, mappingSize, MADV_RANDOM);
+    records = reinterpret_cast<AnalysisCacheRecord*>(static_cast<char*>(mapping) + sizeof(AnalysisCacheHeader));
+    mask = header.entryCount - 1;
+    return true;
+}
+
+void AnalysisCache::Close() {
+    if (mapping != nullptr) {
+        if (writable) msync(mapping, mappingSize, MS_SYNC);
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+    }
+    if (fileDescriptor >= 0) {
+        // Closing also drops the writer lock
+        close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+    records = nullptr;
+    mappingSize = 0;
+    mask = 0;
+    writable = false;
+}
+
+std::optional<TTEntry> AnalysisCache::Probe(uint64_t key) const {
+    if (records == nullptr) return std::nullopt;
+    for (uint64_t i = 0; i < ANALYSIS_CACHE_PROBE_LENGTH; i++) {
+        AnalysisCacheRecord& record = records[(key + i) & mask];
+        uint64_t data = LoadWord(record.data);
+        if (data != 0 && (LoadWord(record.checkedKey) ^ data) == key) return UnpackData(key, data);
+    }
+    return std::nullopt;
+}
+
+void AnalysisCache::Store(const TTEntry &entry) {
+    if (!writable) return;
+
+    // Depth preferred: the same position keeps its deeper result, a new one evicts the shallowest in its window
+    AnalysisCacheRecord* target = nullptr;
+    int targetDepth = 0;
+    for (uint64_t i = 0; i < ANALYSIS_CACHE_PROBE_LENGTH; i++) {
+        AnalysisCacheRecord& record = records[(entry.key + i) & mask];
+        uint64_t data = LoadWord(record.data);
+        int depth = data == 0 ? -1 : UnpackData(entry.key, data).depth;
+        if (data != 0 && (LoadWord(record.checkedKey) ^ data) == entry.key) {
+            if (depth > entry.depth && entry.bound != TTBound::Exact) return;
+            target = &record;
+            targetDepth = -1;
+            break;
+        }
+        if (target == nullptr || depth < targetDepth) {
+            target = &record;
+            targetDepth = depth;
+        }
+    }
+    if (targetDepth > entry.depth) return;
+
+    uint64_t data = PackData(entry);
+    StoreWord(target->data, data);
+    StoreWord(target->checkedKey, entry.key ^ data);
+}
+
+void AnalysisCache::Flush() const {
+    if (writable && mapping != nullptr) msync(mapping, mappingSize, MS_ASYNC);
+}
+
+uint64_t AnalysisCache::PackData(const TTEntry &entry) {
+    return static_cast<uint64_t>(entry.move) | static_cast<uint64_t>(static_cast<uint16_t>(entry.score)) << 16
+           | static_cast<uint64_t>(static_cast<uint8_t>(entry.depth)) << 32 | static_cast<uint64_t>(entry.bound) << 40;
+}
+
+TTEntry AnalysisCache::UnpackData(uint64_t key, uint64_t data) {
+    return TTEntry{key, static_cast<uint16_t>(data), static_cast<int16_t>(data >> 16), static_cast<int8_t>(data >> 32), static_cast<TTBound>(data >> 40 & 3)};
+}
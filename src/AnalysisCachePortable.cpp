@@ -0,0 +1,32 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+// AnalysisCache for platforms without mmap and flock: opening fails, so searches simply run without the cache
+
+#include "../include/AnalysisCache.h"
+
+#include <iostream>
+
+AnalysisCache::~AnalysisCache() {
+    Close();
+}
+
+bool AnalysisCache::Open(const std::string &path, size_t) {
+    Close();
+    std::cerr << "The analysis cache needs a shared file mapping, searching without " << path << '\n';
+    return false;
+}
+
+void AnalysisCache::Close() {
+}
+
+std::optional<TTEntry> AnalysisCache::Probe(uint64_t) const {
+    return std::nullopt;
+}
+
+void AnalysisCache::Store(const TTEntry &) {
+}
+
+void AnalysisCache::Flush() const {
+}
@@ -0,0 +1,197 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/BatchAnalyzer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <semaphore>
+#include <sstream>
+#include <thread>
+
+#include "../include/ArgParse.h"
+#include "../include/Notation.h"
+#include "../include/ThreadPool.h"
+
+namespace {
+    std::string EscapeJson(const std::string &text) {
+        std::string escaped;
+        escaped.reserve(text.size());
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+                escaped += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                escaped += ' ';
+            } else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    std::string TrimLine(const std::string &line) {
+        size_t start = line.find_first_not_of(" \t\r\n");
+        if (start == std::string::npos) return "";
+        size_t end = line.find_last_not_of(" \t\r\n");
+        return line.substr(start, end - start + 1);
+    }
+}
+
+bool BatchOptions::ParseArgs(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--input" && hasValue) {
+            inputPath = argv[++i];
+        } else if (arg == "--queue" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], queueCapacity)) return false;
+        } else if (arg == "--depth" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], limits.depth)) return false;
+        } else if (arg == "--nodes" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], limits.nodes)) return false;
+        } else if (arg == "--movetime" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], limits.moveTimeMs)) return false;
+        } else if (arg == "--bitbases" && hasValue) {
+            bitbaseDirectory = argv[++i];
+        } else if (arg == "--cache" && hasValue) {
+            cachePath = argv[++i];
+        } else if (arg == "--cache-size" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], cacheSizeMb)) return false;
+        }
+    }
+    return true;
+}
+
+BatchReorderBuffer::BatchReorderBuffer(size_t capacity) : slots(capacity) {
+}
+
+void BatchReorderBuffer::Put(uint64_t index, std::string line) {
+    std::unique_lock lock(mutex);
+    // Run never has more lines outstanding than there are slots, so this only waits if a caller does
+    slotFree.wait(lock, [this, index] { return index < nextIndex + slots.size(); });
+    slots[index % slots.size()] = std::move(line);
+    if (index == nextIndex) slotReady.notify_one();
+}
+
+bool BatchReorderBuffer::TakeNext(std::string &line) {
+    std::unique_lock lock(mutex);
+    slotReady.wait(lock, [this] {
+        return slots[nextIndex % slots.size()].has_value() || (totalCount.has_value() && nextIndex >= totalCount.value());
+    });
+    std::optional<std::string>& slot = slots[nextIndex % slots.size()];
+    if (!slot.has_value()) return false;
+
+    line = std::move(slot.value());
+    slot.reset();
+    nextIndex++;
+    slotFree.notify_all();
+    return true;
+}
+
+void BatchReorderBuffer::SetTotal(uint64_t total) {
+    std::lock_guard lock(mutex);
+    totalCount = total;
+    slotReady.notify_one();
+}
+
+BatchAnalyzer::BatchAnalyzer(BatchOptions options) : options(std::move(options)) {
+    if (this->options.queueCapacity <= 0) {
+        this->options.queueCapacity = ThreadPool::GetShared().GetWorkerCount() * 4;
+    }
+    if (!this->options.bitbaseDirectory.empty() && bitbases.LoadDirectory(this->options.bitbaseDirectory) == 0) {
+        std::cerr << "No bitbases found in " << this->options.bitbaseDirectory << '\n';
+    }
+    if (!this->options.cachePath.empty()) analysisCache.Open(this->options.cachePath, this->options.cacheSizeMb);
+}
+
+int BatchAnalyzer::Run() {
+    if (options.inputPath == "-") {
+        return Run(std::cin, std::cout);
+    }
+
+    std::ifstream input(options.inputPath);
+    if (!input) {
+        std::cerr << "Failed to open batch input: " << options.inputPath << '\n';
+        return 1;
+    }
+    return Run(input, std::cout);
+}
+
+int BatchAnalyzer::Run(std::istream &input, std::ostream &output) {
+    ThreadPool& threadPool = ThreadPool::GetShared();
+    BatchReorderBuffer reorderBuffer(options.queueCapacity);
+    // A line holds its permit until it is written, so a huge input never sits in memory
+    std::counting_semaphore<> freeSlots(options.queueCapacity);
+
+    std::thread writer([&reorderBuffer, &output, &freeSlots] {
+        std::string line;
+        while (reorderBuffer.TakeNext(line)) {
+            output << line << '\n';
+            freeSlots.release();
+        }
+        output.flush();
+    });
+
+    std::vector<std::unique_ptr<BatchWorker>> workers(threadPool.GetWorkerCount());
+    TaskGroup taskGroup(threadPool);
+    uint64_t index = 0;
+    std::string line;
+    while (std::getline(input, line)) {
+        std::string fen = TrimLine(line);
+        if (fen.empty() || fen[0] == '#') continue;
+        freeSlots.acquire();
+        taskGroup.Run([this, &workers, &reorderBuffer, job = BatchJob{index++, std::move(fen)}] {
+            std::unique_ptr<BatchWorker>& worker = workers[ThreadPool::GetWorkerIndex()];
+            if (!worker) worker = CreateWorker();
+            reorderBuffer.Put(job.index, AnalyzeFen(worker->searcher, worker->gameBoard, job));
+        });
+    }
+    reorderBuffer.SetTotal(index);
+
+    taskGroup.Wait();
+    writer.join();
+    return 0;
+}
+
+std::unique_ptr<BatchWorker> BatchAnalyzer::CreateWorker() {
+    std::unique_ptr<BatchWorker> worker = std::make_unique<BatchWorker>();
+    if (!bitbases.IsEmpty()) worker->searcher.SetBitbases(&bitbases);
+    if (analysisCache.IsOpen()) worker->searcher.SetAnalysisCache(&analysisCache);
+    return worker;
+}
+
+std::string BatchAnalyzer::AnalyzeFen(Searcher &searcher, const std::unique_ptr<GameBoard> &gameBoard, const BatchJob &job) const {
+    std::ostringstream line;
+    line << "{\"index\":" << job.index << ",\"fen\":\"" << EscapeJson(job.fen) << '"';
+
+    if (!gameBoard->LoadFen(job.fen)) {
+        line << ",\"error\":\"invalid fen\"}";
+        return line.str();
+    }
+
+    // A fresh table keeps every result independent of which jobs the worker ran before
+    searcher.ClearHash();
+    SearchResult result = searcher.Search(gameBoard, options.limits);
+    line << ",\"bestmove\":";
+    if (result.bestMove.has_value()) {
+        line << '"' << Notation::GetMoveName(result.bestMove.value()) << '"';
+    } else {
+        line << "null";
+    }
+
+    if (result.IsMateScore()) {
+        int plies = MATE_SCORE - std::abs(result.score);
+        int moves = (plies + 1) / 2;
+        line << ",\"mate\":" << (result.score > 0 ? moves : -moves);
+    } else {
+        line << ",\"score\":" << result.score;
+    }
+    line << ",\"depth\":" << result.depth
+         << ",\"nodes\":" << result.nodes
+         << ",\"time_ms\":" << result.timeMs << '}';
+    return line.str();
+}
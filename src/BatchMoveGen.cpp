@@ -0,0 +1,444 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/BatchMoveGen.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CHESSENGINE_X86_KERNELS
+// The wide vectors never cross a call, every kernel helper is inlined into its target specific wrapper
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+#define KERNEL_INLINE [[gnu::always_inline]] inline
+
+namespace {
+    // Bit row * 8 + col as everywhere else, col 0 is the h-file
+    constexpr uint64_t RANK_3 = 0xFFULL << 16;
+    constexpr uint64_t RANK_8 = 0xFFULL << 56;
+    constexpr int KING_START_COL = 3;
+    constexpr uint64_t SHORT_CASTLE_TARGET = 1ULL << 1;
+    constexpr uint64_t SHORT_CASTLE_PATH = 0b110ULL;
+    constexpr uint64_t LONG_CASTLE_TARGET = 1ULL << 5;
+    constexpr uint64_t LONG_CASTLE_PATH = 0b1110000ULL;
+    constexpr uint64_t LONG_CASTLE_SAFE = 0b110000ULL;
+
+    struct Direction {
+        int row;
+        int col;
+        bool orthogonal;
+    };
+    constexpr Direction DIRECTIONS[8] = {
+        {1, 0, true}, {-1, 0, true}, {0, 1, true}, {0, -1, true},
+        {1, 1, false}, {1, -1, false}, {-1, 1, false}, {-1, -1, false}
+    };
+    constexpr int KNIGHT_OFFSETS[8][2] = {
+        {2, 1}, {1, 2}, {-1, 2}, {-2, 1},
+        {-2,-1}, {-1,-2}, {1,-2}, {2,-1}
+    };
+
+    // Squares a shift by this many columns can land on without wrapping into the next row
+    constexpr uint64_t GetColumnMask(int col) {
+        uint64_t mask = 0;
+        for (int row = 0; row < GRID_SIZE; row++) {
+            for (int c = 0; c < GRID_SIZE; c++) {
+                if (c - col >= 0 && c - col < GRID_SIZE) mask |= 1ULL << (row * GRID_SIZE + c);
+            }
+        }
+        return mask;
+    }
+
+    // The kernel is written once against GCC vector extensions and compiled for every target that calls it.
+    // A lane is one position, a one-lane vector is the scalar fallback
+    template<typename V>
+    struct LaneKernel {
+        static constexpr int LANES = sizeof(V) / sizeof(uint64_t);
+
+        // Moves every square by the offset, dropping the squares that would wrap around the board
+        template<int AMOUNT>
+        KERNEL_INLINE static V ShiftRaw(V bitboard) {
+            if constexpr (AMOUNT >= 0) {
+                return bitboard << AMOUNT;
+            } else {
+                return bitboard >> -AMOUNT;
+            }
+        }
+
+        template<int ROW, int COL>
+        KERNEL_INLINE static V Shift(V bitboard) {
+            return ShiftRaw<ROW * GRID_SIZE + COL>(bitboard) & GetColumnMask(COL);
+        }
+
+        // Kogge-Stone fill: every square the sliders reach in one direction, stopping on and including the first piece
+        template<int ROW, int COL>
+        KERNEL_INLINE static V Slide(V sliders, V empty) {
+            constexpr int amount = ROW * GRID_SIZE + COL;
+            V propagator = empty & GetColumnMask(COL);
+            sliders |= propagator & ShiftRaw<amount>(sliders);
+            propagator &= ShiftRaw<amount>(propagator);
+            sliders |= propagator & ShiftRaw<amount * 2>(sliders);
+            propagator &= ShiftRaw<amount * 2>(propagator);
+            sliders |= propagator & ShiftRaw<amount * 4>(sliders);
+            return Shift<ROW, COL>(sliders);
+        }
+
+        KERNEL_INLINE static V Popcount(V bitboard) {
+            V counts;
+            for (int i = 0; i < LANES; i++) {
+                counts[i] = std::popcount(static_cast<uint64_t>(bitboard[i]));
+            }
+            return counts;
+        }
+
+        // All ones in the lanes where the bitboard has any square
+        KERNEL_INLINE static V Any(V bitboard) {
+            return reinterpret_cast<V>(bitboard != 0);
+        }
+
+        KERNEL_INLINE static V Load(const uint64_t *source) {
+            V value;
+            std::memcpy(&value, source, sizeof(V));
+            return value;
+        }
+
+        template<size_t I>
+        KERNEL_INLINE static V GetSliders(V diagonal, V orthogonal) {
+            return DIRECTIONS[I].orthogonal ? orthogonal : diagonal;
+        }
+
+        template<size_t... I>
+        KERNEL_INLINE static V GetSlidingAttacks(V diagonal, V orthogonal, V empty, std::index_sequence<I...>) {
+            return (Slide<DIRECTIONS[I].row, DIRECTIONS[I].col>(GetSliders<I>(diagonal, orthogonal), empty) | ...);
+        }
+
+        template<size_t... I>
+        KERNEL_INLINE static V GetKnightAttacks(V knights, std::index_sequence<I...>) {
+            return (Shift<KNIGHT_OFFSETS[I][0], KNIGHT_OFFSETS[I][1]>(knights) | ...);
+        }
+
+        template<size_t... I>
+        KERNEL_INLINE static V CountKnightMoves(V knights, V targets, std::index_sequence<I...>) {
+            // Each offset moves every knight to a different square, so counting per offset counts each move once
+            return (Popcount(Shift<KNIGHT_OFFSETS[I][0], KNIGHT_OFFSETS[I][1]>(knights) & targets) + ...);
+        }
+
+        template<size_t... I>
+        KERNEL_INLINE static V GetKingAttacks(V king, std::index_sequence<I...>) {
+            return (Shift<DIRECTIONS[I].row, DIRECTIONS[I].col>(king) | ...);
+        }
+
+        KERNEL_INLINE static V CountPawnMoves(V pawns, V empty, V theirPieces, V targets) {
+            V singlePushes = Shift<1, 0>(pawns) & empty;
+            V doublePushes = Shift<1, 0>(singlePushes & RANK_3) & empty & targets;
+            singlePushes &= targets;
+            V leftCaptures = Shift<1, 1>(pawns) & theirPieces & targets;
+            V rightCaptures = Shift<1, -1>(pawns) & theirPieces & targets;
+            // Every promotion square came from one pawn per kind of move, and each one is four moves
+            V promotionMoves = Popcount(singlePushes & RANK_8) + Popcount(leftCaptures & RANK_8) + Popcount(rightCaptures & RANK_8);
+            return Popcount(singlePushes) + Popcount(doublePushes) + Popcount(leftCaptures) + Popcount(rightCaptures) + promotionMoves * 3;
+        }
+
+        struct Lanes {
+            V ourPawns, ourKnights, ourDiagonal, ourOrthogonal, ourKing, ourPieces;
+            V theirPawns, theirKnights, theirDiagonal, theirOrthogonal, theirKing, theirPieces;
+            V empty;
+            V checkers = {};
+            V checkTargets = {};
+            V pinned = {};
+            V pinnedMoves = {};
+            V pinnedRays[8];
+            V pinnedInDirection[8];
+        };
+
+        // Rays from the king find the sliding checkers, and x-rays through one own piece find the pins
+        template<size_t I>
+        KERNEL_INLINE static void ScanFromKing(Lanes &lanes) {
+            constexpr int row = DIRECTIONS[I].row;
+            constexpr int col = DIRECTIONS[I].col;
+            V theirSliders = GetSliders<I>(lanes.theirDiagonal, lanes.theirOrthogonal);
+            V ray = Slide<row, col>(lanes.ourKing, lanes.empty);
+            V checking = Any(ray & theirSliders);
+            lanes.checkers |= ray & theirSliders;
+            lanes.checkTargets |= ray & checking;
+
+            V blocker = ray & lanes.ourPieces;
+            V xray = Slide<row, col>(lanes.ourKing, lanes.empty | blocker);
+            V pin = Any(blocker) & Any(xray & theirSliders);
+            lanes.pinnedInDirection[I] = blocker & pin;
+            lanes.pinnedRays[I] = xray & pin;
+            lanes.pinned |= blocker & pin;
+        }
+
+        // A pinned piece keeps to the line between its king and the pinner
+        template<size_t I>
+        KERNEL_INLINE static V CountPinnedMoves(const Lanes &lanes, V targets) {
+            V pinnedPiece = lanes.pinnedInDirection[I];
+            V ray = lanes.pinnedRays[I] & targets;
+            V slider = Any(pinnedPiece & GetSliders<I>(lanes.ourDiagonal, lanes.ourOrthogonal));
+            V pawnMoves = CountPawnMoves(pinnedPiece & lanes.ourPawns, lanes.empty, lanes.theirPieces, ray);
+            return (Popcount(ray & ~lanes.ourPieces) & slider) + pawnMoves;
+        }
+
+        template<size_t I>
+        KERNEL_INLINE static V CountSlidingMoves(const Lanes &lanes, V freePieces, V targets) {
+            // Rays in one direction never overlap, the rear slider is blocked by the front one
+            V sliders = GetSliders<I>(lanes.ourDiagonal, lanes.ourOrthogonal) & freePieces;
+            return Popcount(Slide<DIRECTIONS[I].row, DIRECTIONS[I].col>(sliders, lanes.empty) & targets);
+        }
+
+        template<size_t... I>
+        KERNEL_INLINE static V CountDirectionalMoves(Lanes &lanes, V freePieces, V targets, std::index_sequence<I...>) {
+            return ((CountSlidingMoves<I>(lanes, freePieces, targets) + CountPinnedMoves<I>(lanes, targets)) + ...);
+        }
+
+        template<size_t... I>
+        KERNEL_INLINE static void ScanAllFromKing(Lanes &lanes, std::index_sequence<I...>) {
+            (ScanFromKing<I>(lanes), ...);
+        }
+
+        KERNEL_INLINE static void Count(const MoveGenBatch &batch, int offset, uint64_t *counts) {
+            constexpr auto directions = std::make_index_sequence<8>();
+            Lanes lanes;
+            lanes.ourPawns = Load(batch.ourPawns + offset);
+            lanes.ourKnights = Load(batch.ourKnights + offset);
+            lanes.ourDiagonal = Load(batch.ourDiagonal + offset);
+            lanes.ourOrthogonal = Load(batch.ourOrthogonal + offset);
+            lanes.ourKing = Load(batch.ourKing + offset);
+            lanes.ourPieces = Load(batch.ourPieces + offset);
+            lanes.theirPawns = Load(batch.theirPawns + offset);
+            lanes.theirKnights = Load(batch.theirKnights + offset);
+            lanes.theirDiagonal = Load(batch.theirDiagonal + offset);
+            lanes.theirOrthogonal = Load(batch.theirOrthogonal + offset);
+            lanes.theirKing = Load(batch.theirKing + offset);
+            lanes.theirPieces = Load(batch.theirPieces + offset);
+            V occupied = lanes.ourPieces | lanes.theirPieces;
+            lanes.empty = ~occupied;
+
+            // The king is lifted off the board, or it could step back along the line of a slider checking it
+            V theirAttacks = Shift<-1, 1>(lanes.theirPawns) | Shift<-1, -1>(lanes.theirPawns)
+                | GetKnightAttacks(lanes.theirKnights, directions) | GetKingAttacks(lanes.theirKing, directions)
+                | GetSlidingAttacks(lanes.theirDiagonal, lanes.theirOrthogonal, lanes.empty | lanes.ourKing, directions);
+            V moves = Popcount(GetKingAttacks(lanes.ourKing, directions) & ~lanes.ourPieces & ~theirAttacks);
+
+            ScanAllFromKing(lanes, directions);
+            V leaperCheckers = (GetKnightAttacks(lanes.ourKing, directions) & lanes.theirKnights)
+                | ((Shift<1, 1>(lanes.ourKing) | Shift<1, -1>(lanes.ourKing)) & lanes.theirPawns);
+            lanes.checkers |= leaperCheckers;
+            lanes.checkTargets |= leaperCheckers;
+
+            // Out of check anything goes, in check a move has to take or block the one checker, in double check only the king moves
+            V checkCount = Popcount(lanes.checkers);
+            V notInCheck = reinterpret_cast<V>(checkCount == 0);
+            V singleCheck = reinterpret_cast<V>(checkCount == 1);
+            V targets = ((notInCheck | (singleCheck & lanes.checkTargets)) & ~lanes.ourPieces);
+            V freePieces = ~lanes.pinned;
+
+            moves += CountKnightMoves(lanes.ourKnights & freePieces, targets, directions);
+            moves += CountPawnMoves(lanes.ourPawns & freePieces, lanes.empty, lanes.theirPieces, targets);
+            moves += CountDirectionalMoves(lanes, freePieces, targets, directions);
+
+            V castleTargets = Load(batch.castleTargets + offset) & notInCheck;
+            V shortCastle = castleTargets & SHORT_CASTLE_TARGET & ~Any(occupied & SHORT_CASTLE_PATH) & ~Any(theirAttacks & SHORT_CASTLE_PATH);
+            V longCastle = castleTargets & LONG_CASTLE_TARGET & ~Any(occupied & LONG_CASTLE_PATH) & ~Any(theirAttacks & LONG_CASTLE_SAFE);
+            moves += Popcount(shortCastle | longCastle);
+            moves += Load(batch.extraMoves + offset);
+            std::memcpy(counts + offset, &moves, sizeof(V));
+        }
+
+        KERNEL_INLINE static void CountBatch(const MoveGenBatch &batch, uint64_t *counts) {
+            for (int offset = 0; offset < MOVEGEN_BATCH_LANES; offset += LANES) {
+                Count(batch, offset, counts);
+            }
+        }
+    };
+
+    using ScalarLanes = uint64_t __attribute__((vector_size(8)));
+
+    void CountScalar(const MoveGenBatch &batch, uint64_t *counts) {
+        LaneKernel<ScalarLanes>::CountBatch(batch, counts);
+    }
+
+#ifdef CHESSENGINE_X86_KERNELS
+    using Avx2Lanes = uint64_t __attribute__((vector_size(32)));
+    using Avx512Lanes = uint64_t __attribute__((vector_size(64)));
+
+    __attribute__((target("avx2,popcnt")))
+    void CountAvx2(const MoveGenBatch &batch, uint64_t *counts) {
+        LaneKernel<Avx2Lanes>::CountBatch(batch, counts);
+    }
+
+    __attribute__((target("avx512f,popcnt")))
+    void CountAvx512(const MoveGenBatch &batch, uint64_t *counts) {
+        LaneKernel<Avx512Lanes>::CountBatch(batch, counts);
+    }
+#endif
+
+    using CountFunction = void (*)(const MoveGenBatch &, uint64_t *);
+
+    CountFunction GetCountFunction(MoveGenKernel kernel) {
+        switch (kernel) {
+#ifdef CHESSENGINE_X86_KERNELS
+            case MoveGenKernel::Avx2:
+                return CountAvx2;
+            case MoveGenKernel::Avx512:
+                return CountAvx512;
+#endif
+            default:
+                return CountScalar;
+        }
+    }
+}
+
+MoveGenKernel BatchMoveGen::DetectKernel() {
+    if (IsSupported(MoveGenKernel::Avx512)) return MoveGenKernel::Avx512;
+    if (IsSupported(MoveGenKernel::Avx2)) return MoveGenKernel::Avx2;
+    return MoveGenKernel::Scalar;
+}
+
+bool BatchMoveGen::IsSupported(MoveGenKernel kernel) {
+    switch (kernel) {
+        case MoveGenKernel::Reference:
+        case MoveGenKernel::Scalar:
+            return true;
+#ifdef CHESSENGINE_X86_KERNELS
+        case MoveGenKernel::Avx2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+        case MoveGenKernel::Avx512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt");
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* BatchMoveGen::GetKernelName(MoveGenKernel kernel) {
+    switch (kernel) {
+        case MoveGenKernel::Reference: return "reference";
+        case MoveGenKernel::Scalar: return "scalar";
+        case MoveGenKernel::Avx2: return "avx2";
+        case MoveGenKernel::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+std::optional<MoveGenKernel> BatchMoveGen::ParseKernel(std::string_view name) {
+    if (name == "auto") return DetectKernel();
+    for (MoveGenKernel kernel : {MoveGenKernel::Reference, MoveGenKernel::Scalar, MoveGenKernel::Avx2, MoveGenKernel::Avx512}) {
+        if (name == GetKernelName(kernel)) return kernel;
+    }
+    return std::nullopt;
+}
+
+void BatchMoveGen::CountLegalMoves(std::span<const Position> positions, std::span<uint32_t> counts, MoveGenKernel kernel) {
+    if (kernel == MoveGenKernel::Reference || !IsSupported(kernel)) {
+        for (size_t i = 0; i < positions.size(); i++) {
+            counts[i] = CountLegalMoves(positions[i]);
+        }
+        return;
+    }
+
+    CountFunction countFunction = GetCountFunction(kernel);
+    MoveGenBatch batch;
+    uint64_t batchCounts[MOVEGEN_BATCH_LANES];
+    for (size_t start = 0; start < positions.size(); start += MOVEGEN_BATCH_LANES) {
+        size_t laneCount = std::min<size_t>(MOVEGEN_BATCH_LANES, positions.size() - start);
+        // Unused lanes stay empty and count nothing
+        std::memset(&batch, 0, sizeof(batch));
+        for (size_t lane = 0; lane < laneCount; lane++) {
+            PackLane(positions[start + lane], batch, static_cast<int>(lane));
+        }
+        countFunction(batch, batchCounts);
+        for (size_t lane = 0; lane < laneCount; lane++) {
+            counts[start + lane] = static_cast<uint32_t>(batchCounts[lane]);
+        }
+    }
+}
+
+uint32_t BatchMoveGen::CountLegalMoves(const Position &position) {
+    BoardMoveQuery moveQuery;
+    MoveSearcher::GetLegalMoves(moveQuery, position);
+    return moveQuery.moveCount;
+}
+
+void BatchMoveGen::PackLane(const Position &position, MoveGenBatch &batch, int lane) {
+    PieceColor color = position.GetSideToMove();
+    // Black to move is mirrored top to bottom, a byte swap of the bitboard
+    int flip = color == PieceColor::White ? 0 : (GRID_SIZE - 1) * GRID_SIZE;
+    for (short row = 0; row < GRID_SIZE; row++) {
+        for (short col = 0; col < GRID_SIZE; col++) {
+            PiecePosition piecePosition{row, col};
+            const Piece& piece = position.GetPiece(piecePosition);
+            if (piece.type == PieceType::None) continue;
+
+            uint64_t mask = 1ULL << (piecePosition.GetBitMapPosition() ^ flip);
+            bool ours = piece.color == color;
+            (ours ? batch.ourPieces : batch.theirPieces)[lane] |= mask;
+            switch (piece.type) {
+                case PieceType::Pawn:
+                    (ours ? batch.ourPawns : batch.theirPawns)[lane] |= mask;
+                    break;
+                case PieceType::Knight:
+                    (ours ? batch.ourKnights : batch.theirKnights)[lane] |= mask;
+                    break;
+                case PieceType::Bishop:
+                    (ours ? batch.ourDiagonal : batch.theirDiagonal)[lane] |= mask;
+                    break;
+                case PieceType::Rook:
+                    (ours ? batch.ourOrthogonal : batch.theirOrthogonal)[lane] |= mask;
+                    break;
+                case PieceType::Queen:
+                    (ours ? batch.ourDiagonal : batch.theirDiagonal)[lane] |= mask;
+                    (ours ? batch.ourOrthogonal : batch.theirOrthogonal)[lane] |= mask;
+                    break;
+                case PieceType::King:
+                    (ours ? batch.ourKing : batch.theirKing)[lane] |= mask;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    // The kernels assume one king a side, anything else is left to the move generator
+    if (std::popcount(batch.ourKing[lane]) != 1 || std::popcount(batch.theirKing[lane]) != 1) {
+        for (uint64_t* field : {batch.ourPawns, batch.ourKnights, batch.ourDiagonal, batch.ourOrthogonal, batch.ourKing, batch.ourPieces,
+                                batch.theirPawns, batch.theirKnights, batch.theirDiagonal, batch.theirOrthogonal, batch.theirKing, batch.theirPieces}) {
+            field[lane] = 0;
+        }
+        batch.extraMoves[lane] = CountLegalMoves(position);
+        return;
+    }
+
+    // Castling rights live in the move state of the king and rooks, as the move generator reads them
+    short homeRow = color == PieceColor::White ? 0 : GRID_SIZE - 1;
+    const Piece& king = position.GetPiece(PiecePosition{homeRow, KING_START_COL});
+    if (king.type == PieceType::King && king.color == color && king.moveState == PieceMoveState::NotMoved) {
+        auto hasUnmovedRook = [&position, homeRow](short col) {
+            const Piece& rook = position.GetPiece(PiecePosition{homeRow, col});
+            return rook.type == PieceType::Rook && rook.moveState == PieceMoveState::NotMoved;
+        };
+        if (hasUnmovedRook(0)) batch.castleTargets[lane] |= SHORT_CASTLE_TARGET;
+        if (hasUnmovedRook(GRID_SIZE - 1)) batch.castleTargets[lane] |= LONG_CASTLE_TARGET;
+    }
+
+    // En passant can uncover a check along the rank, which is rare enough to play out on a copy
+    const PieceMoveHistory& lastMove = position.GetLastMove();
+    if (lastMove.piece.type != PieceType::Pawn || lastMove.piece.color == color || lastMove.move.type != MoveType::DoublePawnPush) return;
+    int direction = color == PieceColor::White ? 1 : -1;
+    PiecePosition target = lastMove.move.position;
+    for (int side : {-1, 1}) {
+        PiecePosition from{target.row, static_cast<short>(target.col + side)};
+        if (from.OutOfBounds()) continue;
+        const Piece& pawn = position.GetPiece(from);
+        if (pawn.type != PieceType::Pawn || pawn.color != color) continue;
+
+        Position nextPosition = position;
+        nextPosition.ExecuteMove(PieceMove{MoveType::EnPassant, PiecePosition{static_cast<short>(target.row + direction), target.col}}, from);
+        if (!MoveSearcher::IsInCheck(color, nextPosition)) batch.extraMoves[lane]++;
+    }
+}
@@ -0,0 +1,311 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/Bitbase.h"
+
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+#include "../include/Zobrist.h"
+
+namespace {
+    constexpr int PAWN_KING_SQUARES = 32;
+    constexpr int PAWNLESS_KING_SQUARES = 10;
+
+    // a1-d1-d4 triangle, every pawnless position folds onto a strong king inside it
+    constexpr std::array<int, PAWNLESS_KING_SQUARES> TRIANGLE_SQUARES = {0, 1, 2, 3, 9, 10, 11, 18, 19, 27};
+
+    constexpr std::array<int, 64> MakeTriangleIndices() {
+        std::array<int, 64> indices {};
+        indices.fill(-1);
+        for (int i = 0; i < PAWNLESS_KING_SQUARES; i++) {
+            indices[TRIANGLE_SQUARES[i]] = i;
+        }
+        return indices;
+    }
+    constexpr std::array<int, 64> TRIANGLE_INDICES = MakeTriangleIndices();
+
+    char GetPieceLetter(PieceType pieceType) {
+        switch (pieceType) {
+            case PieceType::Queen: return 'Q';
+            case PieceType::Rook: return 'R';
+            case PieceType::Bishop: return 'B';
+            case PieceType::Knight: return 'N';
+            case PieceType::Pawn: return 'P';
+            default: return 'K';
+        }
+    }
+
+    void TransformSquares(BitbasePosition &position, int (*transform)(int)) {
+        for (int i = 0; i < position.pieceCount; i++) {
+            position.pieces[i].square = transform(position.pieces[i].square);
+        }
+    }
+}
+
+std::optional<BitbaseMaterial> BitbaseMaterial::Parse(std::string_view materialName) {
+    if (materialName.size() < 2 || materialName.size() > BITBASE_MAX_PIECES + 1 || materialName[0] != 'K') return std::nullopt;
+    size_t weakKing = materialName.find('K', 1);
+    if (weakKing == std::string_view::npos) return std::nullopt;
+
+    BitbaseMaterial material;
+    material.name = std::string(materialName);
+    for (size_t i = 1; i < materialName.size(); i++) {
+        if (i == weakKing) continue;
+
+        PieceType pieceType;
+        switch (materialName[i]) {
+            case 'Q': pieceType = PieceType::Queen; break;
+            case 'R': pieceType = PieceType::Rook; break;
+            case 'B': pieceType = PieceType::Bishop; break;
+            case 'N': pieceType = PieceType::Knight; break;
+            case 'P': pieceType = PieceType::Pawn; break;
+            default: return std::nullopt;
+        }
+        std::vector<PieceType>& pieces = i < weakKing ? material.strongPieces : material.weakPieces;
+        if (!pieces.empty() && GetPieceOrder(pieces.back()) >= GetPieceOrder(pieceType)) return std::nullopt;
+        pieces.push_back(pieceType);
+        material.key += 1u << (3 * GetPieceOrder(pieceType) + (i < weakKing ? 0 : BITBASE_KEY_SIDE_SHIFT));
+        material.hasPawns |= pieceType == PieceType::Pawn;
+    }
+    return material;
+}
+
+std::string BitbaseMaterial::GetName(const BitbasePosition &position, bool strongFirst) {
+    std::array<PieceType, BITBASE_MAX_PIECES> firstPieces {};
+    std::array<PieceType, BITBASE_MAX_PIECES> secondPieces {};
+    int firstCount = 0;
+    int secondCount = 0;
+    // Inserted in order as they are found, there are never more than two
+    auto insert = [](std::array<PieceType, BITBASE_MAX_PIECES> &pieces, int &count, PieceType pieceType) {
+        int slot = count++;
+        for (; slot > 0 && GetPieceOrder(pieces[slot - 1]) > GetPieceOrder(pieceType); slot--) {
+            pieces[slot] = pieces[slot - 1];
+        }
+        pieces[slot] = pieceType;
+    };
+    for (int i = 2; i < position.pieceCount; i++) {
+        const BitbasePiece& piece = position.pieces[i];
+        if (piece.strong == strongFirst) {
+            insert(firstPieces, firstCount, piece.type);
+        } else {
+            insert(secondPieces, secondCount, piece.type);
+        }
+    }
+
+    std::string name = "K";
+    for (int i = 0; i < firstCount; i++) name += GetPieceLetter(firstPieces[i]);
+    name += 'K';
+    for (int i = 0; i < secondCount; i++) name += GetPieceLetter(secondPieces[i]);
+    return name;
+}
+
+uint32_t BitbaseMaterial::GetKey(const BitbasePosition &position, bool strongFirst) {
+    uint32_t key = 0;
+    for (int i = 2; i < position.pieceCount; i++) {
+        const BitbasePiece& piece = position.pieces[i];
+        key += 1u << (3 * GetPieceOrder(piece.type) + (piece.strong == strongFirst ? 0 : BITBASE_KEY_SIDE_SHIFT));
+    }
+    return key;
+}
+
+int BitbaseMaterial::GetPieceOrder(PieceType pieceType) {
+    switch (pieceType) {
+        case PieceType::Queen: return 0;
+        case PieceType::Rook: return 1;
+        case PieceType::Bishop: return 2;
+        case PieceType::Knight: return 3;
+        case PieceType::Pawn: return 4;
+        default: return 5;
+    }
+}
+
+BitbasePosition BitbaseMaterial::Flip(const BitbasePosition &position) {
+    BitbasePosition flipped = position;
+    std::swap(flipped.pieces[0], flipped.pieces[1]);
+    for (int i = 0; i < flipped.pieceCount; i++) {
+        flipped.pieces[i].strong = !flipped.pieces[i].strong;
+        flipped.pieces[i].square ^= 56;
+    }
+    flipped.strongToMove = !position.strongToMove;
+    return flipped;
+}
+
+uint64_t BitbaseMaterial::GetPositionCount() const {
+    uint64_t count = hasPawns ? PAWN_KING_SQUARES : PAWNLESS_KING_SQUARES;
+    for (size_t i = 0; i < 1 + strongPieces.size() + weakPieces.size(); i++) {
+        count *= 64;
+    }
+    return count * 2;
+}
+
+uint64_t BitbaseMaterial::GetIndex(BitbasePosition position) const {
+    int kingSquare = position.pieces[0].square;
+    if ((kingSquare & 7) >= 4) {
+        TransformSquares(position, [](int square) { return square ^ 7; });
+        kingSquare ^= 7;
+    }
+
+    uint64_t index;
+    if (hasPawns) {
+        index = (kingSquare >> 3) * 4 + (kingSquare & 7);
+    } else {
+        if ((kingSquare >> 3) >= 4) {
+            TransformSquares(position, [](int square) { return square ^ 56; });
+            kingSquare ^= 56;
+        }
+        if ((kingSquare >> 3) > (kingSquare & 7)) {
+            TransformSquares(position, [](int square) { return ((square & 7) << 3) | (square >> 3); });
+            kingSquare = ((kingSquare & 7) << 3) | (kingSquare >> 3);
+        }
+        index = TRIANGLE_INDICES[kingSquare];
+    }
+
+    for (int i = 1; i < position.pieceCount; i++) {
+        index = index * 64 + position.pieces[i].square;
+    }
+    return index * 2 + (position.strongToMove ? 1 : 0);
+}
+
+void BitbaseMaterial::Decode(uint64_t index, BitbasePosition &position) const {
+    position.pieceCount = static_cast<int>(2 + strongPieces.size() + weakPieces.size());
+    position.strongToMove = (index & 1) != 0;
+    index >>= 1;
+
+    int pieceIndex = 2;
+    for (PieceType pieceType : strongPieces) position.pieces[pieceIndex++] = BitbasePiece{pieceType, true, 0};
+    for (PieceType pieceType : weakPieces) position.pieces[pieceIndex++] = BitbasePiece{pieceType, false, 0};
+
+    for (int i = position.pieceCount - 1; i >= 1; i--) {
+        position.pieces[i].square = static_cast<int>(index % 64);
+        index /= 64;
+    }
+    position.pieces[1].type = PieceType::King;
+    position.pieces[1].strong = false;
+
+    int kingSquare = hasPawns ? static_cast<int>((index / 4) * 8 + index % 4) : TRIANGLE_SQUARES[index];
+    position.pieces[0] = BitbasePiece{PieceType::King, true, kingSquare};
+}
+
+void BitbaseMaterial::SortPieces(BitbasePosition &position) const {
+    auto comesBefore = [](const BitbasePiece &a, const BitbasePiece &b) {
+        if (a.strong != b.strong) return a.strong;
+        return GetPieceOrder(a.type) < GetPieceOrder(b.type);
+    };
+    // At most two pieces besides the kings, an insertion sort is all it takes
+    for (int i = 3; i < position.pieceCount; i++) {
+        BitbasePiece piece = position.pieces[i];
+        int slot = i;
+        for (; slot > 2 && comesBefore(piece, position.pieces[slot - 1]); slot--) {
+            position.pieces[slot] = position.pieces[slot - 1];
+        }
+        position.pieces[slot] = piece;
+    }
+}
+
+bool BitbaseTable::Open(const std::string &path) {
+    if (!mappedFile.Open(path, MappedFileAccess::Random)) return false;
+    if (mappedFile.GetSize() < sizeof(BitbaseHeader)) return false;
+
+    BitbaseHeader header;
+    std::memcpy(&header, mappedFile.GetData(), sizeof(header));
+    if (std::memcmp(header.magic, "CEBB", 4) != 0 || header.version != BITBASE_VERSION) return false;
+    if (header.bitsPerEntry != 1 && header.bitsPerEntry != 2) return false;
+
+    std::optional<BitbaseMaterial> parsedMaterial = BitbaseMaterial::Parse(std::string_view(header.material, strnlen(header.material, sizeof(header.material))));
+    if (!parsedMaterial.has_value() || parsedMaterial->GetPositionCount() != header.entryCount) return false;
+    if (mappedFile.GetSize() < sizeof(BitbaseHeader) + (header.entryCount * header.bitsPerEntry + 7) / 8) return false;
+
+    material = std::move(parsedMaterial.value());
+    bitsPerEntry = header.bitsPerEntry;
+    entryCount = header.entryCount;
+    data = reinterpret_cast<const uint8_t*>(mappedFile.GetData()) + sizeof(BitbaseHeader);
+    return true;
+}
+
+BitbaseResult BitbaseTable::Probe(uint64_t index, bool strongToMove) const {
+    if (bitsPerEntry == 1) {
+        // One bit tables only store whether the strong side wins
+        bool decisive = (data[index >> 3] >> (index & 7)) & 1;
+        if (!decisive) return BitbaseResult::Draw;
+        return strongToMove ? BitbaseResult::Win : BitbaseResult::Loss;
+    }
+    uint64_t bit = index * 2;
+    return static_cast<BitbaseResult>((data[bit >> 3] >> (bit & 7)) & 3);
+}
+
+int Bitbases::LoadDirectory(const std::string &directory) {
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.path().extension() != BITBASE_EXTENSION) continue;
+
+        std::unique_ptr<BitbaseTable> table = std::make_unique<BitbaseTable>();
+        if (table->Open(entry.path().string())) {
+            tablesByKey.emplace(table->GetMaterial().key, table.get());
+            tables.push_back(std::move(table));
+        }
+    }
+    return static_cast<int>(tables.size());
+}
+
+std::optional<BitbaseResult> Bitbases::Probe(const GameBoard &gameBoard) const {
+    if (tables.empty()) return std::nullopt;
+
+    std::optional<BitbasePosition> position = GetPosition(gameBoard);
+    if (!position.has_value()) return std::nullopt;
+    // Tables know nothing about castling
+    if (Zobrist::GetCastleRights(gameBoard) != CastleNone) return std::nullopt;
+
+    BitbasePosition oriented;
+    auto found = tablesByKey.find(BitbaseMaterial::GetKey(position.value(), true));
+    if (found != tablesByKey.end()) {
+        oriented = position.value();
+    } else if (found = tablesByKey.find(BitbaseMaterial::GetKey(position.value(), false)); found != tablesByKey.end()) {
+        oriented = BitbaseMaterial::Flip(position.value());
+    } else {
+        return std::nullopt;
+    }
+
+    const BitbaseTable& table = *found->second;
+    table.GetMaterial().SortPieces(oriented);
+    BitbaseResult result = table.Probe(table.GetMaterial().GetIndex(oriented), oriented.strongToMove);
+    if (result == BitbaseResult::Unknown) return std::nullopt;
+    return result;
+}
+
+std::optional<BitbasePosition> Bitbases::GetPosition(const GameBoard &gameBoard) {
+    uint64_t whiteSquares = gameBoard.GetColorBitBoards(PieceColor::White).occupiedSquares;
+    uint64_t blackSquares = gameBoard.GetColorBitBoards(PieceColor::Black).occupiedSquares;
+    uint64_t occupied = whiteSquares | blackSquares;
+    if (std::popcount(occupied) > BITBASE_MAX_PIECES) return std::nullopt;
+
+    BitbasePosition position {};
+    position.pieceCount = 2;
+    position.strongToMove = gameBoard.GetSideToMove() == PieceColor::White;
+    bool kingsFound[2] = {false, false};
+
+    while (occupied != 0) {
+        int bit = std::countr_zero(occupied);
+        occupied &= occupied - 1;
+
+        PiecePosition piecePosition{static_cast<short>(bit / GRID_SIZE), static_cast<short>(bit % GRID_SIZE)};
+        const Piece& piece = gameBoard.GetPiece(piecePosition);
+        bool strong = piece.color == PieceColor::White;
+        // Bitboards run from the h file, bitbase squares from the a file
+        BitbasePiece bitbasePiece{piece.type, strong, piecePosition.row * 8 + (GRID_SIZE - piecePosition.col - 1)};
+
+        if (piece.type == PieceType::King) {
+            int kingSlot = strong ? 0 : 1;
+            position.pieces[kingSlot] = bitbasePiece;
+            kingsFound[kingSlot] = true;
+        } else {
+            if (position.pieceCount == BITBASE_MAX_PIECES) return std::nullopt;
+            position.pieces[position.pieceCount++] = bitbasePiece;
+        }
+    }
+    if (!kingsFound[0] || !kingsFound[1]) return std::nullopt;
+    return position;
+}
@@ -0,0 +1,483 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/BitbaseGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "../include/ArgParse.h"
+#include "../include/MoveSearcher.h"
+#include "../include/ThreadPool.h"
+
+namespace {
+    constexpr uint64_t PARALLEL_CHUNK = 16384;
+
+    constexpr int KING_STEPS[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    constexpr int KNIGHT_STEPS[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+    constexpr PieceType PROMOTIONS[] = {PieceType::Queen, PieceType::Rook, PieceType::Bishop, PieceType::Knight};
+
+    // Steps are {file, rank}, returns -1 when the step leaves the board
+    int GetOffsetSquare(int square, int fileStep, int rankStep) {
+        int file = (square & 7) + fileStep;
+        int rank = (square >> 3) + rankStep;
+        if (file < 0 || file >= GRID_SIZE || rank < 0 || rank >= GRID_SIZE) return -1;
+        return rank * 8 + file;
+    }
+
+    int FindPieceAt(const BitbasePosition &position, int square) {
+        for (int i = 0; i < position.pieceCount; i++) {
+            if (position.pieces[i].square == square) return i;
+        }
+        return -1;
+    }
+
+    // Moves never reorder pieces, so equal types slot by slot means the material did not change
+    bool IsSameMaterial(const BitbasePosition &parent, const BitbasePosition &child) {
+        if (parent.pieceCount != child.pieceCount) return false;
+        for (int i = 2; i < parent.pieceCount; i++) {
+            if (parent.pieces[i].type != child.pieces[i].type) return false;
+        }
+        return true;
+    }
+
+    bool IsSliderStep(PieceType pieceType, int fileStep, int rankStep) {
+        bool straight = fileStep == 0 || rankStep == 0;
+        if (pieceType == PieceType::Queen) return true;
+        if (pieceType == PieceType::Rook) return straight;
+        return !straight;
+    }
+}
+
+bool BitbaseGeneratorOptions::ParseArgs(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--verify" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], verifySamples)) return false;
+        } else if (arg == "--tables" && hasValue) {
+            materials.clear();
+            std::stringstream list(argv[++i]);
+            std::string material;
+            while (std::getline(list, material, ',')) {
+                materials.push_back(material);
+            }
+        } else if (arg == "--output" && hasValue) {
+            outputDirectory = argv[++i];
+        }
+    }
+    return true;
+}
+
+BitbaseGenerator::BitbaseGenerator(BitbaseGeneratorOptions options) : options(std::move(options)) {
+}
+
+int BitbaseGenerator::Run() {
+    if (options.outputDirectory.empty()) {
+        std::cerr << "No bitbase output directory given\n";
+        return 1;
+    }
+    std::filesystem::create_directories(options.outputDirectory);
+
+    for (const std::string& materialName : options.materials) {
+        if (!Generate(materialName)) {
+            std::cerr << "Cannot generate " << materialName << '\n';
+            return 1;
+        }
+        int mismatches = Verify(materialName);
+        if (mismatches != 0) {
+            std::cerr << materialName << ": " << mismatches << " positions disagree with MoveSearcher\n";
+            return 1;
+        }
+        if (!Write(materialName)) {
+            std::cerr << "Failed to write " << materialName << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
+
+bool BitbaseGenerator::Generate(const std::string &materialName) {
+    std::optional<BitbaseMaterial> material = BitbaseMaterial::Parse(materialName);
+    if (!material.has_value() || 2 + material->strongPieces.size() + material->weakPieces.size() > BITBASE_MAX_PIECES) return false;
+    if (tables.contains(materialName)) return true;
+
+    auto startTime = std::chrono::steady_clock::now();
+    uint64_t positionCount = material->GetPositionCount();
+    auto table = std::make_unique<GeneratedTable>();
+    table->material = std::move(material.value());
+    table->results = std::vector<std::atomic<uint8_t>>(positionCount);
+
+    ParallelFor(positionCount, [this, &table](uint64_t start, uint64_t end) {
+        BitbasePosition position;
+        for (uint64_t index = start; index < end; index++) {
+            table->material.Decode(index, position);
+            table->results[index].store(IsValid(position) ? UNRESOLVED : INVALID, std::memory_order_relaxed);
+        }
+    });
+
+    // Every pass settles the positions one ply further from mate; results written during a pass are used straight away
+    std::atomic<bool> changed = true;
+    int passes = 0;
+    while (changed.load()) {
+        changed = false;
+        ParallelFor(positionCount, [this, &table, &changed](uint64_t start, uint64_t end) {
+            BitbasePosition position;
+            for (uint64_t index = start; index < end; index++) {
+                if (table->results[index].load(std::memory_order_relaxed) != UNRESOLVED) continue;
+                table->material.Decode(index, position);
+                uint8_t state = Evaluate(*table, position);
+                if (state == UNRESOLVED) continue;
+                table->results[index].store(state, std::memory_order_relaxed);
+                changed.store(true, std::memory_order_relaxed);
+            }
+        });
+        passes++;
+    }
+
+    // What is left is a draw unless it can reach a position whose value no table knows
+    changed = true;
+    while (changed.load()) {
+        changed = false;
+        ParallelFor(positionCount, [this, &table, &changed](uint64_t start, uint64_t end) {
+            BitbasePosition position;
+            std::array<BitbasePosition, BITBASE_MAX_CHILDREN> children;
+            for (uint64_t index = start; index < end; index++) {
+                if (table->results[index].load(std::memory_order_relaxed) != UNRESOLVED) continue;
+                table->material.Decode(index, position);
+                int childCount = GetChildren(position, children);
+                for (int i = 0; i < childCount; i++) {
+                    if (GetChildState(*table, position, children[i]) != static_cast<uint8_t>(BitbaseResult::Unknown)) continue;
+                    table->results[index].store(static_cast<uint8_t>(BitbaseResult::Unknown), std::memory_order_relaxed);
+                    changed.store(true, std::memory_order_relaxed);
+                    break;
+                }
+            }
+        });
+    }
+
+    uint64_t counts[4] = {};
+    for (std::atomic<uint8_t>& result : table->results) {
+        uint8_t state = result.load(std::memory_order_relaxed);
+        if (state == UNRESOLVED) {
+            state = static_cast<uint8_t>(BitbaseResult::Draw);
+            result.store(state, std::memory_order_relaxed);
+        }
+        if (state != INVALID) counts[state]++;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << materialName << ": " << positionCount << " indices, " << passes << " passes, "
+              << counts[static_cast<int>(BitbaseResult::Win)] << " win, "
+              << counts[static_cast<int>(BitbaseResult::Draw)] << " draw, "
+              << counts[static_cast<int>(BitbaseResult::Loss)] << " loss, "
+              << counts[static_cast<int>(BitbaseResult::Unknown)] << " unknown in " << seconds << "s\n";
+
+    tables[materialName] = std::move(table);
+    return true;
+}
+
+bool BitbaseGenerator::Write(const std::string &materialName) const {
+    auto iterator = tables.find(materialName);
+    if (iterator == tables.end()) return false;
+    const GeneratedTable& table = *iterator->second;
+    uint64_t positionCount = table.results.size();
+
+    // When the weaker side can never win and nothing is unknown, one bit per position is enough
+    bool singleBit = true;
+    for (uint64_t index = 0; index < positionCount && singleBit; index++) {
+        uint8_t state = table.results[index].load(std::memory_order_relaxed);
+        if (state == INVALID || state == static_cast<uint8_t>(BitbaseResult::Draw)) continue;
+        bool strongToMove = (index & 1) != 0;
+        BitbaseResult strongWin = strongToMove ? BitbaseResult::Win : BitbaseResult::Loss;
+        singleBit = state == static_cast<uint8_t>(strongWin);
+    }
+
+    uint32_t bitsPerEntry = singleBit ? 1 : 2;
+    std::vector<uint8_t> data((positionCount * bitsPerEntry + 7) / 8, 0);
+    for (uint64_t index = 0; index < positionCount; index++) {
+        uint8_t state = table.results[index].load(std::memory_order_relaxed);
+        if (state == INVALID) state = static_cast<uint8_t>(BitbaseResult::Draw);
+        uint8_t value = singleBit ? (state != static_cast<uint8_t>(BitbaseResult::Draw)) : state;
+        uint64_t bit = index * bitsPerEntry;
+        data[bit >> 3] |= static_cast<uint8_t>(value << (bit & 7));
+    }
+
+    BitbaseHeader header {};
+    std::copy_n("CEBB", 4, header.magic);
+    header.version = BITBASE_VERSION;
+    std::copy_n(materialName.c_str(), std::min(materialName.size(), sizeof(header.material) - 1), header.material);
+    header.bitsPerEntry = bitsPerEntry;
+    header.entryCount = positionCount;
+
+    std::filesystem::path path = std::filesystem::path(options.outputDirectory) / (materialName + BITBASE_EXTENSION);
+    std::ofstream output(path, std::ios::binary);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!output) return false;
+
+    std::cout << "Wrote " << path.string() << " (" << bitsPerEntry << " bit, " << sizeof(header) + data.size() << " bytes)\n";
+    return true;
+}
+
+int BitbaseGenerator::Verify(const std::string &materialName) const {
+    auto iterator = tables.find(materialName);
+    if (iterator == tables.end()) return 0;
+    const GeneratedTable& table = *iterator->second;
+
+    std::mt19937_64 random(0x5eed);
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    BoardMoveQuery moveQuery;
+    int mismatches = 0;
+    for (int sample = 0; sample < options.verifySamples; sample++) {
+        uint64_t index = random() % table.results.size();
+        if (table.results[index].load(std::memory_order_relaxed) == INVALID) continue;
+
+        BitbasePosition position;
+        table.material.Decode(index, position);
+        std::array<BitbasePosition, BITBASE_MAX_CHILDREN> children;
+        int childCount = GetChildren(position, children);
+
+        std::string fen = GetFen(position);
+        gameBoard->LoadFen(fen);
+        MoveSearcher::GetLegalMoves(moveQuery, *gameBoard);
+        if (moveQuery.moveCount != childCount) {
+            if (mismatches < 5) std::cerr << fen << ": " << childCount << " moves, MoveSearcher has " << moveQuery.moveCount << '\n';
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+void BitbaseGenerator::ParallelFor(uint64_t count, const std::function<void(uint64_t, uint64_t)> &body) const {
+    TaskGroup taskGroup;
+    taskGroup.RunRange(count, PARALLEL_CHUNK, body);
+    taskGroup.Wait();
+}
+
+bool BitbaseGenerator::IsValid(const BitbasePosition &position) const {
+    for (int i = 0; i < position.pieceCount; i++) {
+        const BitbasePiece& piece = position.pieces[i];
+        if (piece.type == PieceType::Pawn && ((piece.square >> 3) == 0 || (piece.square >> 3) == GRID_SIZE - 1)) return false;
+        for (int j = i + 1; j < position.pieceCount; j++) {
+            if (position.pieces[j].square == piece.square) return false;
+        }
+    }
+    // The side that just moved cannot have left its king in check, this also keeps the kings apart
+    int waitingKing = position.pieces[position.strongToMove ? 1 : 0].square;
+    return !IsAttacked(position, waitingKing, position.strongToMove);
+}
+
+int BitbaseGenerator::GetChildren(const BitbasePosition &position, std::array<BitbasePosition, BITBASE_MAX_CHILDREN> &children) const {
+    int count = 0;
+    bool strong = position.strongToMove;
+
+    // Returns true when the target square was empty, so sliders know to keep going
+    auto addMove = [&](int pieceIndex, int target, PieceType promotion) {
+        int occupant = FindPieceAt(position, target);
+        if (occupant >= 0 && (position.pieces[occupant].strong == strong || position.pieces[occupant].type == PieceType::King)) return false;
+
+        BitbasePosition child = position;
+        child.pieces[pieceIndex].square = target;
+        if (promotion != PieceType::None) child.pieces[pieceIndex].type = promotion;
+        if (occupant >= 0) {
+            for (int i = occupant; i + 1 < child.pieceCount; i++) {
+                child.pieces[i] = child.pieces[i + 1];
+            }
+            child.pieceCount--;
+        }
+        child.strongToMove = !strong;
+
+        int kingSquare = child.pieces[strong ? 0 : 1].square;
+        if (!IsAttacked(child, kingSquare, !strong)) children[count++] = child;
+        return occupant < 0;
+    };
+
+    for (int i = 0; i < position.pieceCount; i++) {
+        const BitbasePiece& piece = position.pieces[i];
+        if (piece.strong != strong) continue;
+
+        switch (piece.type) {
+            case PieceType::King:
+            case PieceType::Knight: {
+                const int (*steps)[2] = piece.type == PieceType::King ? KING_STEPS : KNIGHT_STEPS;
+                for (int s = 0; s < 8; s++) {
+                    int target = GetOffsetSquare(piece.square, steps[s][0], steps[s][1]);
+                    if (target >= 0) addMove(i, target, PieceType::None);
+                }
+                break;
+            }
+            case PieceType::Queen:
+            case PieceType::Rook:
+            case PieceType::Bishop:
+                for (const auto& step : KING_STEPS) {
+                    if (!IsSliderStep(piece.type, step[0], step[1])) continue;
+                    int target = GetOffsetSquare(piece.square, step[0], step[1]);
+                    while (target >= 0 && addMove(i, target, PieceType::None)) {
+                        target = GetOffsetSquare(target, step[0], step[1]);
+                    }
+                }
+                break;
+            case PieceType::Pawn: {
+                int direction = strong ? 1 : -1;
+                int rank = piece.square >> 3;
+                bool promotes = rank + direction == (strong ? GRID_SIZE - 1 : 0);
+                auto addPawnMove = [&](int target) {
+                    if (!promotes) {
+                        addMove(i, target, PieceType::None);
+                        return;
+                    }
+                    for (PieceType promotion : PROMOTIONS) addMove(i, target, promotion);
+                };
+
+                int push = GetOffsetSquare(piece.square, 0, direction);
+                if (push >= 0 && FindPieceAt(position, push) < 0) {
+                    addPawnMove(push);
+                    int doublePush = GetOffsetSquare(push, 0, direction);
+                    if (rank == (strong ? 1 : GRID_SIZE - 2) && FindPieceAt(position, doublePush) < 0) {
+                        addMove(i, doublePush, PieceType::None);
+                    }
+                }
+                for (int fileStep : {-1, 1}) {
+                    int target = GetOffsetSquare(piece.square, fileStep, direction);
+                    if (target >= 0 && FindPieceAt(position, target) >= 0) addPawnMove(target);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return count;
+}
+
+uint8_t BitbaseGenerator::GetChildState(const GeneratedTable &table, const BitbasePosition &parent, BitbasePosition child) const {
+    if (IsSameMaterial(parent, child)) {
+        return table.results[table.material.GetIndex(child)].load(std::memory_order_relaxed);
+    }
+
+    std::string strongFirstName = BitbaseMaterial::GetName(child, true);
+    if (IsInsufficientMaterial(strongFirstName)) return static_cast<uint8_t>(BitbaseResult::Draw);
+
+    // Captures and promotions move into tables generated earlier
+    const GeneratedTable* childTable = nullptr;
+    if (auto iterator = tables.find(strongFirstName); iterator != tables.end()) {
+        childTable = iterator->second.get();
+    } else if (iterator = tables.find(BitbaseMaterial::GetName(child, false)); iterator != tables.end()) {
+        childTable = iterator->second.get();
+        child = BitbaseMaterial::Flip(child);
+    }
+    if (childTable == nullptr) return static_cast<uint8_t>(BitbaseResult::Unknown);
+
+    childTable->material.SortPieces(child);
+    return childTable->results[childTable->material.GetIndex(child)].load(std::memory_order_relaxed);
+}
+
+uint8_t BitbaseGenerator::Evaluate(const GeneratedTable &table, const BitbasePosition &position) const {
+    std::array<BitbasePosition, BITBASE_MAX_CHILDREN> children;
+    int childCount = GetChildren(position, children);
+    if (childCount == 0) {
+        int kingSquare = position.pieces[position.strongToMove ? 0 : 1].square;
+        bool inCheck = IsAttacked(position, kingSquare, !position.strongToMove);
+        return static_cast<uint8_t>(inCheck ? BitbaseResult::Loss : BitbaseResult::Draw);
+    }
+
+    bool allChildrenWin = true;
+    for (int i = 0; i < childCount; i++) {
+        uint8_t childState = GetChildState(table, position, children[i]);
+        if (childState == static_cast<uint8_t>(BitbaseResult::Loss)) return static_cast<uint8_t>(BitbaseResult::Win);
+        if (childState != static_cast<uint8_t>(BitbaseResult::Win)) allChildrenWin = false;
+    }
+    return allChildrenWin ? static_cast<uint8_t>(BitbaseResult::Loss) : UNRESOLVED;
+}
+
+bool BitbaseGenerator::IsAttacked(const BitbasePosition &position, int square, bool byStrong) {
+    int targetFile = square & 7;
+    int targetRank = square >> 3;
+    for (int i = 0; i < position.pieceCount; i++) {
+        const BitbasePiece& piece = position.pieces[i];
+        if (piece.strong != byStrong || piece.square == square) continue;
+
+        int fileDelta = targetFile - (piece.square & 7);
+        int rankDelta = targetRank - (piece.square >> 3);
+        int absFile = std::abs(fileDelta);
+        int absRank = std::abs(rankDelta);
+        switch (piece.type) {
+            case PieceType::King:
+                if (std::max(absFile, absRank) == 1) return true;
+                break;
+            case PieceType::Knight:
+                if (absFile * absRank == 2) return true;
+                break;
+            case PieceType::Pawn:
+                if (absFile == 1 && rankDelta == (byStrong ? 1 : -1)) return true;
+                break;
+            default: {
+                bool straight = fileDelta == 0 || rankDelta == 0;
+                bool diagonal = absFile == absRank;
+                if (!straight && !diagonal) break;
+                int fileStep = (fileDelta > 0) - (fileDelta < 0);
+                int rankStep = (rankDelta > 0) - (rankDelta < 0);
+                if (!IsSliderStep(piece.type, fileStep, rankStep)) break;
+
+                bool blocked = false;
+                for (int between = GetOffsetSquare(piece.square, fileStep, rankStep); between != square; between = GetOffsetSquare(between, fileStep, rankStep)) {
+                    if (FindPieceAt(position, between) >= 0) {
+                        blocked = true;
+                        break;
+                    }
+                }
+                if (!blocked) return true;
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+bool BitbaseGenerator::IsInsufficientMaterial(const std::string &materialName) {
+    return materialName == "KK" || materialName == "KBK" || materialName == "KNK" || materialName == "KKB" || materialName == "KKN";
+}
+
+std::string BitbaseGenerator::GetFen(const BitbasePosition &position) {
+    char squares[64];
+    std::fill(std::begin(squares), std::end(squares), ' ');
+    for (int i = 0; i < position.pieceCount; i++) {
+        const BitbasePiece& piece = position.pieces[i];
+        char letter;
+        switch (piece.type) {
+            case PieceType::King: letter = 'k'; break;
+            case PieceType::Queen: letter = 'q'; break;
+            case PieceType::Rook: letter = 'r'; break;
+            case PieceType::Bishop: letter = 'b'; break;
+            case PieceType::Knight: letter = 'n'; break;
+            default: letter = 'p'; break;
+        }
+        squares[piece.square] = piece.strong ? static_cast<char>(std::toupper(letter)) : letter;
+    }
+
+    std::string fen;
+    for (int rank = GRID_SIZE - 1; rank >= 0; rank--) {
+        int empty = 0;
+        for (int file = 0; file < GRID_SIZE; file++) {
+            char square = squares[rank * 8 + file];
+            if (square == ' ') {
+                empty++;
+                continue;
+            }
+            if (empty > 0) fen += static_cast<char>('0' + empty);
+            empty = 0;
+            fen += square;
+        }
+        if (empty > 0) fen += static_cast<char>('0' + empty);
+        if (rank > 0) fen += '/';
+    }
+    fen += position.strongToMove ? " w - - 0 1" : " b - - 0 1";
+    return fen;
+}
@@ -4,21 +4,31 @@
 
 #include "../include/BoardRenderer.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
 #include "../include/MoveSearcher.h"
+#include "../include/Notation.h"
 #include "SFML/Graphics/Image.hpp"
+#include "SFML/Graphics/RectangleShape.hpp"
 #include "SFML/Graphics/Sprite.hpp"
 #include "SFML/Graphics/Texture.hpp"
 
 
-BoardRenderer::BoardRenderer(std::unique_ptr<GameBoard>& gameboard, PieceColor viewColor, DebugOptions debugOptions) : gameBoard(gameboard), viewColor(viewColor), debugOptions(debugOptions) {
+BoardRenderer::BoardRenderer(PositionPublisher &positionPublisher, PieceColor viewColor, DebugOptions debugOptions)
+    : positionPublisher(positionPublisher), gameBoard(std::make_unique<GameBoard>(positionPublisher.Load().position)), viewColor(viewColor), debugOptions(debugOptions) {
+    if (debugOptions.flags & FrameTimes) frameProfiler = std::make_unique<FrameProfiler>();
     LoadGrid();
     LoadTextures();
     LoadGameBoard();
+    if (debugOptions.flags & (StatsOverlay | FrameTimes)) LoadStatsFont();
 }
 
 void BoardRenderer::LoadGameBoard() {
+    ScopedFrameTimer frameTimer(frameProfiler.get(), FramePhase::LoadGameBoard);
     for (int row = 0; row < GRID_SIZE; row++) {
         for (int col = 0; col < GRID_SIZE; col++) {
             pieceSprites[col][row] = nullptr;
@@ -73,6 +83,7 @@ PieceMoveResult BoardRenderer::TryMoveToPosition(PiecePosition piecePosition) {
 }
 
 void BoardRenderer::OnMouseDown(sf::Mouse::Button button, sf::Vector2i mousePosition) {
+    if (frameProfiler) frameProfiler->MarkInput();
     short col = mousePosition.x / TILE_SIZE;
     short row = mousePosition.y / TILE_SIZE;
     PiecePosition piecePosition {row,col};
@@ -114,6 +125,95 @@ void BoardRenderer::OnMouseRelease(sf::Mouse::Button button, sf::Vector2i mouseP
     }
 }
 
+void BoardRenderer::ApplyMove(const BoardMove &boardMove) {
+    gameBoard->ExecuteMove(boardMove.move, boardMove.from);
+    positionPublisher.Publish(*gameBoard);
+    LoadGameBoard();
+    ClearSelectedPiece();
+    ClearMoveSprites();
+    pieceMoveQuery.moveCount = 0;
+}
+
+void BoardRenderer::LockColor(PieceColor color) {
+    lockedColor = color;
+}
+
+void BoardRenderer::SetAnalysisLines(const std::vector<PvLine> &lines) {
+    analysisArrows.clear();
+    if (lines.empty()) return;
+
+    int bestScore = lines.front().score;
+    // Worst first so the best arrow ends up on top
+    for (auto line = lines.rbegin(); line != lines.rend(); ++line) {
+        if (line->moves.empty()) continue;
+        float weight = std::clamp(1.0f - static_cast<float>(bestScore - line->score) / ARROW_SCORE_RANGE, 0.0f, 1.0f);
+        float width = ARROW_MIN_WIDTH + (ARROW_MAX_WIDTH - ARROW_MIN_WIDTH) * weight;
+        sf::Color color(40, 110, 220, static_cast<std::uint8_t>(90 + 140 * weight));
+        const BoardMove& boardMove = line->moves.front();
+        AppendArrow(analysisArrows, GetSquareCenter(boardMove.from), GetSquareCenter(boardMove.move.position), width, color);
+    }
+}
+
+void BoardRenderer::SetOpeningStats(const GameIndexQuery &query) {
+    openingArrows.clear();
+    openingText.reset();
+    if (query.moves.empty()) return;
+
+    PieceColor sideToMove = gameBoard->GetSideToMove();
+    size_t shownMoves = std::min(query.moves.size(), OPENING_SHOWN_MOVES);
+    float mostGames = static_cast<float>(query.moves.front().score.games);
+    // Least played first so the most played arrow ends up on top
+    for (size_t i = shownMoves; i-- > 0;) {
+        const GameIndexMoveStats& moveStats = query.moves[i];
+        float weight = static_cast<float>(moveStats.score.games) / mostGames;
+        float width = ARROW_MIN_WIDTH + (ARROW_MAX_WIDTH - ARROW_MIN_WIDTH) * weight;
+        auto score = static_cast<float>(moveStats.score.GetScore(sideToMove));
+        sf::Color color(static_cast<std::uint8_t>(220 * (1 - score)), static_cast<std::uint8_t>(190 * score), 60, 200);
+        AppendArrow(openingArrows, GetSquareCenter(moveStats.boardMove.from), GetSquareCenter(moveStats.boardMove.move.position), width, color);
+    }
+
+    LoadStatsFont();
+    if (!statsOverlay.font.has_value()) return;
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(0) << query.total.games << " games";
+    for (size_t i = 0; i < shownMoves; i++) {
+        const GameIndexMoveStats& moveStats = query.moves[i];
+        summary << '\n' << Notation::GetSanName(moveStats.boardMove, gameBoard) << "  " << moveStats.score.games
+                << "  " << moveStats.score.GetScore(sideToMove) * 100 << '%';
+    }
+    openingText.emplace(statsOverlay.font.value(), summary.str(), 12);
+    openingText->setFillColor(sf::Color::White);
+    sf::FloatRect bounds = openingText->getGlobalBounds();
+    openingText->setPosition(sf::Vector2f(6, GRID_SIZE * TILE_SIZE - bounds.position.y - bounds.size.y - 6));
+}
+
+void BoardRenderer::AppendArrow(sf::VertexArray &arrows, sf::Vector2f from, sf::Vector2f to, float width, sf::Color color) {
+    sf::Vector2f delta = to - from;
+    float length = std::hypot(delta.x, delta.y);
+    if (length <= 0) return;
+
+    sf::Vector2f direction(delta.x / length, delta.y / length);
+    sf::Vector2f normal(-direction.y, direction.x);
+    float headLength = std::min(width * 2.5f, length);
+    sf::Vector2f shaftEnd = to - direction * headLength;
+    sf::Vector2f shaftSide = normal * (width / 2);
+    sf::Vector2f headSide = normal * (width * 1.6f);
+
+    const sf::Vector2f points[] = {
+        from + shaftSide, from - shaftSide, shaftEnd + shaftSide,
+        shaftEnd + shaftSide, from - shaftSide, shaftEnd - shaftSide,
+        shaftEnd + headSide, shaftEnd - headSide, to,
+    };
+    for (const sf::Vector2f& point : points) {
+        arrows.append(sf::Vertex{point, color});
+    }
+}
+
+sf::Vector2f BoardRenderer::GetSquareCenter(PiecePosition piecePosition) const {
+    if (viewColor == PieceColor::White) piecePosition.InvertAxis(Axis::Vertical);
+    return {(piecePosition.col + 0.5f) * TILE_SIZE, (piecePosition.row + 0.5f) * TILE_SIZE};
+}
+
 void BoardRenderer::LoadChessIcon(const std::unique_ptr<sf::RenderWindow>& window) {
     sf::Texture iconTexture = LoadTexture("engine_icon");
     sf::Image iconImage = iconTexture.copyToImage();
@@ -122,12 +222,28 @@ void BoardRenderer::LoadChessIcon(const std::unique_ptr<sf::RenderWindow>& windo
 
 
 void BoardRenderer::Render(const std::unique_ptr<sf::RenderWindow>& window) {
+    if (frameProfiler) frameProfiler->BeginFrame();
     RenderGrid(window);
     RenderMovePositions(window);
     RenderPieces(window);
+    if (openingArrows.getVertexCount() > 0) window->draw(openingArrows);
+    if (analysisArrows.getVertexCount() > 0) window->draw(analysisArrows);
+    if (openingText.has_value()) RenderTextPanel(window, openingText.value());
+    if (debugOptions.flags & StatsOverlay) RenderStats(window);
+    if (frameProfiler) RenderFrameTimes(window);
+}
+
+void BoardRenderer::OnFrameDisplayed() {
+    if (frameProfiler) frameProfiler->EndFrame();
+}
+
+bool BoardRenderer::WriteFrameTimes(const std::string &path) const {
+    if (!frameProfiler) return true;
+    return frameProfiler->WriteCsv(path);
 }
 
 void BoardRenderer::RenderGrid(const std::unique_ptr<sf::RenderWindow>& window) {
+    ScopedFrameTimer frameTimer(frameProfiler.get(), FramePhase::Grid);
     sf::Color lightColor(240, 217, 181); // light beige
     sf::Color darkColor(181, 136, 99);   // dark brown
 
@@ -189,6 +305,7 @@ void BoardRenderer::RenderDebug(ColorBitBoardType bitBoardType, sf::Color& debug
 }
 
 void BoardRenderer::RenderPieces(const std::unique_ptr<sf::RenderWindow>& window) {
+    ScopedFrameTimer frameTimer(frameProfiler.get(), FramePhase::Pieces);
     for (int row = 0; row < GRID_SIZE; ++row) {
         for (int col = 0; col < GRID_SIZE; ++col) {
             const std::unique_ptr<sf::Sprite>& sprite = pieceSprites[col][row];
@@ -205,11 +322,111 @@ void BoardRenderer::RenderPieces(const std::unique_ptr<sf::RenderWindow>& window
 }
 
 void BoardRenderer::RenderMovePositions(const std::unique_ptr<sf::RenderWindow> &window) const {
+    ScopedFrameTimer frameTimer(frameProfiler.get(), FramePhase::MovePositions);
     for (const std::unique_ptr<sf::Sprite>& sprite : movePositionSprites) {
         window->draw(*sprite);
     }
 }
 
+void BoardRenderer::RenderStats(const std::unique_ptr<sf::RenderWindow> &window) {
+    auto now = std::chrono::steady_clock::now();
+    if (now - statsOverlay.lastRefresh >= STATS_REFRESH_INTERVAL) {
+        StatsSnapshot snapshot = Stats::Snapshot();
+        std::string summary = Stats::IsEnabled() ? GetStatsSummary(snapshot, statsOverlay.lastSnapshot) : "stats compiled out, rebuild with CHESSENGINE_STATS";
+        statsOverlay.lastSnapshot = snapshot;
+        statsOverlay.lastRefresh = now;
+
+        if (statsOverlay.text.has_value()) {
+            statsOverlay.text->setString(summary);
+        } else {
+            // Without a font the title bar is the overlay
+            std::replace(summary.begin(), summary.end(), '\n', ' ');
+            window->setTitle("Chess Engine | " + summary);
+        }
+    }
+    if (statsOverlay.text.has_value()) RenderTextPanel(window, statsOverlay.text.value());
+}
+
+void BoardRenderer::RenderFrameTimes(const std::unique_ptr<sf::RenderWindow> &window) {
+    // Without a font only the CSV written on exit has the times
+    if (!frameTimesText.has_value()) return;
+    auto now = std::chrono::steady_clock::now();
+    if (now - frameTimesRefresh >= STATS_REFRESH_INTERVAL) {
+        frameTimesRefresh = now;
+        frameTimesText->setString(frameProfiler->GetOverlaySummary());
+        sf::FloatRect bounds = frameTimesText->getGlobalBounds();
+        frameTimesText->setPosition(sf::Vector2f(GRID_SIZE * TILE_SIZE - bounds.size.x - 6, 6));
+    }
+    RenderTextPanel(window, frameTimesText.value());
+}
+
+void BoardRenderer::RenderTextPanel(const std::unique_ptr<sf::RenderWindow> &window, const sf::Text &text) {
+    sf::FloatRect bounds = text.getGlobalBounds();
+    sf::RectangleShape background(sf::Vector2f(bounds.size.x + 8, bounds.size.y + 8));
+    background.setPosition(sf::Vector2f(bounds.position.x - 4, bounds.position.y - 4));
+    background.setFillColor(sf::Color(0, 0, 0, 160));
+    window->draw(background);
+    window->draw(text);
+}
+
+void BoardRenderer::LoadStatsFont() {
+    if (statsOverlay.fontSearched) return;
+    statsOverlay.fontSearched = true;
+    // No font ships with the assets, so fall back to common system fonts
+    const char* fontPaths[] = {
+        "../assets/stats_font.ttf",
+        "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf",
+        "/usr/share/fonts/TTF/DejaVuSansMono.ttf",
+        "/System/Library/Fonts/Menlo.ttc",
+        "C:/Windows/Fonts/consola.ttf"
+    };
+    for (const char* fontPath : fontPaths) {
+        sf::Font font;
+        if (!font.openFromFile(fontPath)) continue;
+        statsOverlay.font = std::move(font);
+        if (debugOptions.flags & StatsOverlay) {
+            statsOverlay.text.emplace(statsOverlay.font.value(), "", 12);
+            statsOverlay.text->setFillColor(sf::Color::White);
+            statsOverlay.text->setPosition(sf::Vector2f(6, 6));
+        }
+        if (debugOptions.flags & FrameTimes) {
+            frameTimesText.emplace(statsOverlay.font.value(), "", 12);
+            frameTimesText->setFillColor(sf::Color::White);
+        }
+        return;
+    }
+    std::cerr << "No font found for the overlays, using the window title and arrows\n";
+}
+
+std::string BoardRenderer::GetStatsSummary(const StatsSnapshot &snapshot, const StatsSnapshot &lastSnapshot) {
+    double seconds = std::max(snapshot.seconds - lastSnapshot.seconds, 1e-9);
+    auto getRate = [&](StatCounter counter) {
+        int index = static_cast<int>(counter);
+        return static_cast<uint64_t>((snapshot.counters[index] - lastSnapshot.counters[index]) / seconds);
+    };
+    auto getNanosecondsPerCall = [&](StatTimer timer) {
+        int index = static_cast<int>(timer);
+        uint64_t calls = snapshot.timerCalls[index] - lastSnapshot.timerCalls[index];
+        if (calls == 0) return 0.0;
+        return (snapshot.timerTicks[index] - lastSnapshot.timerTicks[index]) / snapshot.ticksPerSecond * 1e9 / calls;
+    };
+
+    uint64_t generatedMoves = 0;
+    for (int i = static_cast<int>(StatCounter::KingMoves); i <= static_cast<int>(StatCounter::PawnMoves); i++) {
+        generatedMoves += getRate(static_cast<StatCounter>(i));
+    }
+
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(0)
+            << "nodes/s " << getRate(StatCounter::Nodes) << "  qnodes/s " << getRate(StatCounter::QuiescenceNodes)
+            << "  cutoffs/s " << getRate(StatCounter::BetaCutoffs) << '\n'
+            << "moves/s " << generatedMoves << "  executes/s " << getRate(StatCounter::ExecuteMoves)
+            << "  bitboards/s " << getRate(StatCounter::BitBoardRecomputes) << '\n'
+            << "movegen " << getNanosecondsPerCall(StatTimer::MoveGeneration) << " ns  eval "
+            << getNanosecondsPerCall(StatTimer::Evaluation) << " ns";
+    return summary.str();
+}
+
 void BoardRenderer::LoadTextures() {
     PieceTextureLoadData textureData[] = {
         {PieceType::King, PieceColor::White, "white_king"},
@@ -245,6 +462,7 @@ void BoardRenderer::SelectSquare(PiecePosition piecePosition) {
 
     const Piece& piece = gameBoard->GetPiece(piecePosition);
     if ((debugOptions.flags & FreeMove) == 0 && piece.color == gameBoard->GetLastMove().piece.color) return;
+    if (lockedColor == piece.color && piece.type != PieceType::None) return;
 
     if (selectedPiecePosition == piecePosition) {
         selectedPieceFollowState = DoubleClick;
@@ -283,7 +501,8 @@ sf::Texture BoardRenderer::LoadTexture(const std::string &spriteName) {
 }
 
 void BoardRenderer::LoadMoveSprites(PiecePosition position) {
-    MoveSearcher::GetValidMoves(position, pieceMoveQuery, gameBoard);
+    ScopedFrameTimer frameTimer(frameProfiler.get(), FramePhase::LoadMoveSprites);
+    MoveSearcher::GetValidMoves(position, pieceMoveQuery, *gameBoard);
 
     ClearMoveSprites();
     movePositionSprites.reserve(pieceMoveQuery.moveCount);
@@ -328,6 +547,7 @@ void BoardRenderer::MoveSelectedPiece(const PieceMove &move) {
     if (!selectedPiecePosition.has_value()) return;
 
     gameBoard->ExecuteMove(move, selectedPiecePosition.value());
+    positionPublisher.Publish(*gameBoard);
     LoadGameBoard();
     ClearSelectedPiece();
     ClearMoveSprites();
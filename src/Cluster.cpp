@@ -0,0 +1,796 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/Cluster.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../include/ArgParse.h"
+#include "../include/Notation.h"
+
+namespace {
+    constexpr uint64_t WAKE_TAG = UINT64_MAX;
+    constexpr int MAX_EPOLL_EVENTS = 64;
+    constexpr size_t READ_CHUNK_SIZE = 1 << 16;
+
+    std::optional<BoardMove> ParseMove(const std::string &text, const Position &position) {
+        BoardMoveQuery moveQuery;
+        MoveSearcher::GetLegalMoves(moveQuery, position);
+        for (int i = 0; i < moveQuery.moveCount; i++) {
+            if (Notation::GetMoveName(moveQuery.moves[i]) == text) return moveQuery.moves[i];
+        }
+        return std::nullopt;
+    }
+
+    bool IsMateRange(int score) {
+        int magnitude = std::abs(score);
+        return magnitude >= MATE_SCORE - MAX_SEARCH_PLY && magnitude < INFINITE_SCORE;
+    }
+
+    // A subtree score seen from its parent, a mate there is one ply further from the parent
+    int FromChildScore(int score) {
+        if (!IsMateRange(score)) return -score;
+        return score > 0 ? -score + 1 : -score - 1;
+    }
+
+    // The inverse, for passing a window down
+    int ToChildScore(int score) {
+        if (!IsMateRange(score)) return -score;
+        return score > 0 ? -score - 1 : -score + 1;
+    }
+
+    void AppendEntries(std::string &text, const std::vector<TTEntry> &entries) {
+        for (size_t start = 0; start < entries.size(); start += CLUSTER_ENTRIES_PER_MESSAGE) {
+            std::ostringstream message;
+            message << "tt";
+            size_t end = std::min(entries.size(), start + CLUSTER_ENTRIES_PER_MESSAGE);
+            for (size_t i = start; i < end; i++) {
+                const TTEntry& entry = entries[i];
+                message << ' ' << std::hex << entry.key << std::dec << ' ' << entry.move << ' ' << entry.score << ' ' << static_cast<int>(entry.depth)
+                        << ' ' << static_cast<int>(entry.bound);
+            }
+            message << '\n';
+            text += message.str();
+        }
+    }
+
+    std::vector<TTEntry> ParseEntries(std::istringstream &arguments) {
+        std::vector<TTEntry> entries;
+        uint64_t key;
+        int move;
+        int score;
+        int depth;
+        int bound;
+        while (arguments >> std::hex >> key >> std::dec >> move >> score >> depth >> bound) {
+            if (bound < static_cast<int>(TTBound::Upper) || bound > static_cast<int>(TTBound::Exact)) continue;
+            entries.push_back(TTEntry{key, static_cast<uint16_t>(move), static_cast<int16_t>(score), static_cast<int8_t>(depth), static_cast<TTBound>(bound)});
+        }
+        return entries;
+    }
+
+    ClusterItemResult SearchItem(Searcher &searcher, const std::unique_ptr<GameBoard> &gameBoard, const ClusterItem &item, const std::atomic<bool> *stopSignal) {
+        *gameBoard = item.position;
+        SearchLimits limits;
+        limits.depth = item.depth;
+        limits.alpha = item.alpha;
+        limits.beta = item.beta;
+        limits.stopSignal = stopSignal;
+        SearchResult result = searcher.Search(gameBoard, limits);
+        // The searcher has no move to report at a mate or stalemate, and no score either
+        if (!result.bestMove.has_value()) {
+            result.score = MoveSearcher::IsInCheck(gameBoard->GetSideToMove(), *gameBoard) ? -MATE_SCORE : 0;
+        }
+        return ClusterItemResult{result.score, result.nodes};
+    }
+
+    int ConnectTo(const std::string &address) {
+        size_t separator = address.rfind(':');
+        if (separator == std::string::npos) return -1;
+        std::string host = address.substr(0, separator);
+        std::string port = address.substr(separator + 1);
+
+        addrinfo hints {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0) return -1;
+        int fileDescriptor = -1;
+        for (addrinfo* candidate = addresses; candidate != nullptr; candidate = candidate->ai_next) {
+            fileDescriptor = socket(candidate->ai_family, candidate->ai_socktype | SOCK_CLOEXEC, candidate->ai_protocol);
+            if (fileDescriptor < 0) continue;
+            if (connect(fileDescriptor, candidate->ai_addr, candidate->ai_addrlen) == 0) break;
+            close(fileDescriptor);
+            fileDescriptor = -1;
+        }
+        freeaddrinfo(addresses);
+        return fileDescriptor;
+    }
+
+    void PrepareSocket(int fileDescriptor) {
+        int enable = 1;
+        setsockopt(fileDescriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        setsockopt(fileDescriptor, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+        int flags = fcntl(fileDescriptor, F_GETFL, 0);
+        fcntl(fileDescriptor, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+bool ClusterOptions::ParseArgs(int argc, char **argv) {
+    // argv[1] is the command and argv[2] the mode, the FEN is the one argument without a flag
+    if (argc > 2) mode = argv[2];
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--port" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], port)) return false;
+        } else if (arg == "--bind" && hasValue) {
+            bindAddress = argv[++i];
+        } else if (arg == "--peers" && hasValue) {
+            std::istringstream list(argv[++i]);
+            std::string peer;
+            while (std::getline(list, peer, ',')) {
+                if (!peer.empty()) peers.push_back(peer);
+            }
+        } else if (arg == "--depth" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], depth)) return false;
+        } else if (arg == "--hash" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], hashMb)) return false;
+        } else if (arg == "--compare") {
+            compare = true;
+        } else if (!arg.starts_with("--")) {
+            fen = arg;
+        }
+    }
+    return true;
+}
+
+bool ClusterConnection::ReadAvailable() {
+    char chunk[READ_CHUNK_SIZE];
+    while (true) {
+        ssize_t count = read(fileDescriptor, chunk, sizeof(chunk));
+        if (count > 0) {
+            readBuffer.append(chunk, count);
+            continue;
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (count < 0 && errno == EINTR) continue;
+        return false;
+    }
+    return readBuffer.size() <= CLUSTER_MAX_LINE_LENGTH || readBuffer.find('\n') != std::string::npos;
+}
+
+bool ClusterConnection::Flush() {
+    size_t written = 0;
+    while (written < writeBuffer.size()) {
+        ssize_t count = write(fileDescriptor, writeBuffer.data() + written, writeBuffer.size() - written);
+        if (count > 0) {
+            written += count;
+            continue;
+        }
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        return false;
+    }
+    writeBuffer.erase(0, written);
+    return true;
+}
+
+bool ClusterConnection::TakeLine(std::string &line) {
+    size_t end = readBuffer.find('\n');
+    if (end == std::string::npos) return false;
+    line = readBuffer.substr(0, end);
+    readBuffer.erase(0, end + 1);
+    return true;
+}
+
+void ClusterConnection::Close() {
+    if (fileDescriptor >= 0) close(fileDescriptor);
+    fileDescriptor = -1;
+    readBuffer.clear();
+    writeBuffer.clear();
+}
+
+ClusterWorker::ClusterWorker(ClusterOptions options) : options(std::move(options)) {
+    searcher.SetHashSize(this->options.hashMb);
+    searcher.SetSharedEntries(&sharedEntries);
+    rootBoard->LoadDefaultBoard();
+}
+
+int ClusterWorker::Run() {
+    signal(SIGPIPE, SIG_IGN);
+    int listenDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int enable = 1;
+    setsockopt(listenDescriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(options.port));
+    if (inet_pton(AF_INET, options.bindAddress.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Invalid bind address: " << options.bindAddress << '\n';
+        close(listenDescriptor);
+        return 1;
+    }
+    if (listenDescriptor < 0 || bind(listenDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || listen(listenDescriptor, 1) != 0) {
+        std::cerr << "Failed to listen on " << options.bindAddress << ':' << options.port << ": " << std::strerror(errno) << '\n';
+        if (listenDescriptor >= 0) close(listenDescriptor);
+        return 1;
+    }
+    wakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    std::cerr << "Cluster worker listening on " << options.bindAddress << ':' << options.port << '\n';
+
+    std::thread searchThread(&ClusterWorker::RunSearches, this);
+    while (true) {
+        int fileDescriptor = accept4(listenDescriptor, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fileDescriptor < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "accept failed: " << std::strerror(errno) << '\n';
+            break;
+        }
+        PrepareSocket(fileDescriptor);
+        ClusterConnection connection;
+        connection.fileDescriptor = fileDescriptor;
+        Serve(connection);
+        connection.Close();
+    }
+
+    StopSearches();
+    searchThread.join();
+    close(wakeDescriptor);
+    close(listenDescriptor);
+    return 1;
+}
+
+void ClusterWorker::Serve(ClusterConnection &connection) {
+    std::cerr << "Coordinator connected\n";
+    pollfd descriptors[2] = {{connection.fileDescriptor, POLLIN, 0}, {wakeDescriptor, POLLIN, 0}};
+    bool connected = true;
+    while (connected) {
+        descriptors[0].events = POLLIN | (connection.writeBuffer.empty() ? 0 : POLLOUT);
+        if (poll(descriptors, 2, static_cast<int>(CLUSTER_SHARE_INTERVAL.count())) < 0 && errno != EINTR) break;
+        if (descriptors[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            connected = connection.ReadAvailable();
+            std::string line;
+            while (connected && connection.TakeLine(line)) {
+                if (line == "quit") connected = false;
+                HandleLine(connection, line);
+            }
+        }
+        if (descriptors[1].revents & POLLIN) {
+            uint64_t count;
+            while (read(wakeDescriptor, &count, sizeof(count)) > 0) {}
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            for (const std::string& reply : replies) {
+                connection.writeBuffer += reply;
+            }
+            replies.clear();
+        }
+        AppendEntries(connection.writeBuffer, sharedEntries.TakePublished());
+        if (!connection.Flush()) connected = false;
+    }
+
+    // Whatever the coordinator left behind is of no use to the next one
+    std::lock_guard lock(mutex);
+    items.clear();
+    replies.clear();
+    if (runningId.has_value()) stopItem = true;
+    std::cerr << "Coordinator disconnected\n";
+}
+
+void ClusterWorker::HandleLine(ClusterConnection &connection, const std::string &line) {
+    std::istringstream arguments(line);
+    std::string command;
+    arguments >> command;
+
+    if (command == "position") {
+        std::string fen;
+        std::getline(arguments >> std::ws, fen);
+        std::lock_guard lock(mutex);
+        if (fen == "startpos") {
+            rootBoard->LoadDefaultBoard();
+        } else if (!rootBoard->LoadFen(fen)) {
+            connection.writeBuffer += "error invalid fen\n";
+        }
+    } else if (command == "job") {
+        ClusterItem item;
+        arguments >> item.id >> item.depth >> item.alpha >> item.beta;
+        std::lock_guard lock(mutex);
+        item.position = *rootBoard;
+        std::string moveText;
+        while (arguments >> moveText) {
+            std::optional<BoardMove> boardMove = ParseMove(moveText, item.position);
+            if (!boardMove.has_value()) {
+                connection.writeBuffer += "error illegal move " + moveText + "\n";
+                return;
+            }
+            item.position.ExecuteMove(boardMove->move, boardMove->from);
+            item.line.push_back(boardMove.value());
+        }
+        items.push_back(std::move(item));
+        itemReady.notify_one();
+    } else if (command == "stop") {
+        uint64_t id = 0;
+        arguments >> id;
+        std::lock_guard lock(mutex);
+        std::erase_if(items, [id](const ClusterItem &item) { return item.id == id; });
+        if (runningId == id) stopItem = true;
+    } else if (command == "tt") {
+        sharedEntries.Receive(ParseEntries(arguments));
+    }
+}
+
+void ClusterWorker::RunSearches() {
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    while (true) {
+        ClusterItem item;
+        {
+            std::unique_lock lock(mutex);
+            itemReady.wait(lock, [this] { return stopping || !items.empty(); });
+            if (stopping) return;
+            item = std::move(items.front());
+            items.pop_front();
+            runningId = item.id;
+            stopItem = false;
+        }
+
+        ClusterItemResult result = SearchItem(searcher, gameBoard, item, &stopItem);
+        {
+            std::lock_guard lock(mutex);
+            runningId = std::nullopt;
+            replies.push_back("result " + std::to_string(item.id) + " " + std::to_string(result.score) + " " + std::to_string(result.nodes) + "\n");
+        }
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = write(wakeDescriptor, &one, sizeof(one));
+    }
+}
+
+void ClusterWorker::StopSearches() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+        stopItem = true;
+    }
+    itemReady.notify_all();
+}
+
+ClusterCoordinator::ClusterCoordinator(ClusterOptions options) : options(std::move(options)) {
+    this->options.depth = std::clamp(this->options.depth, 2, MAX_SEARCH_PLY - 1);
+}
+
+ClusterCoordinator::~ClusterCoordinator() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+        stopLocalItem = true;
+    }
+    itemReady.notify_all();
+    if (wakeDescriptor >= 0) Wake();
+    if (networkThread.joinable()) networkThread.join();
+    if (localThread.joinable()) localThread.join();
+    for (ClusterPeer& peer : peers) {
+        if (peer.alive) {
+            peer.connection.writeBuffer += "quit\n";
+            peer.connection.Flush();
+        }
+        peer.connection.Close();
+    }
+    if (wakeDescriptor >= 0) close(wakeDescriptor);
+}
+
+int ClusterCoordinator::Run() {
+    if (!options.fen.empty() && !rootBoard->LoadFen(options.fen)) {
+        std::cerr << "Invalid FEN: " << options.fen << '\n';
+        return 1;
+    }
+    if (options.fen.empty()) rootBoard->LoadDefaultBoard();
+    signal(SIGPIPE, SIG_IGN);
+
+    BoardMoveQuery moveQuery;
+    MoveSearcher::GetLegalMoves(moveQuery, *rootBoard);
+    if (moveQuery.moveCount == 0) {
+        std::cout << "bestmove none\n";
+        return 0;
+    }
+    rootOrder.assign(moveQuery.moves.begin(), moveQuery.moves.begin() + moveQuery.moveCount);
+
+    wakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ConnectPeers();
+    queues.resize(peers.size() + 1);
+    networkThread = std::thread(&ClusterCoordinator::RunNetwork, this);
+    localThread = std::thread(&ClusterCoordinator::RunLocalSearches, this);
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto elapsedMs = [&startTime] {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    };
+    int score = 0;
+    for (int depth = 2; depth <= options.depth; depth++) {
+        std::vector<BoardMove> line;
+        score = SearchNode(*rootBoard, line, depth, -INFINITE_SCORE, INFINITE_SCORE, CLUSTER_SPLIT_PLIES);
+        // Siblings only proved they are no better, their bounds still order them for the next iteration
+        std::ranges::stable_sort(rootOrder, [this](const BoardMove &first, const BoardMove &second) {
+            return rootScores[TranspositionTable::PackMove(first)] > rootScores[TranspositionTable::PackMove(second)];
+        });
+
+        std::lock_guard lock(mutex);
+        std::cout << "info depth " << depth << " score " << score << " nodes " << totalNodes << " time_ms " << elapsedMs()
+                  << " best " << Notation::GetMoveName(bestMove.value()) << std::endl;
+    }
+    int64_t timeMs = elapsedMs();
+
+    size_t alivePeers;
+    uint64_t nodes;
+    {
+        std::lock_guard lock(mutex);
+        alivePeers = std::ranges::count_if(peers, [](const ClusterPeer &peer) { return peer.alive; });
+        nodes = totalNodes;
+        std::cout << "node local items " << localItemsSearched << '\n';
+        for (const ClusterPeer& peer : peers) {
+            std::cout << "node " << peer.address << " items " << peer.itemsSearched << (peer.alive ? "" : " lost") << '\n';
+        }
+        std::cout << "stolen " << stolenItems << '\n';
+    }
+    std::cout << "bestmove " << Notation::GetMoveName(bestMove.value()) << " score " << score << " depth " << options.depth
+              << " nodes " << nodes << " time_ms " << timeMs << " nps " << nodes * 1000 / std::max<int64_t>(timeMs, 1)
+              << " peers " << alivePeers << '/' << peers.size() << std::endl;
+
+    if (options.compare) {
+        Searcher searcher;
+        searcher.SetHashSize(options.hashMb);
+        SearchLimits limits;
+        limits.depth = options.depth;
+        SearchResult result = searcher.Search(rootBoard, limits);
+        double speedup = static_cast<double>(result.timeMs) / std::max<int64_t>(timeMs, 1);
+        std::cout << "single bestmove " << Notation::GetMoveName(result.bestMove.value()) << " score " << result.score
+                  << " nodes " << result.nodes << " time_ms " << result.timeMs << " speedup " << speedup << '\n';
+    }
+    return 0;
+}
+
+void ClusterCoordinator::ConnectPeers() {
+    std::string position = options.fen.empty() ? "startpos" : options.fen;
+    for (const std::string& address : options.peers) {
+        ClusterPeer& peer = peers.emplace_back();
+        peer.address = address;
+        peer.connection.fileDescriptor = ConnectTo(address);
+        if (peer.connection.fileDescriptor < 0) {
+            std::cerr << "Could not reach " << address << ", searching without it\n";
+            continue;
+        }
+        PrepareSocket(peer.connection.fileDescriptor);
+        peer.alive = true;
+        peer.connection.writeBuffer += "position " + position + "\n";
+    }
+}
+
+int ClusterCoordinator::SearchNode(const Position &position, std::vector<BoardMove> &line, int depth, int alpha, int beta, int splitPlies) {
+    bool root = line.empty();
+    std::vector<BoardMove> moves = rootOrder;
+    if (!root) {
+        BoardMoveQuery moveQuery;
+        MoveSearcher::GetLegalMoves(moveQuery, position);
+        if (moveQuery.moveCount == 0) {
+            return MoveSearcher::IsInCheck(position.GetSideToMove(), position) ? -MATE_SCORE + static_cast<int>(line.size()) : 0;
+        }
+        moves.assign(moveQuery.moves.begin(), moveQuery.moves.begin() + moveQuery.moveCount);
+    }
+
+    auto recordScore = [&](const BoardMove &boardMove, int score) {
+        if (root) rootScores[TranspositionTable::PackMove(boardMove)] = score;
+    };
+
+    // The first move is searched alone, its score is the bound the siblings have to beat
+    int bestScore;
+    const BoardMove& firstMove = moves.front();
+    if (splitPlies > 1 && depth - 1 >= 2) {
+        Position nextPosition = position;
+        nextPosition.ExecuteMove(firstMove.move, firstMove.from);
+        line.push_back(firstMove);
+        bestScore = FromChildScore(SearchNode(nextPosition, line, depth - 1, ToChildScore(beta), ToChildScore(alpha), splitPlies - 1));
+        line.pop_back();
+    } else {
+        std::vector<uint64_t> ids = Submit({MakeItem(position, line, firstMove, depth, alpha, beta)});
+        bestScore = FromChildScore(WaitForAny({ids.front()}).second.score);
+    }
+    recordScore(firstMove, bestScore);
+    if (root) bestMove = firstMove;
+    if (bestScore > alpha) alpha = bestScore;
+    if (alpha >= beta || moves.size() == 1) return bestScore;
+
+    // Siblings only have to show they are no better, which a null window does cheaply
+    std::vector<ClusterItem> siblings;
+    for (size_t i = 1; i < moves.size(); i++) {
+        siblings.push_back(MakeItem(position, line, moves[i], depth, alpha, alpha + 1));
+    }
+    std::vector<uint64_t> siblingIds = Submit(std::move(siblings));
+    std::unordered_map<uint64_t, size_t> moveIndex;
+    std::unordered_map<uint64_t, int> testedAlpha;
+    std::unordered_set<uint64_t> waiting;
+    for (size_t i = 0; i < siblingIds.size(); i++) {
+        moveIndex[siblingIds[i]] = i + 1;
+        testedAlpha[siblingIds[i]] = alpha;
+        waiting.insert(siblingIds[i]);
+    }
+    std::unordered_set<uint64_t> researches;
+
+    while (!waiting.empty()) {
+        auto [id, result] = WaitForAny(waiting);
+        waiting.erase(id);
+        const BoardMove& boardMove = moves[moveIndex[id]];
+        int score = FromChildScore(result.score);
+
+        if (!researches.contains(id) && score > testedAlpha[id] && score < beta) {
+            // Only a lower bound, even when alpha has since passed it, a full window gives the score
+            std::vector<uint64_t> ids = Submit({MakeItem(position, line, boardMove, depth, alpha, beta)});
+            moveIndex[ids.front()] = moveIndex[id];
+            waiting.insert(ids.front());
+            researches.insert(ids.front());
+            continue;
+        }
+        recordScore(boardMove, score);
+        if (score > bestScore) {
+            bestScore = score;
+            if (root) bestMove = boardMove;
+        }
+        if (score > alpha) alpha = score;
+        if (alpha >= beta) {
+            Cancel(waiting);
+            break;
+        }
+    }
+    return bestScore;
+}
+
+ClusterItem ClusterCoordinator::MakeItem(const Position &position, std::vector<BoardMove> &line, const BoardMove &boardMove, int depth, int alpha, int beta) {
+    ClusterItem item;
+    item.position = position;
+    item.position.ExecuteMove(boardMove.move, boardMove.from);
+    item.line = line;
+    item.line.push_back(boardMove);
+    item.depth = depth - 1;
+    item.alpha = ToChildScore(beta);
+    item.beta = ToChildScore(alpha);
+    return item;
+}
+
+std::vector<uint64_t> ClusterCoordinator::Submit(std::vector<ClusterItem> newItems) {
+    std::vector<uint64_t> ids;
+    {
+        std::lock_guard lock(mutex);
+        for (ClusterItem& item : newItems) {
+            item.id = nextItemId++;
+            ids.push_back(item.id);
+            activeIds.insert(item.id);
+            // Round robin over the nodes still connected, this one is always among them
+            size_t node;
+            do {
+                node = nextQueue++ % queues.size();
+            } while (node != 0 && !peers[node - 1].alive);
+            queues[node].push_back(std::move(item));
+        }
+    }
+    itemReady.notify_all();
+    Wake();
+    return ids;
+}
+
+std::pair<uint64_t, ClusterItemResult> ClusterCoordinator::WaitForAny(const std::unordered_set<uint64_t> &ids) {
+    std::unique_lock lock(mutex);
+    std::unordered_map<uint64_t, ClusterItemResult>::iterator found;
+    resultReady.wait(lock, [&] {
+        found = std::ranges::find_if(results, [&ids](const auto &entry) { return ids.contains(entry.first); });
+        return found != results.end();
+    });
+    std::pair<uint64_t, ClusterItemResult> result = *found;
+    results.erase(found);
+    return result;
+}
+
+void ClusterCoordinator::Cancel(const std::unordered_set<uint64_t> &ids) {
+    {
+        std::lock_guard lock(mutex);
+        for (uint64_t id : ids) {
+            activeIds.erase(id);
+            results.erase(id);
+        }
+        for (std::deque<ClusterItem>& queue : queues) {
+            std::erase_if(queue, [&ids](const ClusterItem &item) { return ids.contains(item.id); });
+        }
+        for (size_t i = 0; i < peers.size(); i++) {
+            if (peers[i].running.has_value() && ids.contains(peers[i].running->id)) pendingStops.emplace_back(i, peers[i].running->id);
+        }
+        if (localRunningId.has_value() && ids.contains(localRunningId.value())) stopLocalItem = true;
+    }
+    Wake();
+}
+
+std::optional<ClusterItem> ClusterCoordinator::TakeItem(size_t node) {
+    if (!queues[node].empty()) {
+        ClusterItem item = std::move(queues[node].front());
+        queues[node].pop_front();
+        return item;
+    }
+    // Stealing from the back takes the sibling its owner would have reached last
+    auto longest = std::ranges::max_element(queues, {}, &std::deque<ClusterItem>::size);
+    if (longest->empty()) return std::nullopt;
+    ClusterItem item = std::move(longest->back());
+    longest->pop_back();
+    stolenItems++;
+    return item;
+}
+
+void ClusterCoordinator::Complete(uint64_t id, ClusterItemResult result) {
+    totalNodes += result.nodes;
+    // Cancelled items still report, their scores belong to a window nobody waits on anymore
+    if (activeIds.erase(id) == 0) return;
+    results[id] = result;
+    resultReady.notify_all();
+}
+
+void ClusterCoordinator::RunNetwork() {
+    int epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_TAG;
+    epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, wakeDescriptor, &event);
+    {
+        std::lock_guard lock(mutex);
+        for (size_t i = 0; i < peers.size(); i++) {
+            if (!peers[i].alive) continue;
+            event.data.u64 = i;
+            epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, peers[i].connection.fileDescriptor, &event);
+        }
+    }
+
+    // Writes are retried every share interval rather than watched, the messages are small next to the socket buffers
+    std::array<epoll_event, MAX_EPOLL_EVENTS> events;
+    while (true) {
+        int eventCount = epoll_wait(epollDescriptor, events.data(), MAX_EPOLL_EVENTS, static_cast<int>(CLUSTER_SHARE_INTERVAL.count()));
+        std::lock_guard lock(mutex);
+        if (stopping) break;
+        for (int i = 0; i < eventCount; i++) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == WAKE_TAG) {
+                uint64_t count;
+                while (read(wakeDescriptor, &count, sizeof(count)) > 0) {}
+                continue;
+            }
+            ClusterPeer& peer = peers[tag];
+            if (!peer.alive) continue;
+            if (!peer.connection.ReadAvailable()) {
+                DropPeer(tag);
+                continue;
+            }
+            std::string line;
+            while (peer.alive && peer.connection.TakeLine(line)) {
+                HandlePeerLine(tag, line);
+            }
+        }
+
+        for (auto [peer, id] : pendingStops) {
+            if (peers[peer].alive) peers[peer].connection.writeBuffer += "stop " + std::to_string(id) + "\n";
+        }
+        pendingStops.clear();
+        AssignPeerItems();
+
+        std::string entries;
+        AppendEntries(entries, sharedEntries.TakePublished());
+        for (size_t i = 0; i < peers.size(); i++) {
+            if (!peers[i].alive) continue;
+            peers[i].connection.writeBuffer += entries;
+            if (!peers[i].connection.Flush()) DropPeer(i);
+        }
+    }
+    close(epollDescriptor);
+}
+
+void ClusterCoordinator::RunLocalSearches() {
+    Searcher searcher;
+    searcher.SetHashSize(options.hashMb);
+    searcher.SetSharedEntries(&sharedEntries);
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    while (true) {
+        std::optional<ClusterItem> item;
+        {
+            std::unique_lock lock(mutex);
+            itemReady.wait(lock, [this, &item] {
+                if (stopping) return true;
+                item = TakeItem(0);
+                return item.has_value();
+            });
+            if (stopping) return;
+            localRunningId = item->id;
+            stopLocalItem = false;
+        }
+
+        ClusterItemResult result = SearchItem(searcher, gameBoard, item.value(), &stopLocalItem);
+
+        std::lock_guard lock(mutex);
+        localRunningId = std::nullopt;
+        localItemsSearched++;
+        Complete(item->id, result);
+    }
+}
+
+void ClusterCoordinator::AssignPeerItems() {
+    for (size_t i = 0; i < peers.size(); i++) {
+        ClusterPeer& peer = peers[i];
+        if (!peer.alive || peer.running.has_value()) continue;
+        std::optional<ClusterItem> item = TakeItem(i + 1);
+        if (!item.has_value()) return;
+
+        std::string message = "job " + std::to_string(item->id) + " " + std::to_string(item->depth) + " "
+                              + std::to_string(item->alpha) + " " + std::to_string(item->beta);
+        for (const BoardMove& boardMove : item->line) {
+            message += " " + Notation::GetMoveName(boardMove);
+        }
+        peer.connection.writeBuffer += message + "\n";
+        peer.running = std::move(item);
+    }
+}
+
+void ClusterCoordinator::HandlePeerLine(size_t peer, const std::string &line) {
+    std::istringstream arguments(line);
+    std::string command;
+    arguments >> command;
+
+    if (command == "result") {
+        uint64_t id = 0;
+        ClusterItemResult result;
+        arguments >> id >> result.score >> result.nodes;
+        if (!peers[peer].running.has_value() || peers[peer].running->id != id) return;
+        peers[peer].running = std::nullopt;
+        peers[peer].itemsSearched++;
+        Complete(id, result);
+        AssignPeerItems();
+    } else if (command == "tt") {
+        sharedEntries.Receive(ParseEntries(arguments));
+        // Peers only talk to the coordinator, so it passes entries on to the others
+        for (size_t i = 0; i < peers.size(); i++) {
+            if (i != peer && peers[i].alive) peers[i].connection.writeBuffer += line + "\n";
+        }
+    } else if (command == "error") {
+        std::cerr << "Peer " << peers[peer].address << " failed: " << line << '\n';
+        DropPeer(peer);
+    }
+}
+
+void ClusterCoordinator::DropPeer(size_t peer) {
+    ClusterPeer& lostPeer = peers[peer];
+    std::cerr << "Lost peer " << lostPeer.address << ", its items move to the other nodes\n";
+    lostPeer.alive = false;
+    lostPeer.connection.Close();
+    if (lostPeer.running.has_value()) {
+        if (activeIds.contains(lostPeer.running->id)) queues[0].push_front(std::move(lostPeer.running.value()));
+        lostPeer.running = std::nullopt;
+    }
+    std::deque<ClusterItem>& lostQueue = queues[peer + 1];
+    queues[0].insert(queues[0].end(), std::make_move_iterator(lostQueue.begin()), std::make_move_iterator(lostQueue.end()));
+    lostQueue.clear();
+    itemReady.notify_all();
+}
+
+void ClusterCoordinator::Wake() const {
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t written = write(wakeDescriptor, &one, sizeof(one));
+}
@@ -0,0 +1,109 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/EngineOpponent.h"
+
+#include <iostream>
+#include <string>
+
+#include "../include/ArgParse.h"
+
+bool EngineOpponentOptions::ParseArgs(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--engine" && hasValue) {
+            std::string side = argv[++i];
+            if (side == "white") {
+                color = PieceColor::White;
+            } else if (side == "black") {
+                color = PieceColor::Black;
+            } else {
+                std::cerr << "Ignoring invalid engine side: " << side << '\n';
+            }
+        } else if (arg == "--tc" && hasValue) {
+            TimeControl parsed = timeControl;
+            // Without a clock the engine would search to the depth cap, so the GUI insists on one
+            if (!parsed.Parse(argv[++i]) || !parsed.IsEnabled()) {
+                std::cerr << "Ignoring invalid time control: " << argv[i] << '\n';
+            } else {
+                timeControl = parsed;
+            }
+        } else if (arg == "--book" && hasValue) {
+            bookPath = argv[++i];
+        } else if (arg == "--book-keys" && hasValue) {
+            bookKeysPath = argv[++i];
+        } else if (arg == "--move-overhead" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], timeControl.moveOverheadMs)) return false;
+        }
+    }
+    return true;
+}
+
+EngineOpponent::EngineOpponent(EngineOpponentOptions options) : options(std::move(options)), searchBoard(std::make_unique<GameBoard>()) {
+    remainingMs = this->options.timeControl.baseMs;
+    if (IsEnabled()) book.Open(this->options.bookPath, this->options.bookKeysPath, true);
+}
+
+EngineOpponent::~EngineOpponent() {
+    stopRequested.store(true, std::memory_order_relaxed);
+    if (searchThread.joinable()) searchThread.join();
+}
+
+bool EngineOpponent::IsEnabled() const {
+    return options.color.has_value();
+}
+
+void EngineOpponent::Update(const PositionPublisher &positionPublisher) {
+    if (!IsEnabled() || searching) return;
+    PositionSnapshot snapshot = positionPublisher.Load();
+    const Position& position = snapshot.position;
+    if (position.GetSideToMove() != options.color.value()) return;
+
+    BoardMoveQuery moveQuery;
+    MoveSearcher::GetLegalMoves(moveQuery, position);
+    if (moveQuery.moveCount == 0) return;
+
+    if (searchThread.joinable()) searchThread.join();
+    *searchBoard = position;
+    searching = true;
+    searchStart = std::chrono::steady_clock::now();
+    if (std::optional<BoardMove> bookMove = book.Probe(searchBoard, BookSelection::WeightedRandom, bookRandom())) {
+        searchResult = SearchResult{};
+        searchResult.bestMove = bookMove;
+        playedFromBook = true;
+        searchDone = true;
+        return;
+    }
+
+    SearchLimits limits;
+    limits.clock = options.timeControl.GetClock(remainingMs, movesMade);
+    limits.stopSignal = &stopRequested;
+    playedFromBook = false;
+    searchDone = false;
+    searchThread = std::thread([this, limits] {
+        searchResult = searcher.Search(searchBoard, limits);
+        searchDone.store(true, std::memory_order_release);
+    });
+}
+
+std::optional<BoardMove> EngineOpponent::PollMove() {
+    if (!searching || !searchDone.load(std::memory_order_acquire)) return std::nullopt;
+    if (searchThread.joinable()) searchThread.join();
+    searching = false;
+
+    int64_t elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - searchStart).count();
+    if (!options.timeControl.OnMoveMade(remainingMs, elapsedMs, movesMade++)) {
+        // Nobody to adjudicate against in the GUI, so the engine plays on with whatever the increment gives it
+        std::cerr << "Engine lost on time\n";
+        remainingMs = options.timeControl.incrementMs;
+    }
+    if (playedFromBook) {
+        std::cout << "Engine book move, clock " << remainingMs << "ms\n";
+        return searchResult.bestMove;
+    }
+    std::cout << "Engine depth " << searchResult.depth << " score " << searchResult.score << " nodes " << searchResult.nodes
+              << " time " << elapsedMs << "ms clock " << remainingMs << "ms\n";
+    return searchResult.bestMove;
+}
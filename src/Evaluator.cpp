@@ -0,0 +1,182 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/Evaluator.h"
+
+#include <algorithm>
+
+#include "../include/Stats.h"
+#include "../include/Tracer.h"
+
+namespace {
+    constexpr int PIECE_VALUES[] = {0, 0, 900, 500, 320, 330, 100};
+
+    // Tables are written from white's side, rank 8 first and file a first
+    constexpr int PAWN_TABLE[GRID_SIZE][GRID_SIZE] = {
+        {  0,  0,  0,  0,  0,  0,  0,  0},
+        { 50, 50, 50, 50, 50, 50, 50, 50},
+        { 10, 10, 20, 30, 30, 20, 10, 10},
+        {  5,  5, 10, 25, 25, 10,  5,  5},
+        {  0,  0,  0, 20, 20,  0,  0,  0},
+        {  5, -5,-10,  0,  0,-10, -5,  5},
+        {  5, 10, 10,-20,-20, 10, 10,  5},
+        {  0,  0,  0,  0,  0,  0,  0,  0}
+    };
+
+    constexpr int KNIGHT_TABLE[GRID_SIZE][GRID_SIZE] = {
+        {-50,-40,-30,-30,-30,-30,-40,-50},
+        {-40,-20,  0,  0,  0,  0,-20,-40},
+        {-30,  0, 10, 15, 15, 10,  0,-30},
+        {-30,  5, 15, 20, 20, 15,  5,-30},
+        {-30,  0, 15, 20, 20, 15,  0,-30},
+        {-30,  5, 10, 15, 15, 10,  5,-30},
+        {-40,-20,  0,  5,  5,  0,-20,-40},
+        {-50,-40,-30,-30,-30,-30,-40,-50}
+    };
+
+    constexpr int BISHOP_TABLE[GRID_SIZE][GRID_SIZE] = {
+        {-20,-10,-10,-10,-10,-10,-10,-20},
+        {-10,  0,  0,  0,  0,  0,  0,-10},
+        {-10,  0,  5, 10, 10,  5,  0,-10},
+        {-10,  5,  5, 10, 10,  5,  5,-10},
+        {-10,  0, 10, 10, 10, 10,  0,-10},
+        {-10, 10, 10, 10, 10, 10, 10,-10},
+        {-10,  5,  0,  0,  0,  0,  5,-10},
+        {-20,-10,-10,-10,-10,-10,-10,-20}
+    };
+
+    constexpr int ROOK_TABLE[GRID_SIZE][GRID_SIZE] = {
+        {  0,  0,  0,  0,  0,  0,  0,  0},
+        {  5, 10, 10, 10, 10, 10, 10,  5},
+        { -5,  0,  0,  0,  0,  0,  0, -5},
+        { -5,  0,  0,  0,  0,  0,  0, -5},
+        { -5,  0,  0,  0,  0,  0,  0, -5},
+        { -5,  0,  0,  0,  0,  0,  0, -5},
+        { -5,  0,  0,  0,  0,  0,  0, -5},
+        {  0,  0,  0,  5,  5,  0,  0,  0}
+    };
+
+    constexpr int QUEEN_TABLE[GRID_SIZE][GRID_SIZE] = {
+        {-20,-10,-10, -5, -5,-10,-10,-20},
+        {-10,  0,  0,  0,  0,  0,  0,-10},
+        {-10,  0,  5,  5,  5,  5,  0,-10},
+        { -5,  0,  5,  5,  5,  5,  0, -5},
+        {  0,  0,  5,  5,  5,  5,  0, -5},
+        {-10,  5,  5,  5,  5,  5,  0,-10},
+        {-10,  0,  5,  0,  0,  0,  0,-10},
+        {-20,-10,-10, -5, -5,-10,-10,-20}
+    };
+
+    constexpr int KING_TABLE[GRID_SIZE][GRID_SIZE] = {
+        {-30,-40,-40,-50,-50,-40,-40,-30},
+        {-30,-40,-40,-50,-50,-40,-40,-30},
+        {-30,-40,-40,-50,-50,-40,-40,-30},
+        {-30,-40,-40,-50,-50,-40,-40,-30},
+        {-20,-30,-30,-40,-40,-30,-30,-20},
+        {-10,-20,-20,-20,-20,-20,-20,-10},
+        { 20, 20,  0,  0,  0,  0, 20, 20},
+        { 20, 30, 10,  0,  0, 10, 30, 20}
+    };
+}
+
+int Evaluator::Evaluate(const std::unique_ptr<GameBoard> &gameBoard) {
+    STATS_TIMER(StatTimer::Evaluation);
+    TRACE_SCOPE(TraceEvent::Evaluation, 0);
+    int score = 0;
+    for (short row = 0; row < GRID_SIZE; row++) {
+        for (short col = 0; col < GRID_SIZE; col++) {
+            PiecePosition piecePosition{row, col};
+            const Piece& piece = gameBoard->GetPiece(piecePosition);
+            if (piece.type == PieceType::None) continue;
+
+            int pieceScore = GetPieceValue(piece.type) + GetSquareBonus(piece, piecePosition);
+            score += piece.color == PieceColor::White ? pieceScore : -pieceScore;
+        }
+    }
+    return gameBoard->GetSideToMove() == PieceColor::White ? score : -score;
+}
+
+int Evaluator::GetPieceValue(PieceType pieceType) {
+    return PIECE_VALUES[static_cast<int>(pieceType)];
+}
+
+std::array<int, EVAL_PARAMETER_COUNT> Evaluator::GetParameters() {
+    std::array<int, EVAL_PARAMETER_COUNT> parameters {};
+    for (int type = 1; type <= EVAL_PIECE_TYPES; type++) {
+        PieceType pieceType = static_cast<PieceType>(type);
+        parameters[type - 1] = GetPieceValue(pieceType);
+        // Rank 8 of the table is row 7 of the board for a white piece, file a is column 7
+        for (short row = 0; row < GRID_SIZE; row++) {
+            for (short col = 0; col < GRID_SIZE; col++) {
+                Piece piece{pieceType, PieceColor::White};
+                PiecePosition piecePosition{row, col};
+                parameters[GetTableIndex(piece, piecePosition)] = GetSquareBonus(piece, piecePosition);
+            }
+        }
+    }
+    return parameters;
+}
+
+int Evaluator::GetCoefficients(const GameBoard &gameBoard, std::span<EvalCoefficient, EVAL_MAX_COEFFICIENTS> coefficients) {
+    std::array<int, EVAL_PIECE_TYPES> pieceCounts {};
+    int count = 0;
+    for (short row = 0; row < GRID_SIZE; row++) {
+        for (short col = 0; col < GRID_SIZE; col++) {
+            PiecePosition piecePosition{row, col};
+            const Piece& piece = gameBoard.GetPiece(piecePosition);
+            if (piece.type == PieceType::None) continue;
+
+            int sign = piece.color == PieceColor::White ? 1 : -1;
+            pieceCounts[static_cast<int>(piece.type) - 1] += sign;
+
+            // Mirrored squares of opposite colours share a table entry and can cancel
+            int index = GetTableIndex(piece, piecePosition);
+            EvalCoefficient* existing = std::find_if(coefficients.data(), coefficients.data() + count, [index](const EvalCoefficient& coefficient) {
+                return coefficient.index == index;
+            });
+            if (existing != coefficients.data() + count) {
+                existing->value += sign;
+            } else if (count < EVAL_MAX_COEFFICIENTS - EVAL_PIECE_TYPES) {
+                coefficients[count++] = EvalCoefficient{index, sign};
+            }
+        }
+    }
+    for (int type = 0; type < EVAL_PIECE_TYPES; type++) {
+        if (pieceCounts[type] != 0) coefficients[count++] = EvalCoefficient{type, pieceCounts[type]};
+    }
+
+    // Drop the entries that cancelled out
+    EvalCoefficient* end = std::remove_if(coefficients.data(), coefficients.data() + count, [](const EvalCoefficient& coefficient) {
+        return coefficient.value == 0;
+    });
+    return static_cast<int>(end - coefficients.data());
+}
+
+int Evaluator::GetSquareBonus(const Piece &piece, PiecePosition piecePosition) {
+    // Columns run from the h file, rows from rank 1
+    int tableRow = piece.color == PieceColor::White ? GRID_SIZE - piecePosition.row - 1 : piecePosition.row;
+    int tableCol = GRID_SIZE - piecePosition.col - 1;
+    switch (piece.type) {
+        case PieceType::Pawn:
+            return PAWN_TABLE[tableRow][tableCol];
+        case PieceType::Knight:
+            return KNIGHT_TABLE[tableRow][tableCol];
+        case PieceType::Bishop:
+            return BISHOP_TABLE[tableRow][tableCol];
+        case PieceType::Rook:
+            return ROOK_TABLE[tableRow][tableCol];
+        case PieceType::Queen:
+            return QUEEN_TABLE[tableRow][tableCol];
+        case PieceType::King:
+            return KING_TABLE[tableRow][tableCol];
+        default:
+            return 0;
+    }
+}
+
+int Evaluator::GetTableIndex(const Piece &piece, PiecePosition piecePosition) {
+    int tableRow = piece.color == PieceColor::White ? GRID_SIZE - piecePosition.row - 1 : piecePosition.row;
+    int tableCol = GRID_SIZE - piecePosition.col - 1;
+    return EVAL_TABLE_OFFSET + (static_cast<int>(piece.type) - 1) * BOARD_SIZE + tableRow * GRID_SIZE + tableCol;
+}
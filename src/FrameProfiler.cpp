@@ -0,0 +1,142 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/FrameProfiler.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+    constexpr uint64_t HISTOGRAM_MAX_VALUE = (uint64_t{1} << HISTOGRAM_MAX_VALUE_BITS) - 1;
+
+    double ToMicroseconds(uint64_t nanoseconds) {
+        return nanoseconds / 1000.0;
+    }
+}
+
+void LatencyHistogram::Record(uint64_t nanoseconds) {
+    buckets[GetBucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    uint64_t currentMax = maxNanoseconds.load(std::memory_order_relaxed);
+    while (nanoseconds > currentMax && !maxNanoseconds.compare_exchange_weak(currentMax, nanoseconds, std::memory_order_relaxed)) {}
+}
+
+HistogramSummary LatencyHistogram::Summarize() const {
+    std::array<uint64_t, HISTOGRAM_BUCKET_COUNT> counts;
+    uint64_t bucketTotal = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        bucketTotal += counts[i];
+    }
+
+    HistogramSummary summary;
+    summary.count = count.load(std::memory_order_relaxed);
+    summary.maxNanoseconds = maxNanoseconds.load(std::memory_order_relaxed);
+    if (summary.count == 0 || bucketTotal == 0) return summary;
+    summary.meanNanoseconds = static_cast<double>(totalNanoseconds.load(std::memory_order_relaxed)) / summary.count;
+
+    // Percentiles come from the bucket counts alone, a record landing mid scan only shifts them by one
+    auto getPercentile = [&](double fraction) {
+        uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * bucketTotal)));
+        uint64_t seen = 0;
+        for (int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++) {
+            seen += counts[i];
+            if (seen >= target) return std::min(GetBucketValue(i), summary.maxNanoseconds);
+        }
+        return summary.maxNanoseconds;
+    };
+    summary.p50Nanoseconds = getPercentile(0.5);
+    summary.p90Nanoseconds = getPercentile(0.9);
+    summary.p99Nanoseconds = getPercentile(0.99);
+    summary.p999Nanoseconds = getPercentile(0.999);
+    return summary;
+}
+
+int LatencyHistogram::GetBucketIndex(uint64_t nanoseconds) {
+    if (nanoseconds < HISTOGRAM_SUB_BUCKETS) return static_cast<int>(nanoseconds);
+    nanoseconds = std::min(nanoseconds, HISTOGRAM_MAX_VALUE);
+    // The top HISTOGRAM_SUB_BUCKET_BITS bits pick the bucket, the leading one keeps it in the upper half
+    int shift = std::bit_width(nanoseconds) - HISTOGRAM_SUB_BUCKET_BITS;
+    return shift * HISTOGRAM_HALF_SUB_BUCKETS + static_cast<int>(nanoseconds >> shift);
+}
+
+uint64_t LatencyHistogram::GetBucketValue(int index) {
+    if (index < HISTOGRAM_SUB_BUCKETS) return index;
+    int shift = index / HISTOGRAM_HALF_SUB_BUCKETS - 1;
+    uint64_t subBucket = index % HISTOGRAM_HALF_SUB_BUCKETS + HISTOGRAM_HALF_SUB_BUCKETS;
+    return subBucket << shift;
+}
+
+void FrameProfiler::Record(FramePhase phase, std::chrono::steady_clock::duration duration) {
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    histograms[static_cast<int>(phase)].Record(static_cast<uint64_t>(std::max<int64_t>(nanoseconds, 0)));
+}
+
+void FrameProfiler::BeginFrame() {
+    frameStart = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::EndFrame() {
+    auto now = std::chrono::steady_clock::now();
+    Record(FramePhase::Frame, now - frameStart);
+    if (!pendingInput.has_value()) return;
+    Record(FramePhase::InputLatency, now - pendingInput.value());
+    pendingInput.reset();
+}
+
+void FrameProfiler::MarkInput() {
+    if (!pendingInput.has_value()) pendingInput = std::chrono::steady_clock::now();
+}
+
+HistogramSummary FrameProfiler::Summarize(FramePhase phase) const {
+    return histograms[static_cast<int>(phase)].Summarize();
+}
+
+std::string FrameProfiler::GetOverlaySummary() const {
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(1) << std::left << std::setw(15) << "us" << std::right
+            << std::setw(7) << "p50" << std::setw(8) << "p99" << std::setw(8) << "max";
+    for (int i = 0; i < FRAME_PHASE_COUNT; i++) {
+        auto phase = static_cast<FramePhase>(i);
+        HistogramSummary phaseSummary = Summarize(phase);
+        summary << '\n' << std::left << std::setw(15) << GetPhaseName(phase) << std::right
+                << std::setw(7) << ToMicroseconds(phaseSummary.p50Nanoseconds)
+                << std::setw(8) << ToMicroseconds(phaseSummary.p99Nanoseconds)
+                << std::setw(8) << ToMicroseconds(phaseSummary.maxNanoseconds);
+    }
+    return summary.str();
+}
+
+bool FrameProfiler::WriteCsv(const std::string &path) const {
+    std::ofstream output(path, std::ios::trunc);
+    output << "phase,count,mean_us,p50_us,p90_us,p99_us,p999_us,max_us\n" << std::fixed << std::setprecision(3);
+    for (int i = 0; i < FRAME_PHASE_COUNT; i++) {
+        auto phase = static_cast<FramePhase>(i);
+        HistogramSummary summary = Summarize(phase);
+        output << GetPhaseName(phase) << ',' << summary.count << ',' << summary.meanNanoseconds / 1000 << ','
+               << ToMicroseconds(summary.p50Nanoseconds) << ',' << ToMicroseconds(summary.p90Nanoseconds) << ','
+               << ToMicroseconds(summary.p99Nanoseconds) << ',' << ToMicroseconds(summary.p999Nanoseconds) << ','
+               << ToMicroseconds(summary.maxNanoseconds) << '\n';
+    }
+    return static_cast<bool>(output);
+}
+
+const char* FrameProfiler::GetPhaseName(FramePhase phase) {
+    switch (phase) {
+        case FramePhase::Grid: return "grid";
+        case FramePhase::MovePositions: return "move_positions";
+        case FramePhase::Pieces: return "pieces";
+        case FramePhase::LoadGameBoard: return "load_board";
+        case FramePhase::LoadMoveSprites: return "load_moves";
+        case FramePhase::Frame: return "frame";
+        case FramePhase::InputLatency: return "input_latency";
+        case FramePhase::Count: break;
+    }
+    return "unknown";
+}
@@ -4,10 +4,15 @@
 
 #include "../include/GameBoard.h"
 
+#include <cctype>
 #include <iostream>
 #include <ostream>
+#include <sstream>
 #include <stdexcept>
 
+#include "../include/Stats.h"
+#include "../include/Tracer.h"
+
 
 void GameBoard::LoadDefaultBoard() {
     ClearBoard();
@@ -38,6 +43,7 @@ void GameBoard::LoadDefaultBoard() {
     Piece emptyPiece = {PieceType::None,PieceColor::Black}; // Lets white go first
     PieceMove emptyMove = {};
     pieceMoveHistory = {emptyMove,emptyPiece};
+    halfmoveClock = 0;
 
     whiteBitBoard = CalculateBitBoards(PieceColor::White);
     blackBitBoard = CalculateBitBoards(PieceColor::Black);
@@ -52,15 +58,130 @@ void GameBoard::ClearBoard() {
             piece.moveState = PieceMoveState::NotMoved;
         }
     }
-    for (int i = 0; i < BOARD_SIZE; i++) {
+    whiteBitBoard = {};
+    blackBitBoard = {};
+}
+
+bool GameBoard::LoadFen(const std::string &fen) {
+    ClearBoard();
+
+    std::istringstream stream(fen);
+    std::string placement, side, castling, enPassant;
+    if (!(stream >> placement >> side >> castling >> enPassant)) return false;
+    // The clocks are optional so EPD lines load as well
+    if (!(stream >> halfmoveClock) || halfmoveClock < 0) halfmoveClock = 0;
+
+    // FEN lists ranks 8 to 1 and files a to h, columns run h to a on this board
+    short row = GRID_SIZE - 1;
+    short file = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (file != GRID_SIZE || row == 0) return false;
+            row--;
+            file = 0;
+            continue;
+        }
+        if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > GRID_SIZE) return false;
+            continue;
+        }
+
+        PieceType type;
+        switch (std::tolower(c)) {
+            case 'k': type = PieceType::King; break;
+            case 'q': type = PieceType::Queen; break;
+            case 'r': type = PieceType::Rook; break;
+            case 'n': type = PieceType::Knight; break;
+            case 'b': type = PieceType::Bishop; break;
+            case 'p': type = PieceType::Pawn; break;
+            default: return false;
+        }
+        if (file >= GRID_SIZE) return false;
+
+        PieceColor color = std::isupper(c) ? PieceColor::White : PieceColor::Black;
+        pieces[GRID_SIZE - file - 1][row] = Piece{type, color, PieceMoveState::Moved};
+        file++;
+    }
+    if (row != 0 || file != GRID_SIZE) return false;
+
+    // Move state is what the move generator reads for double pushes and castling rights
+    for (short col = 0; col < GRID_SIZE; col++) {
+        Piece& whitePawn = pieces[col][1];
+        if (whitePawn.type == PieceType::Pawn && whitePawn.color == PieceColor::White) whitePawn.moveState = PieceMoveState::NotMoved;
+        Piece& blackPawn = pieces[col][GRID_SIZE - 2];
+        if (blackPawn.type == PieceType::Pawn && blackPawn.color == PieceColor::Black) blackPawn.moveState = PieceMoveState::NotMoved;
+    }
+
+    if (castling != "-") {
+        for (char c : castling) {
+            PieceColor color = std::isupper(c) ? PieceColor::White : PieceColor::Black;
+            short homeRow = color == PieceColor::White ? 0 : GRID_SIZE - 1;
+            short rookCol;
+            switch (std::tolower(c)) {
+                case 'k': rookCol = 0; break;
+                case 'q': rookCol = GRID_SIZE - 1; break;
+                default: return false;
+            }
+            Piece& king = pieces[3][homeRow];
+            Piece& rook = pieces[rookCol][homeRow];
+            if (king.type != PieceType::King || king.color != color) continue;
+            if (rook.type != PieceType::Rook || rook.color != color) continue;
+            king.moveState = PieceMoveState::NotMoved;
+            rook.moveState = PieceMoveState::NotMoved;
+        }
+    }
 
+    PieceColor sideToMove;
+    if (side == "w") {
+        sideToMove = PieceColor::White;
+    } else if (side == "b") {
+        sideToMove = PieceColor::Black;
+    } else {
+        return false;
     }
+    PieceColor lastMoveColor = sideToMove == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    pieceMoveHistory = {PieceMove{}, Piece{PieceType::None, lastMoveColor}};
+
+    // En passant is encoded as the double pawn push that made it possible
+    if (enPassant != "-") {
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h') return false;
+        short col = GRID_SIZE - (enPassant[0] - 'a') - 1;
+        short targetRow = enPassant[1] - '1';
+        short pawnRow = sideToMove == PieceColor::White ? targetRow - 1 : targetRow + 1;
+        PiecePosition pawnPosition{pawnRow, col};
+        if (pawnPosition.OutOfBounds()) return false;
+        const Piece& pawn = GetPiece(pawnPosition);
+        if (pawn.type == PieceType::Pawn && pawn.color == lastMoveColor) {
+            pieceMoveHistory = {PieceMove{MoveType::DoublePawnPush, pawnPosition}, pawn};
+        }
+    }
+
+    whiteBitBoard = CalculateBitBoards(PieceColor::White);
+    blackBitBoard = CalculateBitBoards(PieceColor::Black);
+    return true;
 }
 
-Piece &GameBoard::GetPiece(PiecePosition position) {
+const Piece &GameBoard::GetPiece(PiecePosition position) const {
     return pieces[position.col][position.row];
 }
 
+void GameBoard::SetPiece(PiecePosition position, Piece piece) {
+    pieces[position.col][position.row] = piece;
+}
+
+PieceColor GameBoard::GetSideToMove() const {
+    return pieceMoveHistory.piece.color == PieceColor::White ? PieceColor::Black : PieceColor::White;
+}
+
+int GameBoard::GetHalfmoveClock() const {
+    return halfmoveClock;
+}
+
+void GameBoard::SetHalfmoveClock(int clock) {
+    halfmoveClock = clock;
+}
+
 void GameBoard::MovePiece(PiecePosition from, PiecePosition to) {
     Piece currentPiece = GetPiece(from);
     currentPiece.moveState = PieceMoveState::Moved;
@@ -69,7 +190,11 @@ void GameBoard::MovePiece(PiecePosition from, PiecePosition to) {
 }
 
 void GameBoard::ExecuteMove(PieceMove move, PiecePosition piecePosition) {
+    STATS_ADD(StatCounter::ExecuteMoves, 1);
+    TRACE_SCOPE(TraceEvent::ExecuteMove, move.type);
     Piece movePiece = GetPiece(piecePosition);
+    bool capture = move.type == MoveType::EnPassant || GetPiece(move.position).type != PieceType::None;
+    halfmoveClock = capture || movePiece.type == PieceType::Pawn ? 0 : halfmoveClock + 1;
     switch (move.type) {
         case MoveType::Standard:
         case MoveType::DoublePawnPush:
@@ -124,7 +249,7 @@ void GameBoard::SetLastMove(PieceMove move, Piece piece) {
     pieceMoveHistory = {move,piece};
 }
 
-PieceMoveHistory & GameBoard::GetLastMove() {
+const PieceMoveHistory & GameBoard::GetLastMove() const {
     return pieceMoveHistory;
 }
 
@@ -143,24 +268,22 @@ void GameBoard::LoadPieceDeclarations(const std::vector<PieceDeclaration> &piece
     }
 }
 
-ColorBitBoards & GameBoard::GetColorBitBoards(PieceColor pieceColor) {
-    switch (pieceColor) {
-        case PieceColor::Black:
-            return blackBitBoard;
-        case PieceColor::White:
-            return whiteBitBoard;
-        default:
-            throw std::runtime_error("Invalid PieceColor in GetColorBitBoards");
-    }
+const ColorBitBoards & GameBoard::GetColorBitBoards(PieceColor pieceColor) const {
+    return pieceColor == PieceColor::White ? whiteBitBoard : blackBitBoard;
+}
+
+void GameBoard::SetColorBitBoards(PieceColor pieceColor, ColorBitBoards colorBitBoards) {
+    (pieceColor == PieceColor::White ? whiteBitBoard : blackBitBoard) = colorBitBoards;
 }
 
-ColorBitBoards GameBoard::CalculateBitBoards(PieceColor pieceColor) {
+ColorBitBoards GameBoard::CalculateBitBoards(PieceColor pieceColor) const {
+    STATS_ADD(StatCounter::BitBoardRecomputes, 1);
     uint64_t occupied = 0;
 
     for (int col = 0; col < GRID_SIZE; ++col) {
         for (int row = 0; row < GRID_SIZE; ++row) {
             PiecePosition piecePosition(row,col);
-            Piece& piece = GetPiece(piecePosition);
+            const Piece& piece = GetPiece(piecePosition);
 
             if (pieceColor == piece.color && piece.type != PieceType::None) {
                 uint64_t mask = piecePosition.GetBitMapMask();
@@ -170,14 +293,3 @@ ColorBitBoards GameBoard::CalculateBitBoards(PieceColor pieceColor) {
     }
     return ColorBitBoards{occupied,0,0};
 }
-
-bool GameBoard::RowOccupied(PiecePosition initialPosition, int direction, int checkCount) {
-    for (int i = 1; i <= checkCount; i++) {
-        PiecePosition position(initialPosition.row,initialPosition.col+direction*i);
-        if (position.OutOfBounds()) return true;
-
-        Piece piece = GetPiece(position);
-        if (piece.type != PieceType::None) return true;
-    }
-    return false;
-}
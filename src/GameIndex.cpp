@@ -0,0 +1,402 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/GameIndex.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <span>
+
+#include "../include/ArgParse.h"
+#include "../include/TranspositionTable.h"
+#include "../include/Zobrist.h"
+
+namespace {
+    constexpr char GAME_INDEX_MAGIC[4] = {'C', 'G', 'I', 'X'};
+    constexpr int MAX_VARINT_BYTES = 10;
+
+    void AppendVarint(std::string &buffer, uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    bool ReadVarint(const uint8_t* &cursor, const uint8_t* end, uint64_t &value) {
+        value = 0;
+        for (int i = 0; i < MAX_VARINT_BYTES && cursor < end; i++) {
+            uint8_t byte = *cursor++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+
+    IndexedResult ParseResult(std::string_view result) {
+        if (result == "1-0") return IndexedResult::WhiteWins;
+        if (result == "0-1") return IndexedResult::BlackWins;
+        if (result == "1/2-1/2") return IndexedResult::Draw;
+        return IndexedResult::Unknown;
+    }
+
+    // Groups records into blocks and writes each block once it is full
+    class BlockWriter {
+    public:
+        explicit BlockWriter(std::ofstream &output) : output(output) {}
+
+        void Append(const GameIndexRecord &record) {
+            if (blockRecords == GAME_INDEX_BLOCK_RECORDS) Flush();
+            if (blockRecords == 0) {
+                blockTable.push_back(GameIndexBlock{record.key, offset});
+                previous = GameIndexRecord{record.key, 0, 0, IndexedResult::Unknown, {}};
+            }
+            uint64_t keyDelta = record.key - previous.key;
+            AppendVarint(block, keyDelta);
+            AppendVarint(block, keyDelta == 0 ? record.gameOffset - previous.gameOffset : record.gameOffset);
+            AppendVarint(block, static_cast<uint64_t>(record.move) << 2 | static_cast<uint64_t>(record.result));
+            previous = record;
+            blockRecords++;
+        }
+
+        void Flush() {
+            output.write(block.data(), static_cast<std::streamsize>(block.size()));
+            offset += block.size();
+            block.clear();
+            blockRecords = 0;
+        }
+
+        uint64_t offset = sizeof(GameIndexHeader);
+        std::vector<GameIndexBlock> blockTable;
+
+    private:
+        std::ofstream& output;
+        std::string block;
+        size_t blockRecords = 0;
+        GameIndexRecord previous{};
+    };
+}
+
+void GameIndexScore::Add(IndexedResult result) {
+    games++;
+    if (result == IndexedResult::WhiteWins) whiteWins++;
+    if (result == IndexedResult::Draw) draws++;
+    if (result == IndexedResult::BlackWins) blackWins++;
+}
+
+double GameIndexScore::GetScore(PieceColor color) const {
+    uint64_t decided = whiteWins + draws + blackWins;
+    if (decided == 0) return 0.5;
+    uint64_t wins = color == PieceColor::White ? whiteWins : blackWins;
+    return (wins + draws * 0.5) / decided;
+}
+
+bool GameIndexOptions::ParseArgs(int argc, char **argv) {
+    // argv[1] is the command and argv[2] the mode, the paths and the FEN follow without flags
+    if (argc > 2) mode = argv[2];
+    std::vector<std::string> arguments;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], threads)) return false;
+        } else if (arg == "--memory" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], memoryMb)) return false;
+        } else if (arg == "--temp" && hasValue) {
+            tempDirectory = argv[++i];
+        } else if (arg == "--max-ply" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], maxPly)) return false;
+        } else if (arg == "--games" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], gameLimit)) return false;
+        } else if (!arg.starts_with("--")) {
+            arguments.push_back(arg);
+        }
+    }
+
+    if (mode == "build") {
+        if (arguments.size() > 0) pgnPath = arguments[0];
+        if (arguments.size() > 1) indexPath = arguments[1];
+    } else {
+        if (arguments.size() > 0) indexPath = arguments[0];
+        if (arguments.size() > 1) fen = arguments[1];
+    }
+    return true;
+}
+
+bool GameIndex::Open(const std::string &path) {
+    header = nullptr;
+    blocks = nullptr;
+    if (!mappedFile.Open(path, MappedFileAccess::Random)) {
+        std::cerr << "Failed to open game index: " << path << '\n';
+        return false;
+    }
+
+    const auto* fileHeader = reinterpret_cast<const GameIndexHeader*>(mappedFile.GetData());
+    size_t size = mappedFile.GetSize();
+    if (size < sizeof(GameIndexHeader) || std::memcmp(fileHeader->magic, GAME_INDEX_MAGIC, sizeof(GAME_INDEX_MAGIC)) != 0
+        || fileHeader->version != GAME_INDEX_VERSION) {
+        std::cerr << "Not a game index of version " << GAME_INDEX_VERSION << ": " << path << '\n';
+        mappedFile.Close();
+        return false;
+    }
+    if (fileHeader->dataEnd > fileHeader->blockTableOffset || fileHeader->blockTableOffset % alignof(GameIndexBlock) != 0
+        || fileHeader->blockTableOffset > size || (size - fileHeader->blockTableOffset) / sizeof(GameIndexBlock) < fileHeader->blockCount) {
+        std::cerr << "Truncated game index: " << path << '\n';
+        mappedFile.Close();
+        return false;
+    }
+
+    header = fileHeader;
+    blocks = reinterpret_cast<const GameIndexBlock*>(mappedFile.GetData() + header->blockTableOffset);
+    return true;
+}
+
+GameIndexQuery GameIndex::Query(const Position &position, size_t gameLimit) const {
+    GameIndexQuery query;
+    if (!IsOpen() || header->blockCount == 0) return query;
+
+    uint64_t key = Zobrist::ComputeKey(position, Zobrist::GetEngineKeys());
+    std::vector<std::pair<uint16_t, GameIndexScore>> packedMoves;
+    const auto* data = reinterpret_cast<const uint8_t*>(mappedFile.GetData());
+
+    bool passedKey = false;
+    for (size_t block = FindFirstBlock(key); block < header->blockCount && !passedKey; block++) {
+        if (blocks[block].firstKey > key) break;
+        const uint8_t* cursor = data + blocks[block].offset;
+        const uint8_t* end = data + (block + 1 < header->blockCount ? blocks[block + 1].offset : header->dataEnd);
+
+        uint64_t recordKey = blocks[block].firstKey;
+        uint64_t gameOffset = 0;
+        while (cursor < end) {
+            uint64_t keyDelta;
+            uint64_t offsetValue;
+            uint64_t moveAndResult;
+            if (!ReadVarint(cursor, end, keyDelta) || !ReadVarint(cursor, end, offsetValue) || !ReadVarint(cursor, end, moveAndResult)) break;
+            recordKey += keyDelta;
+            gameOffset = keyDelta == 0 ? gameOffset + offsetValue : offsetValue;
+            if (recordKey < key) continue;
+            if (recordKey > key) {
+                passedKey = true;
+                break;
+            }
+
+            auto result = static_cast<IndexedResult>(moveAndResult & 3);
+            auto packedMove = static_cast<uint16_t>(moveAndResult >> 2);
+            query.total.Add(result);
+            if (query.gameOffsets.size() < gameLimit) query.gameOffsets.push_back(gameOffset);
+            if (packedMove == 0) continue;
+
+            auto found = std::find_if(packedMoves.begin(), packedMoves.end(), [packedMove](const auto &entry) { return entry.first == packedMove; });
+            if (found == packedMoves.end()) found = packedMoves.insert(packedMoves.end(), {packedMove, GameIndexScore{}});
+            found->second.Add(result);
+        }
+    }
+
+    // A move that is not legal here belongs to another position sharing the key
+    BoardMoveQuery moveQuery;
+    MoveSearcher::GetLegalMoves(moveQuery, position);
+    for (const auto& [packedMove, score] : packedMoves) {
+        std::optional<BoardMove> boardMove = TranspositionTable::FindMove(packedMove, moveQuery);
+        if (boardMove.has_value()) query.moves.push_back(GameIndexMoveStats{boardMove.value(), score});
+    }
+    std::sort(query.moves.begin(), query.moves.end(), [](const GameIndexMoveStats &a, const GameIndexMoveStats &b) {
+        return a.score.games > b.score.games;
+    });
+    return query;
+}
+
+size_t GameIndex::FindFirstBlock(uint64_t key) const {
+    const GameIndexBlock* found = std::lower_bound(blocks, blocks + header->blockCount, key, [](const GameIndexBlock &block, uint64_t key) {
+        return block.firstKey < key;
+    });
+    // The key's first records may close the block before the first one it heads
+    size_t index = found - blocks;
+    return index > 0 ? index - 1 : 0;
+}
+
+GameIndexBuilder::GameIndexBuilder(GameIndexOptions options) : options(std::move(options)) {
+    this->options.threads = std::max(this->options.threads, 1);
+    this->options.memoryMb = std::max<size_t>(this->options.memoryMb, 1);
+    runCapacity = std::max<size_t>(this->options.memoryMb * 1024 * 1024 / sizeof(GameIndexRecord) / this->options.threads, 1);
+    if (this->options.tempDirectory.empty()) {
+        std::filesystem::path indexDirectory = std::filesystem::path(this->options.indexPath).parent_path();
+        this->options.tempDirectory = indexDirectory.empty() ? "." : indexDirectory.string();
+    }
+}
+
+int GameIndexBuilder::Run() {
+    PgnReader pgnReader;
+    if (!pgnReader.Open(options.pgnPath)) {
+        std::cerr << "Failed to open PGN: " << options.pgnPath << '\n';
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    PgnReadStats stats = pgnReader.Read(options.threads, [this](const PgnGame &game, const std::unique_ptr<GameBoard>&) {
+        IndexGame(game);
+    });
+    gameCount = stats.games;
+    for (auto& [threadId, threadRun] : threadRuns) {
+        if (!failed && !SpillRun(threadRun.records)) failed = true;
+    }
+    threadRuns.clear();
+    auto sortTime = std::chrono::steady_clock::now();
+
+    if (!failed && !MergeRuns()) failed = true;
+    RemoveRuns();
+    if (failed) return 1;
+
+    auto endTime = std::chrono::steady_clock::now();
+    std::cout << "games " << gameCount << " positions " << recordCount << " runs " << runCount
+              << " bytes " << std::filesystem::file_size(options.indexPath)
+              << " sort_ms " << std::chrono::duration_cast<std::chrono::milliseconds>(sortTime - startTime).count()
+              << " merge_ms " << std::chrono::duration_cast<std::chrono::milliseconds>(endTime - sortTime).count() << '\n';
+    return 0;
+}
+
+void GameIndexBuilder::IndexGame(const PgnGame &game) {
+    if (failed) return;
+    ThreadRun* threadRun;
+    {
+        std::lock_guard lock(mutex);
+        threadRun = &threadRuns[std::this_thread::get_id()];
+    }
+    if (threadRun->records.capacity() < runCapacity) threadRun->records.reserve(runCapacity);
+
+    const std::unique_ptr<GameBoard>& gameBoard = threadRun->gameBoard;
+    if (!game.LoadStartBoard(gameBoard)) return;
+
+    std::vector<GameIndexRecord>& records = threadRun->records;
+    size_t gameStart = records.size();
+    IndexedResult result = ParseResult(game.result);
+    size_t plies = options.maxPly > 0 ? std::min(game.moves.size(), static_cast<size_t>(options.maxPly)) : game.moves.size();
+    for (size_t ply = 0; ply <= plies; ply++) {
+        uint64_t key = Zobrist::ComputeKey(*gameBoard, Zobrist::GetEngineKeys());
+        // A position repeated within one game counts once, with the move first played from it
+        bool repeated = std::any_of(records.begin() + gameStart, records.end(), [key](const GameIndexRecord &record) { return record.key == key; });
+        if (!repeated) {
+            uint16_t move = ply < game.moves.size() ? TranspositionTable::PackMove(game.moves[ply]) : 0;
+            records.push_back(GameIndexRecord{key, game.offset, move, result, {}});
+        }
+        if (ply < plies) gameBoard->ExecuteMove(game.moves[ply].move, game.moves[ply].from);
+    }
+
+    if (records.size() >= runCapacity && !SpillRun(records)) failed = true;
+}
+
+bool GameIndexBuilder::SpillRun(std::vector<GameIndexRecord> &records) {
+    if (records.empty()) return true;
+    std::sort(records.begin(), records.end());
+
+    size_t run;
+    {
+        std::lock_guard lock(mutex);
+        run = runCount++;
+    }
+    std::string path = GetRunPath(run);
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(GameIndexRecord)));
+    if (!output) {
+        std::cerr << "Failed to write " << path << '\n';
+        return false;
+    }
+    records.clear();
+    return true;
+}
+
+bool GameIndexBuilder::MergeRuns() {
+    std::vector<MappedFile> runFiles(runCount);
+    std::vector<std::span<const GameIndexRecord>> runs(runCount);
+    for (size_t run = 0; run < runCount; run++) {
+        if (!runFiles[run].Open(GetRunPath(run), MappedFileAccess::Sequential)) {
+            std::cerr << "Failed to open " << GetRunPath(run) << '\n';
+            return false;
+        }
+        runs[run] = std::span(reinterpret_cast<const GameIndexRecord*>(runFiles[run].GetData()), runFiles[run].GetSize() / sizeof(GameIndexRecord));
+    }
+
+    std::ofstream output(options.indexPath, std::ios::binary | std::ios::trunc);
+    GameIndexHeader header{};
+    std::memcpy(header.magic, GAME_INDEX_MAGIC, sizeof(GAME_INDEX_MAGIC));
+    header.version = GAME_INDEX_VERSION;
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Each run holds its next record's position, the heap hands out the smallest record of any run
+    std::vector<size_t> positions(runCount, 0);
+    auto isLater = [&runs, &positions](size_t a, size_t b) { return runs[b][positions[b]] < runs[a][positions[a]]; };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(isLater)> heap(isLater);
+    for (size_t run = 0; run < runCount; run++) {
+        if (!runs[run].empty()) heap.push(run);
+    }
+
+    BlockWriter blockWriter(output);
+    recordCount = 0;
+    while (!heap.empty()) {
+        size_t run = heap.top();
+        heap.pop();
+        blockWriter.Append(runs[run][positions[run]]);
+        recordCount++;
+        if (++positions[run] < runs[run].size()) heap.push(run);
+    }
+    blockWriter.Flush();
+
+    header.recordCount = recordCount;
+    header.gameCount = gameCount;
+    header.blockCount = blockWriter.blockTable.size();
+    header.dataEnd = blockWriter.offset;
+    header.blockTableOffset = (blockWriter.offset + alignof(GameIndexBlock) - 1) / alignof(GameIndexBlock) * alignof(GameIndexBlock);
+    const char padding[alignof(GameIndexBlock)] = {};
+    output.write(padding, static_cast<std::streamsize>(header.blockTableOffset - header.dataEnd));
+    output.write(reinterpret_cast<const char*>(blockWriter.blockTable.data()), static_cast<std::streamsize>(header.blockCount * sizeof(GameIndexBlock)));
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!output) {
+        std::cerr << "Failed to write " << options.indexPath << '\n';
+        return false;
+    }
+    return true;
+}
+
+std::string GameIndexBuilder::GetRunPath(size_t run) const {
+    std::string indexName = std::filesystem::path(options.indexPath).filename().string();
+    return (std::filesystem::path(options.tempDirectory) / (indexName + ".run" + std::to_string(run))).string();
+}
+
+void GameIndexBuilder::RemoveRuns() const {
+    for (size_t run = 0; run < runCount; run++) {
+        std::error_code error;
+        std::filesystem::remove(GetRunPath(run), error);
+    }
+}
+
+bool OpeningExplorerOptions::ParseArgs(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--opening-index" && hasValue) {
+            indexPath = argv[++i];
+        }
+    }
+    return true;
+}
+
+OpeningExplorer::OpeningExplorer(OpeningExplorerOptions options) : options(std::move(options)) {
+    if (!this->options.indexPath.empty()) gameIndex.Open(this->options.indexPath);
+}
+
+bool OpeningExplorer::IsEnabled() const {
+    return gameIndex.IsOpen();
+}
+
+std::optional<GameIndexQuery> OpeningExplorer::Update(const PositionPublisher &positionPublisher) {
+    if (!IsEnabled()) return std::nullopt;
+    PositionSnapshot snapshot = positionPublisher.Load();
+    if (snapshot.version == positionVersion) return std::nullopt;
+    positionVersion = snapshot.version;
+    return gameIndex.Query(snapshot.position);
+}
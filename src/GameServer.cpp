@@ -0,0 +1,607 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/GameServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../include/ArgParse.h"
+#include "../include/Notation.h"
+
+namespace {
+    // Epoll tags above every session id
+    constexpr uint64_t WAKE_TAG = UINT64_MAX;
+    constexpr uint64_t SIGNAL_TAG = UINT64_MAX - 1;
+    constexpr uint64_t LISTEN_TAG_BASE = UINT64_MAX - 16;
+    constexpr int MAX_EPOLL_EVENTS = 256;
+    constexpr size_t READ_CHUNK_SIZE = 4096;
+    // How often the loop wakes to look for stalled sessions while any session is over its output limit
+    constexpr int STALL_CHECK_INTERVAL_MS = 1000;
+
+    std::optional<BoardMove> ParseMove(const std::string &text, const std::unique_ptr<GameBoard> &gameBoard) {
+        BoardMoveQuery moveQuery;
+        MoveSearcher::GetLegalMoves(moveQuery, *gameBoard);
+        for (int i = 0; i < moveQuery.moveCount; i++) {
+            if (Notation::GetMoveName(moveQuery.moves[i]) == text) return moveQuery.moves[i];
+        }
+        return Notation::ParseSanMove(text, gameBoard);
+    }
+
+    uint64_t GetResidentMb() {
+        std::ifstream statm("/proc/self/statm");
+        uint64_t totalPages = 0;
+        uint64_t residentPages = 0;
+        statm >> totalPages >> residentPages;
+        return residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) / (1024 * 1024);
+    }
+}
+
+bool GameServerOptions::ParseArgs(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--port" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], port)) return false;
+        } else if (arg == "--unix" && hasValue) {
+            unixPath = argv[++i];
+        } else if (arg == "--workers" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], workers)) return false;
+        } else if (arg == "--sessions" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], maxSessions)) return false;
+        } else if (arg == "--queue" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], queueCapacity)) return false;
+        } else if (arg == "--nodes" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], nodeBudget)) return false;
+        } else if (arg == "--session-nodes" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], sessionNodeBudget)) return false;
+        } else if (arg == "--hash" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], hashMb)) return false;
+        }
+    }
+    return true;
+}
+
+GameBoardPool::GameBoardPool(size_t capacity) {
+    freeBoards.reserve(capacity);
+    for (size_t i = 0; i < capacity; i++) {
+        freeBoards.push_back(std::make_unique<GameBoard>());
+    }
+}
+
+std::unique_ptr<GameBoard> GameBoardPool::Acquire() {
+    if (freeBoards.empty()) return nullptr;
+    std::unique_ptr<GameBoard> gameBoard = std::move(freeBoards.back());
+    freeBoards.pop_back();
+    return gameBoard;
+}
+
+void GameBoardPool::Release(std::unique_ptr<GameBoard> gameBoard) {
+    freeBoards.push_back(std::move(gameBoard));
+}
+
+GameServer::GameServer(GameServerOptions options) : options(std::move(options)), boardPool(this->options.maxSessions) {
+    if (this->options.workers <= 0) {
+        this->options.workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (this->options.queueCapacity == 0) {
+        this->options.queueCapacity = this->options.workers * 8;
+    }
+    latencies.reserve(SERVER_LATENCY_WINDOW);
+}
+
+GameServer::~GameServer() {
+    StopWorkers();
+    for (auto& [sessionId, session] : sessions) {
+        close(session.fileDescriptor);
+    }
+    for (int listenDescriptor : listenDescriptors) {
+        close(listenDescriptor);
+    }
+    if (!options.unixPath.empty() && !listenDescriptors.empty()) unlink(options.unixPath.c_str());
+    for (int fileDescriptor : {epollDescriptor, wakeDescriptor, signalDescriptor}) {
+        if (fileDescriptor >= 0) close(fileDescriptor);
+    }
+}
+
+int GameServer::Run() {
+    if (options.port == 0 && options.unixPath.empty()) {
+        std::cerr << "Usage: ChessEngine serve [--port N] [--unix path] [--workers N] [--sessions N] [--nodes N]\n";
+        return 1;
+    }
+
+    // Every session is a descriptor, the default soft limit of 1024 would cap the server far below its pool
+    rlimit fileLimit {};
+    if (getrlimit(RLIMIT_NOFILE, &fileLimit) == 0 && fileLimit.rlim_cur < fileLimit.rlim_max) {
+        fileLimit.rlim_cur = fileLimit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &fileLimit);
+    }
+
+    // Signals arrive through the loop rather than interrupting it
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    wakeDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    signalDescriptor = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (epollDescriptor < 0 || wakeDescriptor < 0 || signalDescriptor < 0) {
+        std::cerr << "Failed to set up the event loop: " << std::strerror(errno) << '\n';
+        return 1;
+    }
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_TAG;
+    epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, wakeDescriptor, &event);
+    event.data.u64 = SIGNAL_TAG;
+    epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, signalDescriptor, &event);
+    if (!OpenListeners()) return 1;
+
+    // Workers start after the signal mask is set so they inherit it
+    workers.reserve(options.workers);
+    for (int i = 0; i < options.workers; i++) {
+        workers.emplace_back(&GameServer::RunWorker, this);
+    }
+    std::cerr << "Serving with " << options.workers << " workers, " << options.maxSessions << " sessions, "
+              << options.nodeBudget << " nodes per request\n";
+
+    std::array<epoll_event, MAX_EPOLL_EVENTS> events;
+    bool running = true;
+    while (running) {
+        int eventCount = epoll_wait(epollDescriptor, events.data(), MAX_EPOLL_EVENTS, fullSessions > 0 ? STALL_CHECK_INTERVAL_MS : -1);
+        if (eventCount < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait failed: " << std::strerror(errno) << '\n';
+            break;
+        }
+        for (int i = 0; i < eventCount; i++) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == SIGNAL_TAG) {
+                running = false;
+            } else if (tag == WAKE_TAG) {
+                uint64_t count;
+                while (read(wakeDescriptor, &count, sizeof(count)) > 0) {}
+                DeliverReplies();
+            } else if (tag >= LISTEN_TAG_BASE) {
+                AcceptConnections(listenDescriptors[tag - LISTEN_TAG_BASE]);
+            } else {
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) ReadSession(tag);
+                auto session = sessions.find(tag);
+                if (session != sessions.end() && (events[i].events & EPOLLOUT)) {
+                    FlushSession(tag, session->second);
+                    // Lines left waiting while the client was behind on its replies
+                    ProcessLines(tag);
+                }
+            }
+        }
+        if (fullSessions > 0) DropStalledSessions();
+    }
+
+    StopWorkers();
+    std::cerr << GetStats() << '\n';
+    return 0;
+}
+
+bool GameServer::OpenListeners() {
+    auto addListener = [this](int listenDescriptor) {
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.u64 = LISTEN_TAG_BASE + listenDescriptors.size();
+        listenDescriptors.push_back(listenDescriptor);
+        epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, listenDescriptor, &event);
+    };
+
+    if (options.port != 0) {
+        int listenDescriptor = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int enable = 1;
+        setsockopt(listenDescriptor, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        sockaddr_in address {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(options.port));
+        // Localhost only, the protocol has no authentication
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (listenDescriptor < 0 || bind(listenDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || listen(listenDescriptor, SOMAXCONN) != 0) {
+            std::cerr << "Failed to listen on port " << options.port << ": " << std::strerror(errno) << '\n';
+            if (listenDescriptor >= 0) close(listenDescriptor);
+            return false;
+        }
+        addListener(listenDescriptor);
+    }
+
+    if (!options.unixPath.empty()) {
+        sockaddr_un address {};
+        if (options.unixPath.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Socket path too long: " << options.unixPath << '\n';
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, options.unixPath.c_str(), options.unixPath.size() + 1);
+        unlink(options.unixPath.c_str());
+        int listenDescriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenDescriptor < 0 || bind(listenDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || listen(listenDescriptor, SOMAXCONN) != 0) {
+            std::cerr << "Failed to listen on " << options.unixPath << ": " << std::strerror(errno) << '\n';
+            if (listenDescriptor >= 0) close(listenDescriptor);
+            return false;
+        }
+        addListener(listenDescriptor);
+    }
+    return true;
+}
+
+void GameServer::AcceptConnections(int listenDescriptor) {
+    while (true) {
+        int fileDescriptor = accept4(listenDescriptor, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fileDescriptor < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) std::cerr << "accept failed: " << std::strerror(errno) << '\n';
+            return;
+        }
+
+        std::unique_ptr<GameBoard> gameBoard = boardPool.Acquire();
+        if (!gameBoard) {
+            const char refusal[] = "error server full\n";
+            [[maybe_unused]] ssize_t written = write(fileDescriptor, refusal, sizeof(refusal) - 1);
+            close(fileDescriptor);
+            continue;
+        }
+        int enable = 1;
+        setsockopt(fileDescriptor, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        gameBoard->LoadDefaultBoard();
+
+        uint64_t sessionId = nextSessionId++;
+        ServerSession& session = sessions[sessionId];
+        session.fileDescriptor = fileDescriptor;
+        session.gameBoard = std::move(gameBoard);
+        peakSessions = std::max(peakSessions, sessions.size());
+
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.u64 = sessionId;
+        epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event);
+    }
+}
+
+void GameServer::ReadSession(uint64_t sessionId) {
+    auto found = sessions.find(sessionId);
+    if (found == sessions.end()) return;
+    ServerSession& session = found->second;
+
+    char chunk[READ_CHUNK_SIZE];
+    while (true) {
+        ssize_t count = read(session.fileDescriptor, chunk, sizeof(chunk));
+        if (count > 0) {
+            session.readBuffer.append(chunk, count);
+            if (session.readBuffer.size() >= SERVER_MAX_BUFFERED_INPUT) break;
+            continue;
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (count < 0 && errno == EINTR) continue;
+        CloseSession(sessionId);
+        return;
+    }
+    ProcessLines(sessionId);
+}
+
+void GameServer::ProcessLines(uint64_t sessionId) {
+    auto found = sessions.find(sessionId);
+    if (found == sessions.end()) return;
+    ServerSession& session = found->second;
+
+    size_t start = 0;
+    while (!session.waitingForEngine && !session.closeAfterWrite && !session.outputFullSince.has_value()) {
+        size_t end = session.readBuffer.find('\n', start);
+        if (end == std::string::npos) break;
+        std::string line = session.readBuffer.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        HandleCommand(sessionId, session, line);
+        if (!sessions.contains(sessionId)) return;
+    }
+    session.readBuffer.erase(0, start);
+    // Either a line that never ends or more pipelined requests than a session may queue behind a search
+    bool overlongLine = session.readBuffer.size() > SERVER_MAX_LINE_LENGTH && session.readBuffer.find('\n') == std::string::npos;
+    if (overlongLine || session.readBuffer.size() >= SERVER_MAX_BUFFERED_INPUT) {
+        CloseSession(sessionId);
+        return;
+    }
+    // Idle sessions give their buffers back, ten thousand of them should cost little more than their boards
+    if (session.readBuffer.empty()) session.readBuffer.shrink_to_fit();
+}
+
+void GameServer::HandleCommand(uint64_t sessionId, ServerSession &session, const std::string &line) {
+    std::istringstream arguments(line);
+    std::string command;
+    arguments >> command;
+
+    if (command.empty()) return;
+    if (command == "ping") {
+        Send(sessionId, session, "pong\n");
+    } else if (command == "new") {
+        std::string fen;
+        std::getline(arguments >> std::ws, fen);
+        if (fen.empty()) {
+            session.gameBoard->LoadDefaultBoard();
+        } else if (!session.gameBoard->LoadFen(fen)) {
+            session.gameBoard->LoadDefaultBoard();
+            Send(sessionId, session, "error invalid fen\n");
+            return;
+        }
+        Send(sessionId, session, "ok\n");
+    } else if (command == "move") {
+        std::string moveText;
+        arguments >> moveText;
+        std::optional<BoardMove> boardMove = ParseMove(moveText, session.gameBoard);
+        if (!boardMove.has_value()) {
+            Send(sessionId, session, "error illegal move " + moveText + "\n");
+            return;
+        }
+        session.gameBoard->ExecuteMove(boardMove->move, boardMove->from);
+        Send(sessionId, session, "ok\n");
+    } else if (command == "go") {
+        QueueEngineJob(sessionId, session, EngineRequest::Go, arguments);
+    } else if (command == "play") {
+        QueueEngineJob(sessionId, session, EngineRequest::Play, arguments);
+    } else if (command == "analyze") {
+        QueueEngineJob(sessionId, session, EngineRequest::Analyze, arguments);
+    } else if (command == "stats") {
+        Send(sessionId, session, GetStats() + "\n");
+    } else if (command == "quit") {
+        session.closeAfterWrite = true;
+        Send(sessionId, session, "bye\n");
+    } else {
+        Send(sessionId, session, "error unknown command " + command + "\n");
+    }
+}
+
+void GameServer::QueueEngineJob(uint64_t sessionId, ServerSession &session, EngineRequest request, std::istringstream &arguments) {
+    EngineJob job {sessionId, request, *session.gameBoard, SearchLimits{}, std::chrono::steady_clock::now()};
+    job.limits.nodes = options.nodeBudget;
+    if (request == EngineRequest::Analyze) {
+        job.limits.multiPv = 3;
+        arguments >> job.limits.multiPv;
+        job.limits.multiPv = std::clamp(job.limits.multiPv, 1, 16);
+        arguments.clear();
+    }
+    std::string key;
+    uint64_t value;
+    while (arguments >> key >> value) {
+        // Clients can ask for less than the budget, never more
+        if (key == "nodes") job.limits.nodes = std::min<uint64_t>(std::max<uint64_t>(value, 1), options.nodeBudget);
+        if (key == "depth") job.limits.depth = static_cast<int>(std::min<uint64_t>(value, MAX_SEARCH_PLY));
+    }
+    if (options.sessionNodeBudget != 0) {
+        if (session.nodesUsed >= options.sessionNodeBudget) {
+            Send(sessionId, session, "error node budget spent\n");
+            return;
+        }
+        job.limits.nodes = std::min(job.limits.nodes, options.sessionNodeBudget - session.nodesUsed);
+    }
+
+    {
+        std::lock_guard lock(jobMutex);
+        if (jobs.size() >= options.queueCapacity) {
+            rejectedRequests++;
+            Send(sessionId, session, "error busy\n");
+            return;
+        }
+        jobs.push_back(std::move(job));
+    }
+    jobReady.notify_one();
+    session.waitingForEngine = true;
+    UpdateInterest(sessionId, session);
+}
+
+void GameServer::DeliverReplies() {
+    std::vector<EngineReply> delivered;
+    {
+        std::lock_guard lock(replyMutex);
+        delivered.swap(replies);
+    }
+
+    for (const EngineReply& reply : delivered) {
+        auto found = sessions.find(reply.sessionId);
+        // The client left while its search ran
+        if (found == sessions.end()) continue;
+        ServerSession& session = found->second;
+        session.waitingForEngine = false;
+        session.nodesUsed += reply.result.nodes;
+        WriteReply(session, reply);
+        FlushSession(reply.sessionId, session);
+
+        double latencyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reply.queuedTime).count();
+        if (latencies.size() < SERVER_LATENCY_WINDOW) {
+            latencies.push_back(latencyMs);
+        } else {
+            latencies[completedRequests % SERVER_LATENCY_WINDOW] = latencyMs;
+        }
+        completedRequests++;
+        ProcessLines(reply.sessionId);
+    }
+}
+
+void GameServer::WriteReply(ServerSession &session, const EngineReply &reply) {
+    const SearchResult& result = reply.result;
+    std::ostringstream text;
+    if (reply.request == EngineRequest::Analyze) {
+        for (size_t i = 0; i < result.lines.size(); i++) {
+            text << "info multipv " << i + 1 << " score " << result.lines[i].score << " pv";
+            for (const BoardMove& boardMove : result.lines[i].moves) {
+                text << ' ' << Notation::GetMoveName(boardMove);
+            }
+            text << '\n';
+        }
+    }
+    if (!result.bestMove.has_value()) {
+        text << "bestmove none\n";
+    } else {
+        text << "bestmove " << Notation::GetMoveName(result.bestMove.value()) << " score " << result.score << " depth " << result.depth
+             << " nodes " << result.nodes << '\n';
+        if (reply.request == EngineRequest::Play) {
+            session.gameBoard->ExecuteMove(result.bestMove->move, result.bestMove->from);
+        }
+    }
+    session.writeBuffer += text.str();
+}
+
+void GameServer::Send(uint64_t sessionId, ServerSession &session, const std::string &text) {
+    session.writeBuffer += text;
+    FlushSession(sessionId, session);
+}
+
+void GameServer::FlushSession(uint64_t sessionId, ServerSession &session) {
+    size_t written = 0;
+    while (written < session.writeBuffer.size()) {
+        ssize_t count = write(session.fileDescriptor, session.writeBuffer.data() + written, session.writeBuffer.size() - written);
+        if (count > 0) {
+            written += count;
+            continue;
+        }
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        CloseSession(sessionId);
+        return;
+    }
+    session.writeBuffer.erase(0, written);
+
+    if (session.writeBuffer.empty()) {
+        session.writeBuffer.shrink_to_fit();
+        if (session.closeAfterWrite) {
+            CloseSession(sessionId);
+            return;
+        }
+    }
+    UpdateInterest(sessionId, session);
+}
+
+void GameServer::UpdateInterest(uint64_t sessionId, ServerSession &session) {
+    bool outputFull = session.writeBuffer.size() > SERVER_MAX_BUFFERED_OUTPUT;
+    if (outputFull != session.outputFullSince.has_value()) {
+        if (outputFull) {
+            session.outputFullSince = std::chrono::steady_clock::now();
+            fullSessions++;
+        } else {
+            session.outputFullSince.reset();
+            fullSessions--;
+        }
+    }
+
+    // Level triggered, so writes are only watched while something is waiting to go out. Reads stop while a search
+    // runs or replies pile up unread, leaving the client's input in its socket rather than in server memory
+    bool watchReads = !session.waitingForEngine && !outputFull;
+    bool watchWrites = !session.writeBuffer.empty();
+    if (session.watchingReads == watchReads && session.watchingWrites == watchWrites) return;
+    session.watchingReads = watchReads;
+    session.watchingWrites = watchWrites;
+
+    uint32_t events = 0;
+    if (watchReads) events |= EPOLLIN;
+    if (watchWrites) events |= EPOLLOUT;
+    epoll_event event {};
+    event.events = events;
+    event.data.u64 = sessionId;
+    epoll_ctl(epollDescriptor, EPOLL_CTL_MOD, session.fileDescriptor, &event);
+}
+
+void GameServer::DropStalledSessions() {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<uint64_t> stalled;
+    for (const auto& [sessionId, session] : sessions) {
+        if (session.outputFullSince.has_value() && now - session.outputFullSince.value() >= SERVER_OUTPUT_STALL_TIMEOUT) {
+            stalled.push_back(sessionId);
+        }
+    }
+    for (uint64_t sessionId : stalled) {
+        CloseSession(sessionId);
+    }
+}
+
+void GameServer::CloseSession(uint64_t sessionId) {
+    auto found = sessions.find(sessionId);
+    if (found == sessions.end()) return;
+    if (found->second.outputFullSince.has_value()) fullSessions--;
+    epoll_ctl(epollDescriptor, EPOLL_CTL_DEL, found->second.fileDescriptor, nullptr);
+    close(found->second.fileDescriptor);
+    boardPool.Release(std::move(found->second.gameBoard));
+    sessions.erase(found);
+}
+
+std::string GameServer::GetStats() {
+    size_t queued;
+    {
+        std::lock_guard lock(jobMutex);
+        queued = jobs.size();
+    }
+    std::vector<double> sorted = latencies;
+    auto percentile = [&sorted](double fraction) {
+        if (sorted.empty()) return 0.0;
+        size_t index = std::min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()));
+        std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    };
+
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2) << "stats sessions " << sessions.size() << " peak_sessions " << peakSessions
+         << " free_boards " << boardPool.GetFreeCount() << " queued " << queued << " completed " << completedRequests
+         << " rejected " << rejectedRequests << " p50_ms " << percentile(0.5) << " p99_ms " << percentile(0.99)
+         << " rss_mb " << GetResidentMb();
+    return text.str();
+}
+
+void GameServer::RunWorker() {
+    Searcher searcher;
+    searcher.SetHashSize(options.hashMb);
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    while (true) {
+        EngineJob job;
+        {
+            std::unique_lock lock(jobMutex);
+            jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        *gameBoard = job.gameBoard;
+        // Sessions are unrelated games, one session's entries would only mislead the next
+        searcher.ClearHash();
+        EngineReply reply {job.sessionId, job.request, searcher.Search(gameBoard, job.limits), job.queuedTime};
+        {
+            std::lock_guard lock(replyMutex);
+            replies.push_back(std::move(reply));
+        }
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = write(wakeDescriptor, &one, sizeof(one));
+    }
+}
+
+void GameServer::StopWorkers() {
+    {
+        std::lock_guard lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
@@ -0,0 +1,67 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/GameTracker.h"
+
+#include <algorithm>
+
+#include "../include/Zobrist.h"
+
+void GameTracker::Reset(const GameBoard &gameBoard) {
+    keys.clear();
+    Push(gameBoard);
+}
+
+void GameTracker::Push(const GameBoard &gameBoard) {
+    keys.push_back(Zobrist::ComputeKey(gameBoard, Zobrist::GetEngineKeys()));
+}
+
+std::optional<GameEnd> GameTracker::GetGameEnd(const std::unique_ptr<GameBoard> &gameBoard, BoardMoveQuery &moveQuery) const {
+    PieceColor sideToMove = gameBoard->GetSideToMove();
+    bool whiteToMove = sideToMove == PieceColor::White;
+
+    MoveSearcher::GetLegalMoves(moveQuery, *gameBoard);
+    if (moveQuery.moveCount == 0) {
+        if (MoveSearcher::IsInCheck(sideToMove, *gameBoard)) {
+            return GameEnd{whiteToMove ? GameResult::BlackWins : GameResult::WhiteWins, whiteToMove ? "Black mates" : "White mates"};
+        }
+        return GameEnd{GameResult::Draw, "Stalemate"};
+    }
+    if (gameBoard->GetHalfmoveClock() >= FIFTY_MOVE_PLIES) {
+        return GameEnd{GameResult::Draw, "Fifty-move rule"};
+    }
+    if (GetRepetitions(*gameBoard) >= 3) {
+        return GameEnd{GameResult::Draw, "Threefold repetition"};
+    }
+    if (IsInsufficientMaterial(*gameBoard)) {
+        return GameEnd{GameResult::Draw, "Insufficient material"};
+    }
+    return std::nullopt;
+}
+
+int GameTracker::GetRepetitions(const GameBoard &gameBoard) const {
+    if (keys.empty()) return 0;
+
+    // Only positions since the last irreversible move with the same side to move can repeat
+    int repetitions = 0;
+    int oldest = std::max(0, static_cast<int>(keys.size()) - 1 - gameBoard.GetHalfmoveClock());
+    for (int i = static_cast<int>(keys.size()) - 1; i >= oldest; i -= 2) {
+        if (keys[i] == keys.back()) repetitions++;
+    }
+    return repetitions;
+}
+
+bool GameTracker::IsInsufficientMaterial(const GameBoard &gameBoard) {
+    // Bare kings, or a single bishop or knight against a bare king
+    int minorPieces = 0;
+    for (short row = 0; row < GRID_SIZE; row++) {
+        for (short col = 0; col < GRID_SIZE; col++) {
+            PieceType type = gameBoard.GetPiece(PiecePosition{row, col}).type;
+            if (type == PieceType::None || type == PieceType::King) continue;
+            if (type != PieceType::Bishop && type != PieceType::Knight) return false;
+            if (++minorPieces > 1) return false;
+        }
+    }
+    return true;
+}
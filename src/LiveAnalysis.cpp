@@ -0,0 +1,88 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/LiveAnalysis.h"
+
+#include <string>
+
+#include "../include/ArgParse.h"
+
+bool LiveAnalysisOptions::ParseArgs(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--analyze" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], multiPv)) return false;
+        } else if (arg == "--cache" && hasValue) {
+            cachePath = argv[++i];
+        } else if (arg == "--cache-size" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], cacheSizeMb)) return false;
+        }
+    }
+    return true;
+}
+
+LiveAnalysis::LiveAnalysis(LiveAnalysisOptions options) : options(std::move(options)), searchBoard(std::make_unique<GameBoard>()) {
+    if (IsEnabled() && !this->options.cachePath.empty() && analysisCache.Open(this->options.cachePath, this->options.cacheSizeMb)) {
+        searcher.SetAnalysisCache(&analysisCache);
+    }
+}
+
+LiveAnalysis::~LiveAnalysis() {
+    Stop();
+}
+
+bool LiveAnalysis::IsEnabled() const {
+    return options.multiPv > 0;
+}
+
+void LiveAnalysis::Update(const PositionPublisher &positionPublisher) {
+    if (!IsEnabled()) return;
+    PositionSnapshot snapshot = positionPublisher.Load();
+    if (snapshot.version == positionVersion) return;
+    positionVersion = snapshot.version;
+
+    Stop();
+    // Clears the arrows of the old position straight away
+    Publish(SearchResult{}, true);
+    *searchBoard = snapshot.position;
+    stopSignal = false;
+
+    SearchLimits limits;
+    limits.multiPv = options.multiPv;
+    limits.stopSignal = &stopSignal;
+    limits.onProgress = [this](const SearchResult &result) { Publish(result, false); };
+    searchThread = std::thread([this, limits] {
+        SearchResult result = searcher.Search(searchBoard, limits);
+        if (!stopSignal.load(std::memory_order_relaxed)) Publish(result, true);
+    });
+}
+
+std::optional<SearchResult> LiveAnalysis::PollResult() {
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastPoll < ANALYSIS_REFRESH_INTERVAL) return std::nullopt;
+
+    std::lock_guard lock(resultMutex);
+    if (latestVersion == polledVersion) return std::nullopt;
+    lastPoll = now;
+    polledVersion = latestVersion;
+    return latestResult;
+}
+
+void LiveAnalysis::Stop() {
+    stopSignal = true;
+    if (searchThread.joinable()) searchThread.join();
+}
+
+void LiveAnalysis::Publish(const SearchResult &result, bool wait) {
+    // Progress skips a line rather than stall while the GUI copies, the next line brings it up to date
+    std::unique_lock lock(resultMutex, std::defer_lock);
+    if (wait) {
+        lock.lock();
+    } else if (!lock.try_lock()) {
+        return;
+    }
+    latestResult = result;
+    latestVersion++;
+}
@@ -0,0 +1,64 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile & MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this == &other) return *this;
+    Close();
+    fileDescriptor = std::exchange(other.fileDescriptor, -1);
+    data = std::exchange(other.data, nullptr);
+    size = std::exchange(other.size, 0);
+    return *this;
+}
+
+bool MappedFile::Open(const std::string &path, MappedFileAccess access) {
+    Close();
+
+    fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0) return false;
+
+    struct stat fileStat {};
+    if (fstat(fileDescriptor, &fileStat) != 0) {
+        Close();
+        return false;
+    }
+    size = static_cast<size_t>(fileStat.st_size);
+    if (size == 0) return true; // mmap rejects empty ranges
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        Close();
+        return false;
+    }
+    data = mapping;
+    madvise(data, size, access == MappedFileAccess::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data != nullptr) {
+        munmap(data, size);
+        data = nullptr;
+    }
+    if (fileDescriptor >= 0) {
+        close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+    size = 0;
+}
@@ -0,0 +1,59 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+// MappedFile for platforms without mmap: the whole file is read into memory once
+
+#include "../include/MappedFile.h"
+
+#include <fstream>
+#include <new>
+#include <utility>
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile & MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this == &other) return *this;
+    Close();
+    fileDescriptor = std::exchange(other.fileDescriptor, -1);
+    data = std::exchange(other.data, nullptr);
+    size = std::exchange(other.size, 0);
+    return *this;
+}
+
+bool MappedFile::Open(const std::string &path, MappedFileAccess) {
+    Close();
+
+    std::ifstream input(path, std::ios::binary | std::ios::ate);
+    if (!input) return false;
+    std::streamoff length = input.tellg();
+    if (length < 0) return false;
+
+    // There is no descriptor to keep, 0 only marks an open empty file for IsOpen
+    fileDescriptor = 0;
+    size = static_cast<size_t>(length);
+    if (size == 0) return true;
+
+    data = ::operator new(size);
+    input.seekg(0);
+    if (!input.read(static_cast<char*>(data), static_cast<std::streamsize>(size))) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data != nullptr) {
+        ::operator delete(data);
+        data = nullptr;
+    }
+    fileDescriptor = -1;
+    size = 0;
+}
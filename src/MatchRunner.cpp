@@ -0,0 +1,430 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/MatchRunner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+#include "../include/ArgParse.h"
+#include "../include/Notation.h"
+#include "../include/PgnReader.h"
+#include "../include/ThreadPool.h"
+
+namespace {
+    double GetExpectedScore(double elo) {
+        return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+    }
+
+    const char* GetResultToken(GameResult result) {
+        switch (result) {
+            case GameResult::WhiteWins:
+                return "1-0";
+            case GameResult::BlackWins:
+                return "0-1";
+            default:
+                return "1/2-1/2";
+        }
+    }
+}
+
+bool EngineConfig::Parse(const std::string &spec) {
+    std::istringstream stream(spec);
+    std::string field;
+    while (std::getline(stream, field, ',')) {
+        size_t separator = field.find('=');
+        if (separator == std::string::npos) return false;
+        std::string key = field.substr(0, separator);
+        std::string value = field.substr(separator + 1);
+        try {
+            if (key == "name") {
+                name = value;
+            } else if (key == "depth") {
+                limits.depth = std::stoi(value);
+            } else if (key == "nodes") {
+                limits.nodes = std::stoull(value);
+            } else if (key == "movetime") {
+                limits.moveTimeMs = std::stoll(value);
+            } else if (key == "bitbases") {
+                bitbaseDirectory = value;
+            } else if (key == "book") {
+                bookPath = value;
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EngineConfig::HasLimit() const {
+    return limits.depth < MAX_SEARCH_PLY || limits.nodes > 0 || limits.moveTimeMs > 0;
+}
+
+double SprtOptions::GetLowerBound() const {
+    return std::log(beta / (1 - alpha));
+}
+
+double SprtOptions::GetUpperBound() const {
+    return std::log((1 - beta) / alpha);
+}
+
+bool MatchOptions::ParseArgs(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if ((arg == "--engine1" || arg == "--engine2") && hasValue) {
+            EngineConfig& engine = engines[arg == "--engine1" ? 0 : 1];
+            if (!engine.Parse(argv[++i])) std::cerr << "Ignoring invalid engine spec: " << argv[i] << '\n';
+        } else if (arg == "--tc" && hasValue) {
+            if (!timeControl.Parse(argv[++i])) std::cerr << "Ignoring invalid time control: " << argv[i] << '\n';
+        } else if (arg == "--move-overhead" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], timeControl.moveOverheadMs)) return false;
+        } else if (arg == "--openings" && hasValue) {
+            openingsPath = argv[++i];
+        } else if (arg == "--opening-plies" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], openingPlies)) return false;
+        } else if (arg == "--games" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], games)) return false;
+        } else if (arg == "--pgn" && hasValue) {
+            pgnPath = argv[++i];
+        } else if (arg == "--book-keys" && hasValue) {
+            bookKeysPath = argv[++i];
+        } else if (arg == "--sprt" && hasValue) {
+            // elo0,elo1 as in fishtest
+            std::string bounds = argv[++i];
+            size_t separator = bounds.find(',');
+            if (separator == std::string::npos) {
+                std::cerr << "Ignoring invalid SPRT bounds: " << bounds << '\n';
+                continue;
+            }
+            std::string_view boundsView = bounds;
+            if (!ParseNumber(arg, boundsView.substr(0, separator), sprt.elo0)) return false;
+            if (!ParseNumber(arg, boundsView.substr(separator + 1), sprt.elo1)) return false;
+            sprt.enabled = true;
+        } else if (arg == "--alpha" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], sprt.alpha)) return false;
+        } else if (arg == "--beta" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], sprt.beta)) return false;
+        }
+    }
+    return true;
+}
+
+double MatchScore::GetEloDifference() const {
+    uint64_t games = wins + draws + losses;
+    if (games == 0) return 0;
+    double points = (wins + draws * 0.5) / games;
+    points = std::clamp(points, 1e-3, 1 - 1e-3);
+    return -400.0 * std::log10(1.0 / points - 1.0);
+}
+
+double MatchScore::GetLogLikelihoodRatio(double elo0, double elo1) const {
+    uint64_t pairCount = 0;
+    for (uint64_t count : pairs) pairCount += count;
+    if (pairCount == 0) return 0;
+
+    // Normal approximation of the GSPRT on pair scores 0, 1/4, ..., 1
+    double mean = 0;
+    for (int i = 0; i < 5; i++) mean += pairs[i] * (i / 4.0);
+    mean /= pairCount;
+    double variance = 0;
+    for (int i = 0; i < 5; i++) variance += pairs[i] * (i / 4.0 - mean) * (i / 4.0 - mean);
+    variance /= pairCount;
+    if (variance <= 0) return 0;
+
+    double score0 = GetExpectedScore(elo0);
+    double score1 = GetExpectedScore(elo1);
+    return pairCount * (score1 - score0) * (2 * mean - score0 - score1) / (2 * variance);
+}
+
+MatchRunner::MatchRunner(MatchOptions options) : options(std::move(options)) {
+    for (int i = 0; i < 2; i++) {
+        const std::string& directory = this->options.engines[i].bitbaseDirectory;
+        if (!directory.empty() && bitbases[i].LoadDirectory(directory) == 0) {
+            std::cerr << "No bitbases found in " << directory << '\n';
+        }
+        const std::string& bookPath = this->options.engines[i].bookPath;
+        if (!bookPath.empty()) books[i].Open(bookPath, this->options.bookKeysPath, true);
+    }
+}
+
+int MatchRunner::Run() {
+    for (const EngineConfig& engine : options.engines) {
+        if (!options.timeControl.IsEnabled() && !engine.HasLimit()) {
+            std::cerr << engine.name << " has no depth, node or time limit and --tc is 0\n";
+            return 1;
+        }
+    }
+    if (!LoadOpenings()) return 1;
+    if (!options.pgnPath.empty()) {
+        pgnOutput.open(options.pgnPath);
+        if (!pgnOutput) {
+            std::cerr << "Failed to open PGN output: " << options.pgnPath << '\n';
+            return 1;
+        }
+    }
+
+    gamePoints.assign(options.games, -1);
+    ThreadPool& threadPool = ThreadPool::GetShared();
+    std::vector<std::unique_ptr<std::array<Searcher, 2>>> workerSearchers(threadPool.GetWorkerCount());
+    TaskGroup taskGroup(threadPool);
+    taskGroup.RunRange(std::max(options.games, 0), 1, [this, &workerSearchers, &taskGroup](uint64_t gameIndex, uint64_t) {
+        std::unique_ptr<std::array<Searcher, 2>>& searchers = workerSearchers[ThreadPool::GetWorkerIndex()];
+        if (!searchers) searchers = CreateSearchers();
+        if (RecordGame(PlayGame(*searchers, gameIndex))) taskGroup.Cancel();
+    });
+    taskGroup.Wait();
+
+    const std::string& first = options.engines[0].name;
+    const std::string& second = options.engines[1].name;
+    uint64_t games = score.wins + score.draws + score.losses;
+    std::cout << "Score of " << first << " vs " << second << ": " << score.wins << " - " << score.losses << " - " << score.draws
+              << " [" << (games > 0 ? (score.wins + score.draws * 0.5) / games : 0.0) << "] " << games << '\n';
+    std::cout << "Elo difference: " << score.GetEloDifference() << '\n';
+    if (options.sprt.enabled) {
+        double llr = score.GetLogLikelihoodRatio(options.sprt.elo0, options.sprt.elo1);
+        std::cout << "SPRT: llr " << llr << " (" << options.sprt.GetLowerBound() << ", " << options.sprt.GetUpperBound() << ") ";
+        if (llr >= options.sprt.GetUpperBound()) {
+            std::cout << "H1 accepted\n";
+        } else if (llr <= options.sprt.GetLowerBound()) {
+            std::cout << "H0 accepted\n";
+        } else {
+            std::cout << "inconclusive\n";
+        }
+    }
+    return 0;
+}
+
+bool MatchRunner::LoadOpenings() {
+    if (options.openingsPath.empty()) return true;
+
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    const std::string& path = options.openingsPath;
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".pgn") == 0) {
+        PgnReader pgnReader;
+        if (!pgnReader.Open(path)) {
+            std::cerr << "Failed to open openings: " << path << '\n';
+            return false;
+        }
+        // One reader thread keeps the openings in file order
+        pgnReader.Read(1, [this](const PgnGame& game, const std::unique_ptr<GameBoard>&) {
+            MatchOpening opening{std::string(game.GetTag("FEN"))};
+            size_t plies = std::min<size_t>(game.moves.size(), std::max(0, options.openingPlies));
+            opening.moves.assign(game.moves.begin(), game.moves.begin() + plies);
+            if (!opening.fen.empty() || !opening.moves.empty()) openings.push_back(std::move(opening));
+        });
+    } else {
+        std::ifstream input(path);
+        if (!input) {
+            std::cerr << "Failed to open openings: " << path << '\n';
+            return false;
+        }
+        std::string line;
+        while (std::getline(input, line)) {
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') continue;
+            // EPD operations follow the four board fields, the clocks are kept only when present
+            std::istringstream fields(line);
+            std::string field, fen;
+            for (int i = 0; i < 6 && fields >> field; i++) {
+                bool isClock = !field.empty() && std::all_of(field.begin(), field.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); });
+                if (i >= 4 && !isClock) break;
+                fen += (i > 0 ? " " : "") + field;
+            }
+            if (!gameBoard->LoadFen(fen)) {
+                std::cerr << "Skipping invalid opening: " << line << '\n';
+                continue;
+            }
+            openings.push_back(MatchOpening{std::move(fen)});
+        }
+    }
+
+    if (openings.empty()) {
+        std::cerr << "No openings in " << path << '\n';
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<std::array<Searcher, 2>> MatchRunner::CreateSearchers() const {
+    auto searchers = std::make_unique<std::array<Searcher, 2>>();
+    for (int i = 0; i < 2; i++) {
+        if (!bitbases[i].IsEmpty()) (*searchers)[i].SetBitbases(&bitbases[i]);
+    }
+    return searchers;
+}
+
+GameRecord MatchRunner::PlayGame(std::array<Searcher, 2> &searchers, uint64_t gameIndex) const {
+    GameRecord gameRecord;
+    gameRecord.round = gameIndex + 1;
+    // Both games of a pair play the same opening, the first engine takes white in the even one
+    gameRecord.whiteEngine = static_cast<int>(gameIndex % 2);
+    for (Searcher& searcher : searchers) {
+        searcher.ClearHash();
+    }
+
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    const MatchOpening* opening = openings.empty() ? nullptr : &openings[(gameIndex / 2) % openings.size()];
+    if (opening != nullptr && !opening->fen.empty()) {
+        gameBoard->LoadFen(opening->fen);
+        gameRecord.fen = opening->fen;
+    } else {
+        gameBoard->LoadDefaultBoard();
+    }
+
+    GameTracker gameTracker;
+    gameTracker.Reset(*gameBoard);
+    if (opening != nullptr) {
+        for (const BoardMove& boardMove : opening->moves) {
+            gameRecord.sanMoves.push_back(Notation::GetSanName(boardMove, gameBoard));
+            gameBoard->ExecuteMove(boardMove.move, boardMove.from);
+            gameTracker.Push(*gameBoard);
+        }
+    }
+
+    const TimeControl& timeControl = options.timeControl;
+    std::array<int64_t, 2> clocks {timeControl.baseMs, timeControl.baseMs};
+    std::array<int, 2> movesMade {};
+    BoardMoveQuery moveQuery;
+    while (true) {
+        if (std::optional<GameEnd> gameEnd = gameTracker.GetGameEnd(gameBoard, moveQuery)) {
+            gameRecord.result = gameEnd->result;
+            gameRecord.reason = gameEnd->reason;
+            break;
+        }
+        if (gameRecord.sanMoves.size() >= MATCH_MAX_PLIES) {
+            gameRecord.reason = "Adjudicated after " + std::to_string(MATCH_MAX_PLIES) + " plies";
+            break;
+        }
+
+        bool whiteToMove = gameBoard->GetSideToMove() == PieceColor::White;
+        int engine = whiteToMove ? gameRecord.whiteEngine : 1 - gameRecord.whiteEngine;
+        SearchLimits limits = options.engines[engine].limits;
+        int64_t& clock = clocks[whiteToMove ? 0 : 1];
+        int& moves = movesMade[whiteToMove ? 0 : 1];
+        limits.clock = timeControl.GetClock(clock, moves);
+
+        auto moveStart = std::chrono::steady_clock::now();
+        // Book moves are played instantly, the best weighted one so a pair of games stays reproducible
+        std::optional<BoardMove> bookMove = books[engine].Probe(gameBoard, BookSelection::BestWeight);
+        SearchResult searchResult;
+        if (!bookMove.has_value()) searchResult = searchers[engine].Search(gameBoard, limits);
+        int64_t elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - moveStart).count();
+        if (timeControl.IsEnabled() && !timeControl.OnMoveMade(clock, elapsedMs, moves++)) {
+            gameRecord.result = whiteToMove ? GameResult::BlackWins : GameResult::WhiteWins;
+            gameRecord.reason = whiteToMove ? "White loses on time" : "Black loses on time";
+            gameRecord.timeForfeit = true;
+            break;
+        }
+
+        const BoardMove boardMove = bookMove.value_or(searchResult.bestMove.value_or(moveQuery.moves[0]));
+        gameRecord.sanMoves.push_back(Notation::GetSanName(boardMove, gameBoard));
+        gameBoard->ExecuteMove(boardMove.move, boardMove.from);
+        gameTracker.Push(*gameBoard);
+    }
+    return gameRecord;
+}
+
+bool MatchRunner::RecordGame(const GameRecord &gameRecord) {
+    std::lock_guard lock(resultMutex);
+
+    bool firstIsWhite = gameRecord.whiteEngine == 0;
+    int8_t points = 1;
+    if (gameRecord.result == GameResult::WhiteWins) points = firstIsWhite ? 2 : 0;
+    if (gameRecord.result == GameResult::BlackWins) points = firstIsWhite ? 0 : 2;
+    if (points == 2) score.wins++;
+    if (points == 1) score.draws++;
+    if (points == 0) score.losses++;
+
+    uint64_t gameIndex = gameRecord.round - 1;
+    gamePoints[gameIndex] = points;
+    uint64_t partnerIndex = gameIndex ^ 1;
+    if (partnerIndex < gamePoints.size() && gamePoints[partnerIndex] >= 0) {
+        score.pairs[points + gamePoints[partnerIndex]]++;
+    }
+
+    if (pgnOutput.is_open()) {
+        pgnOutput << GetPgn(gameRecord) << '\n';
+        pgnOutput.flush();
+    }
+
+    std::cerr << "Game " << gameRecord.round << " " << GetResultToken(gameRecord.result) << " {" << gameRecord.reason << "}"
+              << " score +" << score.wins << " =" << score.draws << " -" << score.losses;
+    bool decided = false;
+    if (options.sprt.enabled) {
+        double llr = score.GetLogLikelihoodRatio(options.sprt.elo0, options.sprt.elo1);
+        std::cerr << " llr " << llr;
+        decided = llr >= options.sprt.GetUpperBound() || llr <= options.sprt.GetLowerBound();
+    }
+    std::cerr << '\n';
+    return decided;
+}
+
+std::string MatchRunner::GetPgn(const GameRecord &gameRecord) const {
+    const std::string& white = options.engines[gameRecord.whiteEngine].name;
+    const std::string& black = options.engines[1 - gameRecord.whiteEngine].name;
+
+    char date[16] = "????.??.??";
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y.%m.%d", std::gmtime(&now));
+
+    std::ostringstream pgn;
+    pgn << "[Event \"Self-play\"]\n"
+        << "[Site \"?\"]\n"
+        << "[Date \"" << date << "\"]\n"
+        << "[Round \"" << gameRecord.round << "\"]\n"
+        << "[White \"" << white << "\"]\n"
+        << "[Black \"" << black << "\"]\n"
+        << "[Result \"" << GetResultToken(gameRecord.result) << "\"]\n";
+
+    int moveNumber = 1;
+    bool blackToMove = false;
+    if (!gameRecord.fen.empty()) {
+        pgn << "[SetUp \"1\"]\n[FEN \"" << gameRecord.fen << "\"]\n";
+        std::istringstream fields(gameRecord.fen);
+        std::string placement, side, castling, enPassant;
+        int halfmoves = 0;
+        fields >> placement >> side >> castling >> enPassant >> halfmoves >> moveNumber;
+        moveNumber = std::max(1, moveNumber);
+        blackToMove = side == "b";
+    }
+    if (options.timeControl.IsEnabled()) {
+        pgn << "[TimeControl \"" << options.timeControl.ToString() << "\"]\n";
+    }
+    pgn << "[PlyCount \"" << gameRecord.sanMoves.size() << "\"]\n"
+        << "[Termination \"" << (gameRecord.timeForfeit ? "time forfeit" : "normal") << "\"]\n\n";
+
+    std::string line;
+    auto append = [&pgn, &line](const std::string& token) {
+        if (!line.empty() && line.size() + token.size() + 1 > 79) {
+            pgn << line << '\n';
+            line.clear();
+        }
+        if (!line.empty()) line += ' ';
+        line += token;
+    };
+
+    for (size_t i = 0; i < gameRecord.sanMoves.size(); i++) {
+        if (!blackToMove) {
+            append(std::to_string(moveNumber) + '.');
+        } else if (i == 0) {
+            append(std::to_string(moveNumber) + "...");
+        }
+        append(gameRecord.sanMoves[i]);
+        if (blackToMove) moveNumber++;
+        blackToMove = !blackToMove;
+    }
+    append('{' + gameRecord.reason + '}');
+    append(GetResultToken(gameRecord.result));
+    pgn << line << '\n';
+    return pgn.str();
+}
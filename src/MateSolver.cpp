@@ -0,0 +1,349 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/MateSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "../include/ArgParse.h"
+#include "../include/Notation.h"
+
+namespace {
+    uint32_t AddSaturated(uint32_t a, uint32_t b) {
+        return std::min(a + b, PROOF_INFINITY);
+    }
+
+    ProofNumbers GetProven(int depth) {
+        return {0, PROOF_INFINITY, depth};
+    }
+
+    ProofNumbers GetDisproven(int depth) {
+        return {PROOF_INFINITY, 0, depth};
+    }
+}
+
+bool MateSolverOptions::ParseArgs(int argc, char **argv) {
+    // argv[1] is the command, the FEN is the one argument without a flag
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--moves" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], maxMoves)) return false;
+        } else if (arg == "--hash" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], tableMb)) return false;
+        } else if (arg == "--nodes" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], nodes)) return false;
+        } else if (!arg.starts_with("--")) {
+            fen = arg;
+        }
+    }
+    return true;
+}
+
+void ProofTable::Resize(size_t megabytes) {
+    size_t bucketCount = std::max<size_t>(megabytes, 1) * 1024 * 1024 / (sizeof(ProofEntry) * BUCKET_SIZE);
+    size_t powerOfTwo = 1;
+    while (powerOfTwo * 2 <= bucketCount) {
+        powerOfTwo *= 2;
+    }
+    entries.assign(powerOfTwo * BUCKET_SIZE, ProofEntry{});
+    bucketMask = powerOfTwo - 1;
+    used = 0;
+}
+
+void ProofTable::Clear() {
+    std::fill(entries.begin(), entries.end(), ProofEntry{});
+    used = 0;
+}
+
+const ProofEntry* ProofTable::Probe(uint64_t key, int depth) const {
+    const ProofEntry* bucket = &entries[(key & bucketMask) * BUCKET_SIZE];
+    const ProofEntry* open = nullptr;
+    for (int i = 0; i < BUCKET_SIZE; i++) {
+        const ProofEntry& entry = bucket[i];
+        if (entry.key != key) continue;
+        // A mate in fewer moves is still a mate, and no mate in more moves rules out fewer
+        if (entry.proofNumber == 0 && entry.depth <= depth) return &entry;
+        if (entry.disproofNumber == 0 && entry.depth >= depth) return &entry;
+        if (entry.proofNumber != 0 && entry.disproofNumber != 0 && entry.depth == depth) open = &entry;
+    }
+    return open;
+}
+
+void ProofTable::Store(uint64_t key, int depth, uint32_t proofNumber, uint32_t disproofNumber, uint32_t work) {
+    ProofEntry* bucket = &entries[(key & bucketMask) * BUCKET_SIZE];
+    ProofEntry* target = nullptr;
+    for (int i = 0; i < BUCKET_SIZE && !target; i++) {
+        if (bucket[i].key == key && bucket[i].depth == depth) target = &bucket[i];
+    }
+    for (int i = 0; i < BUCKET_SIZE && !target; i++) {
+        if (bucket[i].key == 0) {
+            target = &bucket[i];
+            used++;
+        }
+    }
+    if (!target) {
+        target = std::min_element(bucket, bucket + BUCKET_SIZE, [](const ProofEntry &a, const ProofEntry &b) {
+            return a.work < b.work;
+        });
+    }
+    *target = ProofEntry{key, proofNumber, disproofNumber, work, static_cast<uint16_t>(depth)};
+
+    if (used > entries.size() / 4 * 3) CollectGarbage();
+}
+
+void ProofTable::CollectGarbage() {
+    // Cheap entries are quick to find again. The threshold only grows, so each sweep frees a good share at once
+    while (used > entries.size() / 2) {
+        for (ProofEntry& entry : entries) {
+            if (entry.key == 0 || entry.work > collectThreshold) continue;
+            entry = ProofEntry{};
+            used--;
+        }
+        if (used > entries.size() / 2) collectThreshold = std::min(collectThreshold * 2, PROOF_INFINITY);
+    }
+}
+
+MateSolver::MateSolver(MateSolverOptions options) : options(std::move(options)) {
+    this->options.maxMoves = std::clamp(this->options.maxMoves, 1, MATE_SOLVER_MAX_MOVES);
+    table.Resize(this->options.tableMb);
+}
+
+int MateSolver::Run() {
+    if (options.fen.empty()) {
+        std::cerr << "Usage: ChessEngine mate <fen> [--moves N] [--hash MB] [--nodes N]\n";
+        return 1;
+    }
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    if (!gameBoard->LoadFen(options.fen)) {
+        std::cerr << "Invalid FEN: " << options.fen << '\n';
+        return 1;
+    }
+
+    MateSolverResult result = Solve(gameBoard, options.maxMoves);
+    uint64_t nodesPerSecond = result.nodes * 1000 / std::max<int64_t>(result.timeMs, 1);
+    if (result.mate) {
+        std::cout << "mate " << result.moves;
+    } else {
+        std::cout << (stopped ? "unknown within " : "no mate within ") << options.maxMoves;
+    }
+    std::cout << " nodes " << result.nodes << " time_ms " << result.timeMs << " nps " << nodesPerSecond << '\n';
+    if (result.mate) {
+        std::cout << "pv";
+        for (const BoardMove& boardMove : result.line) {
+            std::cout << ' ' << Notation::GetMoveName(boardMove);
+        }
+        std::cout << '\n';
+    }
+    return 0;
+}
+
+MateSolverResult MateSolver::Solve(const std::unique_ptr<GameBoard> &gameBoard, int maxMoves) {
+    auto startTime = std::chrono::steady_clock::now();
+    MateSolverResult result;
+    maxMoves = std::clamp(maxMoves, 1, MATE_SOLVER_MAX_MOVES);
+    // The attacker and the defender each move maxMoves times, plus one board for generating the last children
+    size_t plies = static_cast<size_t>(maxMoves) * 2 + 1;
+    while (boardStack.size() < plies) {
+        boardStack.push_back(std::make_unique<GameBoard>());
+    }
+    frames.resize(std::max(frames.size(), plies));
+    pathKeys.resize(std::max(pathKeys.size(), plies));
+
+    nodes = 0;
+    nodeLimit = options.nodes;
+    stopped = false;
+    *boardStack[0] = *gameBoard;
+    pathKeys[0] = Zobrist::ComputeKey(*gameBoard, Zobrist::GetEngineKeys());
+
+    // Disproofs carry over to the next length, so the shorter tries are mostly paid for again
+    for (int moves = 1; moves <= maxMoves && !stopped; moves++) {
+        ProofNumbers numbers = SearchNode(0, moves, PROOF_INFINITY, PROOF_INFINITY);
+        if (numbers.proofNumber == 0) {
+            result.mate = true;
+            result.moves = numbers.depth;
+            break;
+        }
+    }
+    result.nodes = nodes;
+    if (result.mate) result.line = GetMatingLine(gameBoard, result.moves);
+    result.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    return result;
+}
+
+ProofNumbers MateSolver::SearchNode(int ply, int depth, uint32_t proofThreshold, uint32_t disproofThreshold) {
+    nodes++;
+    if (nodeLimit > 0 && nodes >= nodeLimit) stopped = true;
+    uint64_t startNodes = nodes;
+
+    ProofNumbers numbers{};
+    if (!GenerateChildren(ply, depth, numbers)) {
+        table.Store(pathKeys[ply], numbers.depth, numbers.proofNumber, numbers.disproofNumber, 1);
+        return numbers;
+    }
+
+    std::vector<ChildNode>& children = frames[ply];
+    bool attackerToMove = IsAttackerToMove(ply);
+    int childDepth = attackerToMove ? depth - 1 : depth;
+    while (true) {
+        numbers = GetNodeNumbers(ply, depth);
+        if (numbers.proofNumber >= proofThreshold || numbers.disproofNumber >= disproofThreshold || stopped) break;
+
+        // The attacker follows the child closest to a proof and the defender the one closest to a refutation.
+        // The runner-up bounds how long the chosen child is searched before the choice is looked at again
+        size_t best = 0;
+        uint32_t bestValue = UINT32_MAX;
+        uint32_t secondValue = UINT32_MAX;
+        for (size_t i = 0; i < children.size(); i++) {
+            uint32_t value = attackerToMove ? children[i].numbers.proofNumber : children[i].numbers.disproofNumber;
+            if (value < bestValue) {
+                secondValue = bestValue;
+                bestValue = value;
+                best = i;
+            } else if (value < secondValue) {
+                secondValue = value;
+            }
+        }
+        secondValue = std::min(secondValue, PROOF_INFINITY);
+
+        ChildNode& child = children[best];
+        uint32_t childProofThreshold;
+        uint32_t childDisproofThreshold;
+        if (attackerToMove) {
+            childProofThreshold = std::min(proofThreshold, secondValue + 1);
+            childDisproofThreshold = disproofThreshold - numbers.disproofNumber + child.numbers.disproofNumber;
+        } else {
+            childProofThreshold = proofThreshold - numbers.proofNumber + child.numbers.proofNumber;
+            childDisproofThreshold = std::min(disproofThreshold, secondValue + 1);
+        }
+
+        *boardStack[ply + 1] = *boardStack[ply];
+        boardStack[ply + 1]->ExecuteMove(child.move.move, child.move.from);
+        pathKeys[ply + 1] = child.key;
+        child.numbers = SearchNode(ply + 1, childDepth, childProofThreshold, childDisproofThreshold);
+    }
+
+    uint32_t work = static_cast<uint32_t>(std::min<uint64_t>(nodes - startNodes + 1, PROOF_INFINITY));
+    table.Store(pathKeys[ply], numbers.depth, numbers.proofNumber, numbers.disproofNumber, work);
+    return numbers;
+}
+
+bool MateSolver::GenerateChildren(int ply, int depth, ProofNumbers &numbers) {
+    std::vector<ChildNode>& children = frames[ply];
+    children.clear();
+    const std::unique_ptr<GameBoard>& gameBoard = boardStack[ply];
+    const std::unique_ptr<GameBoard>& nextBoard = boardStack[ply + 1];
+    PieceColor color = gameBoard->GetSideToMove();
+    bool attackerToMove = IsAttackerToMove(ply);
+    int childDepth = attackerToMove ? depth - 1 : depth;
+
+    BoardMoveQuery moveQuery;
+    MoveSearcher::GetAllMoves(moveQuery, *gameBoard);
+    for (int i = 0; i < moveQuery.moveCount; i++) {
+        const BoardMove& boardMove = moveQuery.moves[i];
+        *nextBoard = *gameBoard;
+        nextBoard->ExecuteMove(boardMove.move, boardMove.from);
+        if (MoveSearcher::IsInCheck(color, *nextBoard)) continue;
+        if (attackerToMove && !MoveSearcher::IsInCheck(nextBoard->GetSideToMove(), *nextBoard)) continue;
+        // Any escape refutes a defender out of time, no need to look at the rest
+        if (!attackerToMove && depth == 0) {
+            numbers = GetDisproven(depth);
+            return false;
+        }
+
+        uint64_t key = Zobrist::ComputeKey(*nextBoard, Zobrist::GetEngineKeys());
+        ProofNumbers childNumbers{1, 1, childDepth};
+        if (IsOnPath(key, ply)) {
+            childNumbers = GetDisproven(childDepth);
+        } else if (const ProofEntry* entry = table.Probe(key, childDepth)) {
+            childNumbers = {entry->proofNumber, entry->disproofNumber, entry->depth};
+        } else if (attackerToMove) {
+            // Checks leaving fewer replies come first, and a check with none is mate on the spot
+            BoardMoveQuery evasionQuery;
+            MoveSearcher::GetLegalMoves(evasionQuery, *nextBoard);
+            if (evasionQuery.moveCount == 0) {
+                childNumbers = GetProven(0);
+            } else if (childDepth == 0) {
+                childNumbers = GetDisproven(0);
+            } else {
+                childNumbers.proofNumber = static_cast<uint32_t>(evasionQuery.moveCount);
+            }
+        }
+        children.push_back({boardMove, key, childNumbers});
+    }
+
+    if (!children.empty()) return true;
+    if (attackerToMove || !MoveSearcher::IsInCheck(color, *gameBoard)) {
+        // Out of checks, or stalemate
+        numbers = GetDisproven(depth);
+    } else {
+        numbers = GetProven(0);
+    }
+    return false;
+}
+
+ProofNumbers MateSolver::GetNodeNumbers(int ply, int depth) const {
+    const std::vector<ChildNode>& children = frames[ply];
+    ProofNumbers numbers{0, 0, depth};
+    if (IsAttackerToMove(ply)) {
+        // One proven check is enough, the shortest one sets the mate length
+        numbers.proofNumber = PROOF_INFINITY;
+        int provenDepth = MATE_SOLVER_MAX_MOVES;
+        for (const ChildNode& child : children) {
+            numbers.proofNumber = std::min(numbers.proofNumber, child.numbers.proofNumber);
+            numbers.disproofNumber = AddSaturated(numbers.disproofNumber, child.numbers.disproofNumber);
+            if (child.numbers.proofNumber == 0) provenDepth = std::min(provenDepth, child.numbers.depth);
+        }
+        if (numbers.proofNumber == 0) numbers.depth = provenDepth + 1;
+    } else {
+        // Every evasion has to be proven, the longest one sets the mate length
+        numbers.disproofNumber = PROOF_INFINITY;
+        int provenDepth = 0;
+        for (const ChildNode& child : children) {
+            numbers.proofNumber = AddSaturated(numbers.proofNumber, child.numbers.proofNumber);
+            numbers.disproofNumber = std::min(numbers.disproofNumber, child.numbers.disproofNumber);
+            provenDepth = std::max(provenDepth, child.numbers.depth);
+        }
+        if (numbers.proofNumber == 0) numbers.depth = provenDepth;
+    }
+    return numbers;
+}
+
+std::vector<BoardMove> MateSolver::GetMatingLine(const std::unique_ptr<GameBoard> &gameBoard, int moves) {
+    // Searching a proven node again costs little with its children in the table, and proves any that were evicted.
+    // The attacker takes the quickest mate and the defender the slowest
+    std::vector<BoardMove> line;
+    nodeLimit = 0;
+    *boardStack[0] = *gameBoard;
+    pathKeys[0] = Zobrist::ComputeKey(*gameBoard, Zobrist::GetEngineKeys());
+    int depth = moves;
+    for (int ply = 0; ply + 1 < static_cast<int>(boardStack.size()); ply++) {
+        ProofNumbers numbers = SearchNode(ply, depth, PROOF_INFINITY, PROOF_INFINITY);
+        const std::vector<ChildNode>& children = frames[ply];
+        if (numbers.proofNumber != 0 || children.empty()) break;
+
+        bool attackerToMove = IsAttackerToMove(ply);
+        const ChildNode* best = nullptr;
+        for (const ChildNode& child : children) {
+            if (child.numbers.proofNumber != 0) continue;
+            if (!best || (attackerToMove ? child.numbers.depth < best->numbers.depth : child.numbers.depth > best->numbers.depth)) {
+                best = &child;
+            }
+        }
+        if (!best) break;
+
+        line.push_back(best->move);
+        *boardStack[ply + 1] = *boardStack[ply];
+        boardStack[ply + 1]->ExecuteMove(best->move.move, best->move.from);
+        pathKeys[ply + 1] = best->key;
+        depth = best->numbers.depth;
+    }
+    return line;
+}
+
+bool MateSolver::IsOnPath(uint64_t key, int ply) const {
+    return std::find(pathKeys.begin(), pathKeys.begin() + ply + 1, key) != pathKeys.begin() + ply + 1;
+}
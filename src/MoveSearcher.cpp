@@ -4,11 +4,15 @@
 
 #include "../include/MoveSearcher.h"
 
-#include <iostream>
-#include <memory>
+#include <bit>
 
-void MoveSearcher::GetValidMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard) {
-    const Piece& piece = gameBoard->GetPiece(piecePosition);
+#include "../include/Geometry.h"
+#include "../include/Stats.h"
+#include "../include/Tracer.h"
+
+void MoveSearcher::GetValidMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard) {
+    const Piece& piece = gameBoard.GetPiece(piecePosition);
+    TRACE_SCOPE(TraceEvent::PieceMoves, piece.type);
 
     switch (piece.type) {
         case PieceType::None:
@@ -33,40 +37,191 @@ void MoveSearcher::GetValidMoves(PiecePosition piecePosition, PieceMoveQuery &mo
             GetPawnMoves(piecePosition, moveQuery, gameBoard, piece);
             break;
     }
+    if (piece.type != PieceType::None) STATS_ADD(Stats::GetMoveCounter(piece.type), moveQuery.moveCount);
 }
 
-void MoveSearcher::GetKingMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard,const Piece& piece) {
+void MoveSearcher::GetAllMoves(BoardMoveQuery &moveQuery, const Position &gameBoard) {
+    static constexpr PieceType PROMOTIONS[] = {PieceType::Queen, PieceType::Rook, PieceType::Bishop, PieceType::Knight};
+    STATS_TIMER(StatTimer::MoveGeneration);
+    TRACE_SCOPE(TraceEvent::MoveGeneration, 0);
+    PieceColor color = gameBoard.GetSideToMove();
+    PieceMoveQuery pieceMoveQuery;
     int idx = 0;
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            if (dy == 0 && dx == 0) continue;
-            PiecePosition movePosition(piecePosition.row + dy, piecePosition.col + dx);
-            if (movePosition.OutOfBounds()) continue;
-            const Piece& otherPiece = gameBoard->GetPiece(movePosition);
-            if (otherPiece.type != PieceType::None && otherPiece.color == piece.color) continue;
-            if (otherPiece.protectionState == OccuputationState::Protected) continue;
-            moveQuery.moves[idx] = PieceMove{MoveType::Standard,movePosition};
-            idx++;
+
+    for (short row = 0; row < GRID_SIZE; row++) {
+        for (short col = 0; col < GRID_SIZE; col++) {
+            PiecePosition from{row, col};
+            const Piece& piece = gameBoard.GetPiece(from);
+            if (piece.type == PieceType::None || piece.color != color) continue;
+
+            GetValidMoves(from, pieceMoveQuery, gameBoard);
+            for (int i = 0; i < pieceMoveQuery.moveCount; i++) {
+                PieceMove move = pieceMoveQuery.moves[i];
+                switch (move.type) {
+                    case MoveType::Promotion:
+                        for (PieceType promotion : PROMOTIONS) {
+                            move.promotion = promotion;
+                            moveQuery.moves[idx++] = BoardMove{from, move};
+                        }
+                        break;
+                    case MoveType::ShortCastle:
+                    case MoveType::LongCastle:
+                        if (!CanCastleThrough(move, color, gameBoard)) break;
+                        moveQuery.moves[idx++] = BoardMove{from, move};
+                        break;
+                    default:
+                        moveQuery.moves[idx++] = BoardMove{from, move};
+                        break;
+                }
+            }
         }
     }
+    moveQuery.moveCount = idx;
+}
+
+void MoveSearcher::GetLegalMoves(BoardMoveQuery &moveQuery, const Position &gameBoard) {
+    GetAllMoves(moveQuery, gameBoard);
+    PieceColor color = gameBoard.GetSideToMove();
+    int kingSquare = GetKingSquare(color, gameBoard);
+    if (kingSquare < 0) return;
+
+    PieceColor attackerColor = color == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    bool inCheck = IsSquareAttacked(Geometry::GetPosition(kingSquare), attackerColor, gameBoard);
+    uint64_t pinned = GetPinnedPieces(kingSquare, color, gameBoard);
+
+    int idx = 0;
+    for (int i = 0; i < moveQuery.moveCount; i++) {
+        const BoardMove& boardMove = moveQuery.moves[i];
+        int from = boardMove.from.GetBitMapPosition();
+        // Out of check only king moves and en passant can expose the king, and a pinned piece only by leaving
+        // the line through its king and the pinner
+        if (!inCheck && from != kingSquare && boardMove.move.type != MoveType::EnPassant) {
+            if ((pinned & 1ULL << from) && !(GEOMETRY.line[kingSquare][from] & boardMove.move.position.GetBitMapMask())) continue;
+            moveQuery.moves[idx++] = boardMove;
+            continue;
+        }
+
+        Position nextBoard = gameBoard;
+        nextBoard.ExecuteMove(boardMove.move, boardMove.from);
+        if (IsInCheck(color, nextBoard)) continue;
+        moveQuery.moves[idx++] = boardMove;
+    }
+    moveQuery.moveCount = idx;
+}
+
+bool MoveSearcher::IsSquareAttacked(PiecePosition piecePosition, PieceColor attackerColor, const Position &gameBoard) {
+    PieceColor defenderColor = attackerColor == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    uint64_t attackers = gameBoard.GetColorBitBoards(attackerColor).occupiedSquares;
+    uint64_t occupied = attackers | gameBoard.GetColorBitBoards(defenderColor).occupiedSquares;
+    int square = piecePosition.GetBitMapPosition();
+
+    auto hasAttacker = [&](uint64_t candidates, PieceType type, PieceType alternateType) {
+        for (; candidates != 0; candidates &= candidates - 1) {
+            const Piece& piece = gameBoard.GetPiece(Geometry::GetPosition(std::countr_zero(candidates)));
+            if (piece.type == type || piece.type == alternateType) return true;
+        }
+        return false;
+    };
+
+    // A pawn of the defending color would attack exactly the squares enemy pawns attack this one from
+    if (hasAttacker(GEOMETRY.pawnAttacks[static_cast<int>(defenderColor)][square] & attackers, PieceType::Pawn, PieceType::Pawn)) return true;
+    if (hasAttacker(GEOMETRY.knightAttacks[square] & attackers, PieceType::Knight, PieceType::Knight)) return true;
+    if (hasAttacker(GEOMETRY.kingAttacks[square] & attackers, PieceType::King, PieceType::King)) return true;
+
+    // Sliders on an open line to the square
+    uint64_t orthogonal = GEOMETRY.orthogonalRays[square] & attackers;
+    uint64_t diagonal = GEOMETRY.diagonalRays[square] & attackers;
+    for (uint64_t candidates = orthogonal | diagonal; candidates != 0; candidates &= candidates - 1) {
+        int from = std::countr_zero(candidates);
+        if (GEOMETRY.between[square][from] & occupied) continue;
+        PieceType sliderType = orthogonal & 1ULL << from ? PieceType::Rook : PieceType::Bishop;
+        PieceType type = gameBoard.GetPiece(Geometry::GetPosition(from)).type;
+        if (type == sliderType || type == PieceType::Queen) return true;
+    }
+    return false;
+}
+
+bool MoveSearcher::IsInCheck(PieceColor kingColor, const Position &gameBoard) {
+    PieceColor attackerColor = kingColor == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    int kingSquare = GetKingSquare(kingColor, gameBoard);
+    return kingSquare >= 0 && IsSquareAttacked(Geometry::GetPosition(kingSquare), attackerColor, gameBoard);
+}
+
+uint64_t MoveSearcher::GetAttackedSquares(PieceColor attackerColor, const Position &gameBoard) {
+    uint64_t attackers = gameBoard.GetColorBitBoards(attackerColor).occupiedSquares;
+    uint64_t occupied = gameBoard.GetColorBitBoards(PieceColor::White).occupiedSquares | gameBoard.GetColorBitBoards(PieceColor::Black).occupiedSquares;
+
+    uint64_t attacked = 0;
+    for (; attackers != 0; attackers &= attackers - 1) {
+        int from = std::countr_zero(attackers);
+        PieceType type = gameBoard.GetPiece(Geometry::GetPosition(from)).type;
+        uint64_t rays = 0;
+        switch (type) {
+            case PieceType::Pawn: attacked |= GEOMETRY.pawnAttacks[static_cast<int>(attackerColor)][from]; break;
+            case PieceType::Knight: attacked |= GEOMETRY.knightAttacks[from]; break;
+            case PieceType::King: attacked |= GEOMETRY.kingAttacks[from]; break;
+            case PieceType::Rook: rays = GEOMETRY.orthogonalRays[from]; break;
+            case PieceType::Bishop: rays = GEOMETRY.diagonalRays[from]; break;
+            case PieceType::Queen: rays = GEOMETRY.orthogonalRays[from] | GEOMETRY.diagonalRays[from]; break;
+            case PieceType::None: break;
+        }
+        for (; rays != 0; rays &= rays - 1) {
+            int to = std::countr_zero(rays);
+            if (!(GEOMETRY.between[from][to] & occupied)) attacked |= 1ULL << to;
+        }
+    }
+    return attacked;
+}
+
+int MoveSearcher::GetKingSquare(PieceColor kingColor, const Position &gameBoard) {
+    for (uint64_t pieces = gameBoard.GetColorBitBoards(kingColor).occupiedSquares; pieces != 0; pieces &= pieces - 1) {
+        int square = std::countr_zero(pieces);
+        if (gameBoard.GetPiece(Geometry::GetPosition(square)).type == PieceType::King) return square;
+    }
+    return -1;
+}
+
+uint64_t MoveSearcher::GetPinnedPieces(int kingSquare, PieceColor color, const Position &gameBoard) {
+    PieceColor attackerColor = color == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    uint64_t own = gameBoard.GetColorBitBoards(color).occupiedSquares;
+    uint64_t attackers = gameBoard.GetColorBitBoards(attackerColor).occupiedSquares;
+    uint64_t orthogonal = GEOMETRY.orthogonalRays[kingSquare] & attackers;
+    uint64_t diagonal = GEOMETRY.diagonalRays[kingSquare] & attackers;
+
+    uint64_t pinned = 0;
+    for (uint64_t candidates = orthogonal | diagonal; candidates != 0; candidates &= candidates - 1) {
+        int from = std::countr_zero(candidates);
+        PieceType sliderType = orthogonal & 1ULL << from ? PieceType::Rook : PieceType::Bishop;
+        PieceType type = gameBoard.GetPiece(Geometry::GetPosition(from)).type;
+        if (type != sliderType && type != PieceType::Queen) continue;
+
+        uint64_t blockers = GEOMETRY.between[kingSquare][from] & (own | attackers);
+        if (blockers != 0 && (blockers & (blockers - 1)) == 0 && (blockers & own)) pinned |= blockers;
+    }
+    return pinned;
+}
+
+void MoveSearcher::GetKingMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard,const Piece& piece) {
+    int idx = 0;
+    uint64_t targets = GEOMETRY.kingAttacks[piecePosition.GetBitMapPosition()] & ~gameBoard.GetColorBitBoards(piece.color).occupiedSquares;
+    for (; targets != 0; targets &= targets - 1) {
+        PiecePosition movePosition = Geometry::GetPosition(std::countr_zero(targets));
+        if (gameBoard.GetPiece(movePosition).protectionState == OccuputationState::Protected) continue;
+        moveQuery.moves[idx++] = PieceMove{MoveType::Standard,movePosition};
+    }
 
     if (piece.moveState == PieceMoveState::Moved) {
         moveQuery.moveCount = idx;
         return;
     }
 
-    const int SHORT_CASTLE_DIRECTION = -1;
-    const int SHORT_CASTLE_LENGTH = 2;
-    TryAddCastle(piece,piecePosition,moveQuery,gameBoard,idx,SHORT_CASTLE_DIRECTION,SHORT_CASTLE_LENGTH, MoveType::ShortCastle);
-
-    const int LONG_CASTLE_DIRECTION = 1;
-    const int LONG_CASTLE_LENGTH = 3;
-    TryAddCastle(piece,piecePosition,moveQuery,gameBoard,idx,LONG_CASTLE_DIRECTION,LONG_CASTLE_LENGTH, MoveType::LongCastle);
+    TryAddCastle(piece,piecePosition,moveQuery,gameBoard,idx,MoveType::ShortCastle);
+    TryAddCastle(piece,piecePosition,moveQuery,gameBoard,idx,MoveType::LongCastle);
 
     moveQuery.moveCount = idx;
 }
 
-void MoveSearcher::GetQueenMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery,const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece) {
+void MoveSearcher::GetQueenMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery,const Position &gameBoard, const Piece& piece) {
     const int directions[8][2] = {
         {1, 0}, {-1, 0}, {0, 1}, {0, -1},  // straight lines
         {1, 1}, {1, -1}, {-1, 1}, {-1, -1} // diagonals
@@ -74,45 +229,30 @@ void MoveSearcher::GetQueenMoves(PiecePosition piecePosition, PieceMoveQuery &mo
     GenerateSlidingMoves(piece, piecePosition, moveQuery, gameBoard, directions, 8);
 }
 
-void MoveSearcher::GetRookMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery,const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece) {
+void MoveSearcher::GetRookMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery,const Position &gameBoard, const Piece& piece) {
     const int directions[4][2] = {
         {1, 0}, {-1, 0}, {0, 1}, {0, -1}
     };
     GenerateSlidingMoves(piece, piecePosition, moveQuery, gameBoard, directions, 4);
 }
 
-void MoveSearcher::GetKnightMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery,const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece) {
-    const int knightOffsets[8][2] = {
-        {2, 1}, {1, 2}, {-1, 2}, {-2, 1},
-        {-2,-1}, {-1,-2}, {1,-2}, {2,-1}
-    };
-
+void MoveSearcher::GetKnightMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery,const Position &gameBoard, const Piece& piece) {
     int idx = 0;
-    for (int i = 0; i < 8; i++) {
-        PiecePosition movePosition(piecePosition.row + knightOffsets[i][0],piecePosition.col + knightOffsets[i][1]);
-
-        if (movePosition.OutOfBounds()) continue;
-        const Piece& targetPiece = gameBoard->GetPiece(movePosition);
-
-        // Skip friendly pieces
-        if (targetPiece.type != PieceType::None && targetPiece.color == piece.color) continue;
-
-        moveQuery.moves[idx++] = PieceMove{MoveType::Standard,movePosition};
+    uint64_t targets = GEOMETRY.knightAttacks[piecePosition.GetBitMapPosition()] & ~gameBoard.GetColorBitBoards(piece.color).occupiedSquares;
+    for (; targets != 0; targets &= targets - 1) {
+        moveQuery.moves[idx++] = PieceMove{MoveType::Standard,Geometry::GetPosition(std::countr_zero(targets))};
     }
-
     moveQuery.moveCount = idx;
-
 }
 
-void MoveSearcher::GetBishopMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery,const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece) {
+void MoveSearcher::GetBishopMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery,const Position &gameBoard, const Piece& piece) {
         const int directions[4][2] = {
             {1, 1}, {1, -1}, {-1, 1}, {-1, -1} // diagonals
         };
         GenerateSlidingMoves(piece, piecePosition, moveQuery, gameBoard, directions, 4);
 }
 
-void MoveSearcher::GetPawnMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, const Piece& piece) {
-    std::cout << piecePosition.row << " " << piecePosition.col << std::endl;
+void MoveSearcher::GetPawnMoves(PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, const Piece& piece) {
     MoveType moveType = MoveType::Standard;
     if ((piece.color == PieceColor::White && piecePosition.row >= GRID_SIZE-2) || (piece.color == PieceColor::Black && piecePosition.row <= 1)) {
         moveType = MoveType::Promotion;
@@ -129,7 +269,7 @@ void MoveSearcher::GetPawnMoves(PiecePosition piecePosition, PieceMoveQuery &mov
 
         if (movePos.OutOfBounds()) continue;
 
-        const Piece& targetPiece = gameBoard->GetPiece(movePos);
+        const Piece& targetPiece = gameBoard.GetPiece(movePos);
 
         // Skip friendly pieces
         if (targetPiece.type == PieceType::None || targetPiece.color == piece.color) continue;
@@ -152,9 +292,9 @@ void MoveSearcher::GetPawnMoves(PiecePosition piecePosition, PieceMoveQuery &mov
 
 }
 
-void MoveSearcher::GenerateSlidingMoves(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery,const std::unique_ptr<GameBoard> &gameBoard, const int directions[][2], int directionCount) {
+void MoveSearcher::GenerateSlidingMoves(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery,const Position &gameBoard, const int directions[][2], int directionCount) {
     int idx = 0;
-    for (int d = 0; d < 8; d++) {
+    for (int d = 0; d < directionCount; d++) {
         int dx = directions[d][0];
         int dy = directions[d][1];
 
@@ -166,7 +306,7 @@ void MoveSearcher::GenerateSlidingMoves(const Piece &piece, PiecePosition pieceP
 
             if (currentPos.OutOfBounds()) break;
 
-            const Piece& targetPiece = gameBoard->GetPiece(currentPos);
+            const Piece& targetPiece = gameBoard.GetPiece(currentPos);
 
             // Same color piece
             if (targetPiece.type != PieceType::None && targetPiece.color == piece.color)
@@ -184,29 +324,29 @@ void MoveSearcher::GenerateSlidingMoves(const Piece &piece, PiecePosition pieceP
 }
 
 void MoveSearcher::AddPawnPushMove(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery,
-                                   const std::unique_ptr<GameBoard> &gameBoard, int movement, int &idx, int direction, MoveType moveType) {
+                                   const Position &gameBoard, int movement, int &idx, int direction, MoveType moveType) {
     PiecePosition movePosition(piecePosition.row + direction * movement, piecePosition.col);
 
     if (movePosition.OutOfBounds()) return;
 
-    const Piece& targetPiece = gameBoard->GetPiece(movePosition);
+    const Piece& targetPiece = gameBoard.GetPiece(movePosition);
     if (targetPiece.type != PieceType::None) return;
 
     for (int i = 1; i < movement; i++) {
         PiecePosition betweenPosition(piecePosition.row + direction * i, piecePosition.col);
         if (betweenPosition.OutOfBounds()) return;
 
-        const Piece& betweenPiece = gameBoard->GetPiece(betweenPosition);
+        const Piece& betweenPiece = gameBoard.GetPiece(betweenPosition);
         if (betweenPiece.type != PieceType::None) return;
     }
     moveQuery.moves[idx++] = PieceMove{ moveType,movePosition};
 }
 
-void MoveSearcher::TryAddEnPassantMove(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, int &idx, int horizontalDirection, int verticalDirection) {
+void MoveSearcher::TryAddEnPassantMove(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, int &idx, int horizontalDirection, int verticalDirection) {
     PiecePosition adjacentPosition(piecePosition.row, piecePosition.col+horizontalDirection);
     if (adjacentPosition.OutOfBounds()) return;
 
-    PieceMoveHistory& lastMove = gameBoard->GetLastMove();
+    const PieceMoveHistory& lastMove = gameBoard.GetLastMove();
     Piece lastMovePiece = lastMove.piece;
     if (lastMovePiece.type != PieceType::Pawn || lastMove.piece.color == piece.color || lastMove.move.type != MoveType::DoublePawnPush) return;
 
@@ -218,15 +358,21 @@ void MoveSearcher::TryAddEnPassantMove(const Piece &piece, PiecePosition piecePo
     moveQuery.moves[idx++] = PieceMove{MoveType::EnPassant,movePosition};
 }
 
-void MoveSearcher::TryAddCastle(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, int &idx, int castleDirection, int castleLength, MoveType moveType) {
-    if (gameBoard->RowOccupied(piecePosition, castleDirection, castleLength)) return;
-    PiecePosition lastPosition = PiecePosition(piecePosition.row,piecePosition.col+(castleLength+1)*castleDirection);
-    Piece lastPiece = gameBoard->GetPiece(lastPosition);
-    if (lastPiece.type != PieceType::Rook || lastPiece.moveState != PieceMoveState::NotMoved) return;
+void MoveSearcher::TryAddCastle(const Piece &piece, PiecePosition piecePosition, PieceMoveQuery &moveQuery, const Position &gameBoard, int &idx, MoveType moveType) {
+    const CastleGeometry& castle = GEOMETRY.castles[static_cast<int>(piece.color)][moveType == MoveType::ShortCastle ? ShortCastleSide : LongCastleSide];
+    if (piecePosition.GetBitMapPosition() != castle.kingSquare) return;
+    uint64_t occupied = gameBoard.GetColorBitBoards(PieceColor::White).occupiedSquares | gameBoard.GetColorBitBoards(PieceColor::Black).occupiedSquares;
+    if (occupied & castle.path) return;
+    const Piece& rook = gameBoard.GetPiece(Geometry::GetPosition(castle.rookSquare));
+    if (rook.type != PieceType::Rook || rook.color != piece.color || rook.moveState != PieceMoveState::NotMoved) return;
 
-    const int KING_MOVEMENT = 2;
-    PiecePosition shortCastleKingPosition = PiecePosition(piecePosition.row,piecePosition.col+KING_MOVEMENT*castleDirection);
-    moveQuery.moves[idx] = PieceMove{ moveType,shortCastleKingPosition};
-    idx++;
+    moveQuery.moves[idx++] = PieceMove{moveType, Geometry::GetPosition(castle.kingTarget)};
 }
 
+
+bool MoveSearcher::CanCastleThrough(const PieceMove &move, PieceColor color, const Position &gameBoard) {
+    // The destination square is covered by the usual check test once the move is made
+    PieceColor attackerColor = color == PieceColor::White ? PieceColor::Black : PieceColor::White;
+    const CastleGeometry& castle = GEOMETRY.castles[static_cast<int>(color)][move.type == MoveType::ShortCastle ? ShortCastleSide : LongCastleSide];
+    return (GetAttackedSquares(attackerColor, gameBoard) & castle.safety) == 0;
+}
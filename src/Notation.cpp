@@ -0,0 +1,223 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/Notation.h"
+
+std::string Notation::GetSquareName(PiecePosition piecePosition) {
+    std::string name(2, ' ');
+    name[0] = static_cast<char>('a' + GRID_SIZE - piecePosition.col - 1);
+    name[1] = static_cast<char>('1' + piecePosition.row);
+    return name;
+}
+
+std::optional<PiecePosition> Notation::ParseSquare(std::string_view squareName) {
+    if (squareName.size() != 2) return std::nullopt;
+    PiecePosition piecePosition{static_cast<short>(squareName[1] - '1'), static_cast<short>(GRID_SIZE - (squareName[0] - 'a') - 1)};
+    if (piecePosition.OutOfBounds()) return std::nullopt;
+    return piecePosition;
+}
+
+std::string Notation::GetMoveName(const BoardMove &boardMove) {
+    std::string name = GetSquareName(boardMove.from) + GetSquareName(boardMove.move.position);
+    if (boardMove.move.type != MoveType::Promotion) return name;
+
+    switch (boardMove.move.promotion) {
+        case PieceType::Rook:
+            return name + 'r';
+        case PieceType::Knight:
+            return name + 'n';
+        case PieceType::Bishop:
+            return name + 'b';
+        default:
+            return name + 'q';
+    }
+}
+
+std::optional<BoardMove> Notation::ParseSanMove(std::string_view san, const std::unique_ptr<GameBoard> &gameBoard) {
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) {
+        san.remove_suffix(1);
+    }
+    if (san.size() < 2) return std::nullopt;
+
+    PieceColor color = gameBoard->GetSideToMove();
+    short homeRow = color == PieceColor::White ? 0 : GRID_SIZE - 1;
+    PieceType pieceType = PieceType::Pawn;
+    PieceType promotion = PieceType::None;
+    std::optional<short> fromRow;
+    std::optional<short> fromCol;
+    PiecePosition destination{};
+
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0") {
+        pieceType = PieceType::King;
+        fromRow = homeRow;
+        fromCol = 3;
+        destination = PiecePosition{homeRow, static_cast<short>(san.size() == 3 ? 1 : 5)};
+    } else {
+        if (std::optional<PieceType> type = ParsePieceLetter(san.front())) {
+            pieceType = type.value();
+            san.remove_prefix(1);
+        }
+
+        if (pieceType == PieceType::Pawn) {
+            if (san.size() >= 2 && san[san.size() - 2] == '=') {
+                promotion = ParsePieceLetter(san.back()).value_or(PieceType::None);
+                if (promotion == PieceType::None) return std::nullopt;
+                san.remove_suffix(2);
+            } else if (std::optional<PieceType> type = ParsePieceLetter(san.back())) {
+                promotion = type.value();
+                san.remove_suffix(1);
+            }
+        }
+        if (san.size() < 2) return std::nullopt;
+
+        std::optional<PiecePosition> square = ParseSquare(san.substr(san.size() - 2));
+        if (!square.has_value()) return std::nullopt;
+        destination = square.value();
+        san.remove_suffix(2);
+
+        bool capture = false;
+        for (char c : san) {
+            if (c >= 'a' && c <= 'h') {
+                fromCol = static_cast<short>(GRID_SIZE - (c - 'a') - 1);
+            } else if (c >= '1' && c <= '8') {
+                fromRow = static_cast<short>(c - '1');
+            } else if (c == 'x') {
+                capture = true;
+            } else {
+                return std::nullopt;
+            }
+        }
+        // Pawn pushes stay on their file, captures always name it
+        if (pieceType == PieceType::Pawn && !capture && !fromCol.has_value()) {
+            fromCol = destination.col;
+        }
+    }
+
+    std::array<BoardMove, 8> candidates;
+    int candidateCount = 0;
+    PieceMoveQuery pieceMoveQuery;
+    for (short row = 0; row < GRID_SIZE; row++) {
+        if (fromRow.has_value() && fromRow.value() != row) continue;
+        for (short col = 0; col < GRID_SIZE; col++) {
+            if (fromCol.has_value() && fromCol.value() != col) continue;
+
+            PiecePosition from{row, col};
+            const Piece& piece = gameBoard->GetPiece(from);
+            if (piece.type != pieceType || piece.color != color) continue;
+
+            MoveSearcher::GetValidMoves(from, pieceMoveQuery, *gameBoard);
+            for (int i = 0; i < pieceMoveQuery.moveCount && candidateCount < static_cast<int>(candidates.size()); i++) {
+                PieceMove move = pieceMoveQuery.moves[i];
+                if (move.position != destination) continue;
+                if ((move.type == MoveType::Promotion) != (promotion != PieceType::None)) continue;
+                move.promotion = promotion;
+                candidates[candidateCount++] = BoardMove{from, move};
+            }
+        }
+    }
+
+    if (candidateCount == 1) return candidates[0];
+
+    // SAN only disambiguates between legal moves, so a pinned piece can share the destination
+    std::optional<BoardMove> legalMove;
+    for (int i = 0; i < candidateCount; i++) {
+        GameBoard nextBoard = *gameBoard;
+        nextBoard.ExecuteMove(candidates[i].move, candidates[i].from);
+        if (MoveSearcher::IsInCheck(color, nextBoard)) continue;
+        if (legalMove.has_value()) return std::nullopt;
+        legalMove = candidates[i];
+    }
+    return legalMove;
+}
+
+std::string Notation::GetSanName(const BoardMove &boardMove, const std::unique_ptr<GameBoard> &gameBoard) {
+    const Piece& piece = gameBoard->GetPiece(boardMove.from);
+    std::string san;
+    if (boardMove.move.type == MoveType::ShortCastle) {
+        san = "O-O";
+    } else if (boardMove.move.type == MoveType::LongCastle) {
+        san = "O-O-O";
+    } else {
+        std::string destination = GetSquareName(boardMove.move.position);
+        bool capture = boardMove.move.type == MoveType::EnPassant || gameBoard->GetPiece(boardMove.move.position).type != PieceType::None;
+
+        if (piece.type == PieceType::Pawn) {
+            if (capture) san = GetSquareName(boardMove.from).substr(0, 1) + 'x';
+            san += destination;
+            if (boardMove.move.type == MoveType::Promotion) {
+                san += '=';
+                san += GetPieceLetter(boardMove.move.promotion == PieceType::None ? PieceType::Queen : boardMove.move.promotion);
+            }
+        } else {
+            san = GetPieceLetter(piece.type);
+
+            // Disambiguate against other legal moves of the same piece type to the same square
+            BoardMoveQuery moveQuery;
+            MoveSearcher::GetLegalMoves(moveQuery, *gameBoard);
+            bool ambiguous = false, sameFile = false, sameRow = false;
+            for (int i = 0; i < moveQuery.moveCount; i++) {
+                const BoardMove& other = moveQuery.moves[i];
+                if (other.from == boardMove.from || other.move.position != boardMove.move.position) continue;
+                if (gameBoard->GetPiece(other.from).type != piece.type) continue;
+                ambiguous = true;
+                if (other.from.col == boardMove.from.col) sameFile = true;
+                if (other.from.row == boardMove.from.row) sameRow = true;
+            }
+            std::string fromName = GetSquareName(boardMove.from);
+            if (ambiguous && !sameFile) {
+                san += fromName[0];
+            } else if (ambiguous && !sameRow) {
+                san += fromName[1];
+            } else if (ambiguous) {
+                san += fromName;
+            }
+
+            if (capture) san += 'x';
+            san += destination;
+        }
+    }
+
+    std::unique_ptr<GameBoard> nextBoard = std::make_unique<GameBoard>(*gameBoard);
+    nextBoard->ExecuteMove(boardMove.move, boardMove.from);
+    if (MoveSearcher::IsInCheck(nextBoard->GetSideToMove(), *nextBoard)) {
+        BoardMoveQuery replyQuery;
+        MoveSearcher::GetLegalMoves(replyQuery, *nextBoard);
+        san += replyQuery.moveCount == 0 ? '#' : '+';
+    }
+    return san;
+}
+
+std::optional<PieceType> Notation::ParsePieceLetter(char letter) {
+    switch (letter) {
+        case 'K':
+            return PieceType::King;
+        case 'Q':
+            return PieceType::Queen;
+        case 'R':
+            return PieceType::Rook;
+        case 'B':
+            return PieceType::Bishop;
+        case 'N':
+            return PieceType::Knight;
+        default:
+            return std::nullopt;
+    }
+}
+
+char Notation::GetPieceLetter(PieceType pieceType) {
+    switch (pieceType) {
+        case PieceType::King:
+            return 'K';
+        case PieceType::Queen:
+            return 'Q';
+        case PieceType::Rook:
+            return 'R';
+        case PieceType::Bishop:
+            return 'B';
+        case PieceType::Knight:
+            return 'N';
+        default:
+            return 'P';
+    }
+}
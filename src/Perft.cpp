@@ -0,0 +1,198 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/Perft.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <optional>
+
+#include "../include/ArgParse.h"
+#include "../include/Notation.h"
+#include "../include/ThreadPool.h"
+
+bool PerftOptions::ParseArgs(int argc, char **argv) {
+    // argv[1] is the command, the FEN is the one argument without a flag
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--depth" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], depth)) return false;
+        } else if (arg == "--kernel" && hasValue) {
+            kernel = argv[++i];
+        } else if (arg == "--input" && hasValue) {
+            inputPath = argv[++i];
+        } else if (arg == "--verify") {
+            verify = true;
+        } else if ((arg == "--threads" || arg == "--pin") && hasValue) {
+            i++; // the shared thread pool reads these
+        } else if (!arg.starts_with("--")) {
+            fen = arg;
+        }
+    }
+    return true;
+}
+
+Perft::Perft(const PerftOptions &options) : options(options), pending(ThreadPool::GetMemoryResource()), counts(ThreadPool::GetMemoryResource()) {
+    this->options.depth = std::max(this->options.depth, 0);
+    pending.reserve(PERFT_PENDING_POSITIONS);
+    counts.resize(PERFT_PENDING_POSITIONS);
+}
+
+int Perft::Run() {
+    std::optional<MoveGenKernel> parsedKernel = BatchMoveGen::ParseKernel(options.kernel);
+    if (!parsedKernel) {
+        std::cerr << "Unknown kernel: " << options.kernel << ", expected auto, reference, scalar, avx2 or avx512\n";
+        return 1;
+    }
+    if (!BatchMoveGen::IsSupported(*parsedKernel)) {
+        std::cerr << "This CPU cannot run the " << BatchMoveGen::GetKernelName(*parsedKernel) << " kernel\n";
+        return 1;
+    }
+    kernel = *parsedKernel;
+
+    std::vector<std::string> fens;
+    if (!options.inputPath.empty()) {
+        std::ifstream input(options.inputPath);
+        if (!input) {
+            std::cerr << "Failed to open perft input: " << options.inputPath << '\n';
+            return 1;
+        }
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            fens.push_back(line);
+        }
+    } else {
+        fens.push_back(options.fen);
+    }
+
+    std::vector<PerftSplit> splits;
+    for (const std::string& fen : fens) {
+        GameBoard gameBoard;
+        if (fen.empty()) {
+            gameBoard.LoadDefaultBoard();
+        } else if (!gameBoard.LoadFen(fen)) {
+            std::cerr << "Invalid FEN: " << fen << '\n';
+            return 1;
+        }
+        splits.push_back(PerftSplit{gameBoard, options.depth, {}});
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    ThreadPool& threadPool = ThreadPool::GetShared();
+    splits = Split(std::move(splits), threadPool.GetWorkerCount() * PERFT_TASKS_PER_WORKER);
+    std::vector<PerftResult> splitResults(splits.size());
+    TaskGroup taskGroup(threadPool);
+    for (size_t i = 0; i < splits.size(); i++) {
+        taskGroup.Run([this, &splits, &splitResults, i] {
+            Perft perft(options);
+            perft.kernel = kernel;
+            perft.line = splits[i].line;
+            splitResults[i] = perft.Count(splits[i].position, splits[i].depth);
+        });
+    }
+    taskGroup.Wait();
+
+    result = PerftResult{};
+    for (const PerftResult& splitResult : splitResults) {
+        result.nodes += splitResult.nodes;
+        result.countedPositions += splitResult.countedPositions;
+        result.mismatches += splitResult.mismatches;
+    }
+    int64_t timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+    int64_t elapsedMs = std::max<int64_t>(timeMs, 1);
+    std::cout << "perft depth " << options.depth << " kernel " << BatchMoveGen::GetKernelName(kernel)
+              << " threads " << threadPool.GetWorkerCount() << " nodes " << result.nodes << " time_ms " << timeMs
+              << " nps " << result.nodes * 1000 / elapsedMs
+              << " positions_per_second " << result.countedPositions * 1000 / elapsedMs << '\n';
+    if (options.verify) {
+        std::cout << "verified " << result.countedPositions << " positions, " << result.mismatches << " mismatches\n";
+    }
+    return result.mismatches == 0 ? 0 : 1;
+}
+
+PerftResult Perft::Count(const Position &position, int depth) {
+    result = PerftResult{};
+    Walk(position, depth);
+    Flush();
+    return result;
+}
+
+std::vector<PerftSplit> Perft::Split(std::vector<PerftSplit> splits, size_t targetCount) const {
+    // One ply at a time over every subtree, so the pieces stay about the same size. Two plies are left to each
+    // task so it still fills a batch
+    while (splits.size() < targetCount) {
+        std::vector<PerftSplit> expanded;
+        bool split = false;
+        for (PerftSplit& parent : splits) {
+            if (parent.depth <= 2) {
+                expanded.push_back(std::move(parent));
+                continue;
+            }
+            split = true;
+            BoardMoveQuery moveQuery;
+            MoveSearcher::GetLegalMoves(moveQuery, parent.position);
+            for (int i = 0; i < moveQuery.moveCount; i++) {
+                const BoardMove& boardMove = moveQuery.moves[i];
+                PerftSplit child{parent.position, parent.depth - 1, parent.line};
+                child.position.ExecuteMove(boardMove.move, boardMove.from);
+                child.line.push_back(boardMove);
+                expanded.push_back(std::move(child));
+            }
+        }
+        if (!split) break;
+        splits = std::move(expanded);
+    }
+    return splits;
+}
+
+void Perft::Walk(const Position &position, int depth) {
+    if (depth == 0) {
+        result.nodes++;
+        return;
+    }
+    if (depth == 1) {
+        pending.push_back(position);
+        if (options.verify) {
+            std::string moves;
+            for (const BoardMove& boardMove : line) {
+                moves += (moves.empty() ? "" : " ") + Notation::GetMoveName(boardMove);
+            }
+            pendingLines.push_back(std::move(moves));
+        }
+        if (pending.size() == PERFT_PENDING_POSITIONS) Flush();
+        return;
+    }
+
+    BoardMoveQuery moveQuery;
+    MoveSearcher::GetLegalMoves(moveQuery, position);
+    for (int i = 0; i < moveQuery.moveCount; i++) {
+        const BoardMove& boardMove = moveQuery.moves[i];
+        Position nextPosition = position;
+        nextPosition.ExecuteMove(boardMove.move, boardMove.from);
+        line.push_back(boardMove);
+        Walk(nextPosition, depth - 1);
+        line.pop_back();
+    }
+}
+
+void Perft::Flush() {
+    if (pending.empty()) return;
+    BatchMoveGen::CountLegalMoves(pending, std::span(counts.data(), pending.size()), kernel);
+    for (size_t i = 0; i < pending.size(); i++) {
+        result.nodes += counts[i];
+        if (!options.verify) continue;
+        uint32_t expected = BatchMoveGen::CountLegalMoves(pending[i]);
+        if (counts[i] == expected) continue;
+        result.mismatches++;
+        std::cerr << "Mismatch after [" << pendingLines[i] << "]: " << counts[i] << " moves, expected " << expected << '\n';
+    }
+    result.countedPositions += pending.size();
+    pending.clear();
+    pendingLines.clear();
+}
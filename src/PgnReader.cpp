@@ -0,0 +1,214 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/PgnReader.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "../include/Notation.h"
+
+namespace {
+    constexpr std::string_view GAME_START = "[Event ";
+
+    bool IsSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    bool IsTokenEnd(char c) {
+        return IsSpace(c) || c == '{' || c == '(' || c == ')' || c == ';';
+    }
+
+    bool IsResult(std::string_view token) {
+        return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+    }
+
+    size_t SkipLine(std::string_view text, size_t position) {
+        size_t end = text.find('\n', position);
+        return end == std::string_view::npos ? text.size() : end + 1;
+    }
+
+    bool AtLineStart(std::string_view text, size_t position) {
+        return position == 0 || text[position - 1] == '\n';
+    }
+}
+
+std::string_view PgnGame::GetTag(std::string_view name) const {
+    size_t position = 0;
+    while ((position = tagSection.find('[', position)) != std::string_view::npos) {
+        position++;
+        if (tagSection.compare(position, name.size(), name) != 0 || position + name.size() >= tagSection.size() || tagSection[position + name.size()] != ' ') continue;
+
+        size_t valueStart = tagSection.find('"', position + name.size());
+        if (valueStart == std::string_view::npos) return {};
+        size_t valueEnd = tagSection.find('"', valueStart + 1);
+        if (valueEnd == std::string_view::npos) return {};
+        return tagSection.substr(valueStart + 1, valueEnd - valueStart - 1);
+    }
+    return {};
+}
+
+bool PgnGame::LoadStartBoard(const std::unique_ptr<GameBoard> &gameBoard) const {
+    std::string_view fen = GetTag("FEN");
+    if (fen.empty()) {
+        gameBoard->LoadDefaultBoard();
+        return true;
+    }
+    return gameBoard->LoadFen(std::string(fen));
+}
+
+bool PgnReader::Open(const std::string &path) {
+    return mappedFile.Open(path, MappedFileAccess::Sequential);
+}
+
+PgnReadStats PgnReader::Read(int threads, const PgnGameCallback &callback) const {
+    std::vector<std::string_view> chunks = SplitChunks(std::max(1, threads));
+    std::vector<PgnReadStats> chunkStats(chunks.size());
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks.size());
+    for (size_t i = 0; i < chunks.size(); i++) {
+        uint64_t chunkOffset = chunks[i].data() - mappedFile.GetData();
+        workers.emplace_back([&chunkStats, &chunks, &callback, i, chunkOffset] {
+            chunkStats[i] = ReadChunk(chunks[i], chunkOffset, callback);
+        });
+    }
+
+    PgnReadStats stats;
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+        stats.games += chunkStats[i].games;
+        stats.moves += chunkStats[i].moves;
+        stats.errors += chunkStats[i].errors;
+    }
+    return stats;
+}
+
+std::vector<std::string_view> PgnReader::SplitChunks(int chunkCount) const {
+    std::string_view text = mappedFile.GetView();
+    std::vector<std::string_view> chunks;
+
+    // Cut near equal sizes, then move each cut forward to the next game's Event tag
+    size_t start = 0;
+    for (int i = 1; i < chunkCount && start < text.size(); i++) {
+        size_t cut = std::max(start + 1, text.size() * i / chunkCount);
+        while (cut < text.size()) {
+            cut = text.find(GAME_START, cut);
+            if (cut == std::string_view::npos || AtLineStart(text, cut)) break;
+            cut++;
+        }
+        if (cut == std::string_view::npos || cut >= text.size()) break;
+
+        chunks.push_back(text.substr(start, cut - start));
+        start = cut;
+    }
+    chunks.push_back(text.substr(start));
+    return chunks;
+}
+
+PgnReadStats PgnReader::ReadChunk(std::string_view chunk, uint64_t chunkOffset, const PgnGameCallback &callback) {
+    PgnReadStats stats;
+    PgnGame game;
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+
+    size_t position = 0;
+    while (position < chunk.size()) {
+        while (position < chunk.size() && IsSpace(chunk[position])) position++;
+        if (position >= chunk.size()) break;
+
+        size_t tagStart = position;
+        position = ReadTags(chunk, position);
+
+        game.offset = chunkOffset + tagStart;
+        game.tagSection = chunk.substr(tagStart, position - tagStart);
+        game.result = game.GetTag("Result");
+        game.moves.clear();
+        game.errorToken = {};
+
+        if (!game.LoadStartBoard(gameBoard)) {
+            game.errorToken = game.GetTag("FEN");
+        }
+        position = ReadMoveText(chunk, position, game, gameBoard);
+
+        stats.games++;
+        stats.moves += game.moves.size();
+        if (!game.errorToken.empty()) stats.errors++;
+        callback(game, gameBoard);
+    }
+    return stats;
+}
+
+size_t PgnReader::ReadTags(std::string_view text, size_t position) {
+    while (position < text.size()) {
+        while (position < text.size() && IsSpace(text[position])) position++;
+        if (position >= text.size() || text[position] != '[') break;
+        position = SkipLine(text, position);
+    }
+    return position;
+}
+
+size_t PgnReader::ReadMoveText(std::string_view text, size_t position, PgnGame &game, const std::unique_ptr<GameBoard> &gameBoard) {
+    bool replaying = game.errorToken.empty();
+    int variationDepth = 0;
+
+    while (position < text.size()) {
+        char c = text[position];
+        if (IsSpace(c)) {
+            position++;
+            continue;
+        }
+        if (c == '{') {
+            size_t end = text.find('}', position);
+            position = end == std::string_view::npos ? text.size() : end + 1;
+            continue;
+        }
+        if (c == ';' || (c == '%' && AtLineStart(text, position))) {
+            position = SkipLine(text, position);
+            continue;
+        }
+        if (c == '(') {
+            variationDepth++;
+            position++;
+            continue;
+        }
+        if (c == ')') {
+            variationDepth = std::max(0, variationDepth - 1);
+            position++;
+            continue;
+        }
+        // A tag line at this point means the previous game had no termination marker
+        if (c == '[' && AtLineStart(text, position)) break;
+
+        size_t tokenEnd = position;
+        while (tokenEnd < text.size() && !IsTokenEnd(text[tokenEnd])) tokenEnd++;
+        std::string_view token = text.substr(position, tokenEnd - position);
+        position = tokenEnd;
+
+        if (variationDepth > 0 || token[0] == '$') continue;
+        if (IsResult(token)) {
+            game.result = token;
+            break;
+        }
+
+        // Move numbers may be glued to the move, as in 12.e4 or 12...e5
+        if (token[0] >= '1' && token[0] <= '9') {
+            size_t moveStart = token.find_first_not_of("0123456789");
+            if (moveStart == std::string_view::npos || token[moveStart] != '.') continue;
+            moveStart = token.find_first_not_of('.', moveStart);
+            if (moveStart == std::string_view::npos) continue;
+            token.remove_prefix(moveStart);
+        }
+        if (!replaying) continue;
+
+        std::optional<BoardMove> boardMove = Notation::ParseSanMove(token, gameBoard);
+        if (!boardMove.has_value()) {
+            game.errorToken = token;
+            replaying = false;
+            continue;
+        }
+        gameBoard->ExecuteMove(boardMove->move, boardMove->from);
+        game.moves.push_back(boardMove.value());
+    }
+    return position;
+}
@@ -0,0 +1,165 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/PolyglotBook.h"
+
+#include <array>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+    constexpr int MAX_BOOK_MOVES = 64;
+
+    // Relative paths are tried against the working directory, then against the executable's directory
+    std::string ResolvePath(const std::string &pathName) {
+        std::filesystem::path path(pathName);
+        std::error_code error;
+        if (path.is_absolute() || std::filesystem::exists(path, error)) return pathName;
+
+        std::filesystem::path executable = std::filesystem::read_symlink("/proc/self/exe", error);
+        if (error) return pathName;
+        std::filesystem::path candidate = executable.parent_path() / path;
+        return std::filesystem::exists(candidate, error) ? candidate.string() : pathName;
+    }
+}
+
+bool PolyglotBook::Open(const std::string &bookPath, const std::string &keysPath, bool quiet) {
+    entryCount = 0;
+    std::string resolvedBookPath = ResolvePath(bookPath);
+    std::error_code error;
+    if (quiet && !std::filesystem::exists(resolvedBookPath, error)) return false;
+    std::string resolvedKeysPath = ResolvePath(keysPath);
+    if (!Zobrist::LoadKeys(resolvedKeysPath, polyglotKeys)) {
+        if (quiet) return false;
+        std::cerr << "Failed to load Polyglot keys: " << resolvedKeysPath
+                  << " (pass --keys with the 781 Random64 values from the Polyglot book format, one per line)\n";
+        return false;
+    }
+
+    // A wrong table would silently miss every position, so check it against the published start key
+    std::unique_ptr<GameBoard> startBoard = std::make_unique<GameBoard>();
+    startBoard->LoadDefaultBoard();
+    if (GetKey(startBoard) != POLYGLOT_START_POSITION_KEY) {
+        std::cerr << "Polyglot keys do not match the reference table: " << resolvedKeysPath << '\n';
+        return false;
+    }
+
+    if (!mappedFile.Open(resolvedBookPath, MappedFileAccess::Random)) {
+        if (!quiet) std::cerr << "Failed to open book: " << bookPath << '\n';
+        return false;
+    }
+    entryCount = mappedFile.GetSize() / POLYGLOT_ENTRY_SIZE;
+    return true;
+}
+
+bool PolyglotBook::IsOpen() const {
+    return entryCount > 0;
+}
+
+uint64_t PolyglotBook::GetKey(const std::unique_ptr<GameBoard> &gameBoard) const {
+    return Zobrist::ComputeKey(*gameBoard, polyglotKeys);
+}
+
+int PolyglotBook::GetBookMoves(const std::unique_ptr<GameBoard> &gameBoard, std::span<BookMove> moves) const {
+    if (!IsOpen()) return 0;
+
+    uint64_t key = GetKey(gameBoard);
+    int count = 0;
+    for (size_t entry = FindFirstEntry(key); entry < entryCount && count < static_cast<int>(moves.size()); entry++) {
+        size_t offset = entry * POLYGLOT_ENTRY_SIZE;
+        if (ReadBigEndian(offset, 8) != key) break;
+
+        uint16_t weight = static_cast<uint16_t>(ReadBigEndian(offset + 10, 2));
+        if (weight == 0) continue;
+
+        std::optional<BoardMove> boardMove = DecodeMove(static_cast<uint16_t>(ReadBigEndian(offset + 8, 2)), gameBoard);
+        if (!boardMove.has_value()) continue;
+        moves[count++] = BookMove{boardMove.value(), weight};
+    }
+    return count;
+}
+
+std::optional<BoardMove> PolyglotBook::Probe(const std::unique_ptr<GameBoard> &gameBoard, BookSelection selection, uint64_t randomValue) const {
+    std::array<BookMove, MAX_BOOK_MOVES> bookMoves;
+    int count = GetBookMoves(gameBoard, bookMoves);
+    if (count == 0) return std::nullopt;
+
+    uint32_t totalWeight = 0;
+    int bestIndex = 0;
+    for (int i = 0; i < count; i++) {
+        totalWeight += bookMoves[i].weight;
+        if (bookMoves[i].weight > bookMoves[bestIndex].weight) bestIndex = i;
+    }
+    if (selection == BookSelection::BestWeight) return bookMoves[bestIndex].boardMove;
+
+    uint64_t pick = randomValue % totalWeight;
+    for (int i = 0; i < count; i++) {
+        if (pick < bookMoves[i].weight) return bookMoves[i].boardMove;
+        pick -= bookMoves[i].weight;
+    }
+    return bookMoves[bestIndex].boardMove;
+}
+
+size_t PolyglotBook::FindFirstEntry(uint64_t key) const {
+    // Entries are sorted by key, find the first one that is not below it
+    size_t low = 0;
+    size_t high = entryCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (ReadBigEndian(middle * POLYGLOT_ENTRY_SIZE, 8) < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+uint64_t PolyglotBook::ReadBigEndian(size_t offset, int bytes) const {
+    const auto* data = reinterpret_cast<const unsigned char*>(mappedFile.GetData()) + offset;
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+std::optional<BoardMove> PolyglotBook::DecodeMove(uint16_t polyglotMove, const std::unique_ptr<GameBoard> &gameBoard) {
+    static constexpr PieceType PROMOTIONS[] = {PieceType::None, PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen};
+
+    // Polyglot counts files from a, columns here run from h
+    PiecePosition to{static_cast<short>((polyglotMove >> 3) & 7), static_cast<short>(GRID_SIZE - (polyglotMove & 7) - 1)};
+    PiecePosition from{static_cast<short>((polyglotMove >> 9) & 7), static_cast<short>(GRID_SIZE - ((polyglotMove >> 6) & 7) - 1)};
+    int promotionIndex = (polyglotMove >> 12) & 7;
+    if (promotionIndex >= static_cast<int>(std::size(PROMOTIONS))) return std::nullopt;
+    PieceType promotion = PROMOTIONS[promotionIndex];
+
+    const Piece& piece = gameBoard->GetPiece(from);
+    if (piece.type == PieceType::None || piece.color != gameBoard->GetSideToMove()) return std::nullopt;
+
+    // Castling is written as the king taking its own rook
+    std::optional<MoveType> castleType;
+    if (piece.type == PieceType::King && piece.moveState == PieceMoveState::NotMoved && from.row == to.row) {
+        if (to.col == 0) {
+            castleType = MoveType::ShortCastle;
+            to.col = 1;
+        } else if (to.col == GRID_SIZE - 1) {
+            castleType = MoveType::LongCastle;
+            to.col = 5;
+        }
+    }
+
+    PieceMoveQuery pieceMoveQuery;
+    MoveSearcher::GetValidMoves(from, pieceMoveQuery, *gameBoard);
+    for (int i = 0; i < pieceMoveQuery.moveCount; i++) {
+        PieceMove move = pieceMoveQuery.moves[i];
+        if (move.position != to) continue;
+        if (castleType.has_value() && move.type != castleType.value()) continue;
+        if ((move.type == MoveType::Promotion) != (promotion != PieceType::None)) continue;
+
+        move.promotion = promotion;
+        return BoardMove{from, move};
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,44 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/PositionPublisher.h"
+
+#include <cstring>
+
+PositionPublisher::PositionPublisher(const Position &position) {
+    Publish(position);
+}
+
+void PositionPublisher::Publish(const Position &position) {
+    PositionSnapshot snapshot {position, ++version};
+    std::array<uint64_t, SNAPSHOT_WORDS> buffer {};
+    std::memcpy(buffer.data(), &snapshot, sizeof(snapshot));
+
+    uint64_t start = sequence.load(std::memory_order_relaxed);
+    sequence.store(start + 1, std::memory_order_relaxed);
+    // Keeps the word stores below the odd sequence, a reader that sees any of them also sees the odd count
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < SNAPSHOT_WORDS; i++) {
+        words[i].store(buffer[i], std::memory_order_relaxed);
+    }
+    sequence.store(start + 2, std::memory_order_release);
+}
+
+PositionSnapshot PositionPublisher::Load() const {
+    std::array<uint64_t, SNAPSHOT_WORDS> buffer;
+    while (true) {
+        uint64_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        for (size_t i = 0; i < SNAPSHOT_WORDS; i++) {
+            buffer[i] = words[i].load(std::memory_order_relaxed);
+        }
+        // Keeps the word loads above the second sequence read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) break;
+    }
+
+    PositionSnapshot snapshot;
+    std::memcpy(static_cast<void*>(&snapshot), buffer.data(), sizeof(snapshot));
+    return snapshot;
+}
@@ -0,0 +1,372 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/Search.h"
+
+#include <algorithm>
+
+#include "../include/Evaluator.h"
+#include "../include/Stats.h"
+#include "../include/ThreadPool.h"
+#include "../include/Tracer.h"
+
+namespace {
+    constexpr uint64_t TIME_CHECK_INTERVAL = 1024;
+
+    bool IsCapture(const BoardMove &boardMove, const std::unique_ptr<GameBoard> &gameBoard) {
+        if (boardMove.move.type == MoveType::EnPassant) return true;
+        return gameBoard->GetPiece(boardMove.move.position).type != PieceType::None;
+    }
+}
+
+Searcher::Searcher() : zobristKeys(Zobrist::GetEngineKeys()), moveStack(ThreadPool::GetMemoryResource()) {
+    // One board and move list per ply, so the search never allocates
+    boardStack.reserve(MAX_SEARCH_PLY + 1);
+    for (int i = 0; i <= MAX_SEARCH_PLY; i++) {
+        boardStack.push_back(std::make_unique<GameBoard>());
+    }
+    moveStack.resize(MAX_SEARCH_PLY + 1);
+}
+
+void Searcher::SetHashSize(size_t megabytes) {
+    transpositionTable.Resize(megabytes);
+}
+
+void Searcher::ClearHash() {
+    transpositionTable.Clear();
+}
+
+size_t Searcher::GetHashSizeMb() const {
+    return transpositionTable.GetSizeMb();
+}
+
+SearchResult Searcher::Search(const std::unique_ptr<GameBoard> &gameBoard, const SearchLimits &searchLimits) {
+    STATS_TIMER(StatTimer::Search);
+    if (transpositionTable.IsEmpty()) transpositionTable.Resize(TT_DEFAULT_SIZE_MB);
+    limits = searchLimits;
+    startTime = std::chrono::steady_clock::now();
+    nodes = 0;
+    stopped = false;
+    previousBestMove = std::nullopt;
+    timeLimitMs = limits.moveTimeMs;
+    if (limits.clock.IsEnabled()) {
+        timeManager.Start(limits.clock);
+        int64_t hardLimitMs = timeManager.GetHardLimitMs();
+        timeLimitMs = timeLimitMs > 0 ? std::min(timeLimitMs, hardLimitMs) : hardLimitMs;
+    }
+    *boardStack[0] = *gameBoard;
+    rootBitbaseResult = bitbases != nullptr ? bitbases->Probe(*gameBoard) : std::nullopt;
+
+    SearchResult result;
+    int maxDepth = std::clamp(limits.depth, 1, MAX_SEARCH_PLY - 1);
+    int multiPv = std::max(1, limits.multiPv);
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        TRACE_SCOPE(TraceEvent::Iteration, depth);
+        std::optional<BoardMove> lastBestMove = result.bestMove;
+        excludedRootMoves.clear();
+        for (int pvIndex = 0; pvIndex < multiPv; pvIndex++) {
+            // Each line first tries the move it ended on last iteration, with the siblings' subtrees already in the table
+            bool hasLastLine = pvIndex < static_cast<int>(result.lines.size());
+            previousBestMove = hasLastLine ? std::optional(result.lines[pvIndex].moves.front()) : std::nullopt;
+            rootBestMove = std::nullopt;
+            int score = Negamax(0, depth, limits.alpha, limits.beta);
+            if (!rootBestMove.has_value() || (stopped && result.bestMove.has_value())) break;
+
+            PvLine line {score, GetPrincipalVariation(rootBestMove.value())};
+            if (hasLastLine) {
+                result.lines[pvIndex] = std::move(line);
+            } else {
+                result.lines.push_back(std::move(line));
+            }
+            excludedRootMoves.push_back(rootBestMove.value());
+            if (pvIndex == 0) {
+                result.bestMove = rootBestMove;
+                result.score = score;
+                result.depth = depth;
+            }
+            if (limits.onProgress) {
+                result.nodes = nodes;
+                result.timeMs = GetElapsedMs();
+                limits.onProgress(result);
+            }
+            if (stopped) break;
+        }
+        // Lines the previous iteration had but this one could not reach, because moves ran out, are gone
+        if (!stopped && static_cast<int>(result.lines.size()) > static_cast<int>(excludedRootMoves.size())) {
+            result.lines.resize(excludedRootMoves.size());
+        }
+
+        // Long analyses write their results back as they go, not only when they finish
+        if (analysisCache != nullptr && std::chrono::steady_clock::now() - lastCacheFlush >= ANALYSIS_CACHE_FLUSH_INTERVAL) {
+            analysisCache->Flush();
+            lastCacheFlush = std::chrono::steady_clock::now();
+        }
+
+        bool iterationDone = result.depth == depth;
+        if (stopped || !iterationDone || result.IsMateScore()) break;
+        bool bestMoveChanged = lastBestMove.has_value() && !(lastBestMove.value() == result.bestMove.value());
+        if (limits.clock.IsEnabled() && !timeManager.OnIteration(GetElapsedMs(), bestMoveChanged, result.score)) break;
+    }
+
+    // A limit that hits inside the first iteration still has to answer with a legal move
+    if (!result.bestMove.has_value()) {
+        MoveSearcher::GetLegalMoves(moveStack[0], *gameBoard);
+        if (moveStack[0].moveCount > 0) result.bestMove = moveStack[0].moves[0];
+    }
+
+    if (analysisCache != nullptr) analysisCache->Flush();
+    result.nodes = nodes;
+    result.timeMs = GetElapsedMs();
+    return result;
+}
+
+void Searcher::SetBitbases(const Bitbases *bitbases) {
+    this->bitbases = bitbases;
+}
+
+void Searcher::SetAnalysisCache(AnalysisCache *analysisCache) {
+    this->analysisCache = analysisCache;
+}
+
+void Searcher::SetSharedEntries(SharedEntries *sharedEntries) {
+    this->sharedEntries = sharedEntries;
+}
+
+int Searcher::Negamax(int ply, int depth, int alpha, int beta) {
+    if (ply > 0) {
+        if (std::optional<int> bitbaseScore = ProbeBitbases(ply)) return bitbaseScore.value();
+    }
+    if (depth <= 0 || ply >= MAX_SEARCH_PLY - 1) return Quiescence(ply, alpha, beta);
+    if (ShouldStop()) return 0;
+    nodes++;
+    STATS_ADD(StatCounter::Nodes, 1);
+
+    const std::unique_ptr<GameBoard>& gameBoard = boardStack[ply];
+    const std::unique_ptr<GameBoard>& nextBoard = boardStack[ply + 1];
+    BoardMoveQuery& moveQuery = moveStack[ply];
+    PieceColor color = gameBoard->GetSideToMove();
+
+    uint64_t key = Zobrist::ComputeKey(*gameBoard, zobristKeys);
+    STATS_ADD(StatCounter::TTProbes, 1);
+    const TTEntry* entry = transpositionTable.Probe(key);
+    // The table starts empty each game, the cache still knows what earlier runs found
+    std::optional<TTEntry> cachedEntry;
+    if ((entry == nullptr || entry->depth < depth) && analysisCache != nullptr && depth >= ANALYSIS_CACHE_MIN_DEPTH) {
+        cachedEntry = analysisCache->Probe(key);
+        if (cachedEntry.has_value() && (entry == nullptr || cachedEntry->depth > entry->depth)) entry = &cachedEntry.value();
+    }
+    uint16_t hashMove = 0;
+    if (entry != nullptr) {
+        STATS_ADD(StatCounter::TTHits, 1);
+        hashMove = entry->move;
+        // The root always searches so it has a move to return
+        if (ply > 0 && entry->depth >= depth) {
+            int score = TranspositionTable::FromStoredScore(entry->score, ply);
+            if (entry->bound == TTBound::Exact) return score;
+            if (entry->bound == TTBound::Lower && score >= beta) return score;
+            if (entry->bound == TTBound::Upper && score <= alpha) return score;
+        }
+    }
+
+    MoveSearcher::GetAllMoves(moveQuery, *gameBoard);
+    std::optional<BoardMove> firstMove = ply == 0 && previousBestMove.has_value() ? previousBestMove : TranspositionTable::FindMove(hashMove, moveQuery);
+    OrderMoves(moveQuery, gameBoard, firstMove);
+
+    int originalAlpha = alpha;
+    std::optional<BoardMove> bestMove;
+    int bestScore = -INFINITE_SCORE;
+    int legalMoves = 0;
+    for (int i = 0; i < moveQuery.moveCount; i++) {
+        const BoardMove& boardMove = moveQuery.moves[i];
+        *nextBoard = *gameBoard;
+        nextBoard->ExecuteMove(boardMove.move, boardMove.from);
+        if (MoveSearcher::IsInCheck(color, *nextBoard)) continue;
+        legalMoves++;
+        if (ply == 0 && IsRootMoveExcluded(boardMove, nextBoard)) continue;
+
+        TRACE_SCOPE_IF(ply == 0, TraceEvent::RootMove, i);
+        int score = -Negamax(ply + 1, depth - 1, -beta, -alpha);
+        if (stopped) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = boardMove;
+            if (ply == 0) rootBestMove = boardMove;
+        }
+        if (score > alpha) alpha = score;
+        if (alpha >= beta) {
+            STATS_ADD(StatCounter::BetaCutoffs, 1);
+            break;
+        }
+    }
+
+    if (legalMoves == 0) {
+        return MoveSearcher::IsInCheck(color, *gameBoard) ? -MATE_SCORE + ply : 0;
+    }
+    // Bitbase and multi-PV exclusions leave root scores incomplete, they are not worth keeping
+    if (ply > 0 || (!rootBitbaseResult.has_value() && excludedRootMoves.empty())) {
+        TTBound bound = bestScore >= beta ? TTBound::Lower : bestScore > originalAlpha ? TTBound::Exact : TTBound::Upper;
+        transpositionTable.Store(key, depth, bestScore, bound, bestMove, ply);
+        if (analysisCache != nullptr && depth >= ANALYSIS_CACHE_MIN_DEPTH) {
+            uint16_t packedMove = bestMove.has_value() ? TranspositionTable::PackMove(bestMove.value()) : hashMove;
+            analysisCache->Store(TTEntry{key, packedMove, static_cast<int16_t>(TranspositionTable::ToStoredScore(bestScore, ply)), static_cast<int8_t>(depth), bound});
+        }
+        if (sharedEntries != nullptr && depth >= SHARED_ENTRY_MIN_DEPTH) {
+            if (const TTEntry* stored = transpositionTable.Probe(key)) sharedEntries->Publish(*stored);
+        }
+    }
+    return bestScore;
+}
+
+int Searcher::Quiescence(int ply, int alpha, int beta) {
+    if (ShouldStop()) return 0;
+    nodes++;
+    STATS_ADD(StatCounter::QuiescenceNodes, 1);
+
+    const std::unique_ptr<GameBoard>& gameBoard = boardStack[ply];
+    int standPat = Evaluator::Evaluate(gameBoard);
+    if (standPat >= beta || ply >= MAX_SEARCH_PLY - 1) return standPat;
+    if (standPat > alpha) alpha = standPat;
+
+    const std::unique_ptr<GameBoard>& nextBoard = boardStack[ply + 1];
+    BoardMoveQuery& moveQuery = moveStack[ply];
+    PieceColor color = gameBoard->GetSideToMove();
+
+    MoveSearcher::GetAllMoves(moveQuery, *gameBoard);
+    OrderMoves(moveQuery, gameBoard, std::nullopt);
+
+    for (int i = 0; i < moveQuery.moveCount; i++) {
+        const BoardMove& boardMove = moveQuery.moves[i];
+        if (!IsCapture(boardMove, gameBoard) && boardMove.move.type != MoveType::Promotion) continue;
+
+        *nextBoard = *gameBoard;
+        nextBoard->ExecuteMove(boardMove.move, boardMove.from);
+        if (MoveSearcher::IsInCheck(color, *nextBoard)) continue;
+
+        int score = -Quiescence(ply + 1, -beta, -alpha);
+        if (stopped) return 0;
+
+        if (score >= beta) {
+            STATS_ADD(StatCounter::BetaCutoffs, 1);
+            return score;
+        }
+        if (score > alpha) alpha = score;
+    }
+    return alpha;
+}
+
+bool Searcher::ShouldStop() {
+    if (stopped) return true;
+    if (limits.nodes != 0 && nodes >= limits.nodes) {
+        stopped = true;
+    } else if (nodes % TIME_CHECK_INTERVAL == 0) {
+        if (limits.stopSignal != nullptr && limits.stopSignal->load(std::memory_order_relaxed)) {
+            stopped = true;
+        } else if (timeLimitMs != 0) {
+            stopped = GetElapsedMs() >= timeLimitMs;
+        }
+        if (sharedEntries != nullptr) sharedEntries->MergeInto(transpositionTable);
+    }
+    return stopped;
+}
+
+int64_t Searcher::GetElapsedMs() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+std::optional<int> Searcher::ProbeBitbases(int ply) const {
+    if (bitbases == nullptr || rootBitbaseResult.has_value()) return std::nullopt;
+
+    std::optional<BitbaseResult> result = bitbases->Probe(*boardStack[ply]);
+    if (!result.has_value()) return std::nullopt;
+    switch (result.value()) {
+        case BitbaseResult::Win:
+            return KNOWN_WIN_SCORE - ply;
+        case BitbaseResult::Loss:
+            return -KNOWN_WIN_SCORE + ply;
+        default:
+            return 0;
+    }
+}
+
+bool Searcher::IsRootMoveExcluded(const BoardMove &boardMove, const std::unique_ptr<GameBoard> &nextBoard) const {
+    if (std::ranges::find(excludedRootMoves, boardMove) != excludedRootMoves.end()) return true;
+    if (!rootBitbaseResult.has_value()) return false;
+
+    std::optional<BitbaseResult> childResult = bitbases->Probe(*nextBoard);
+    if (!childResult.has_value()) return false;
+    switch (rootBitbaseResult.value()) {
+        case BitbaseResult::Win:
+            return childResult.value() != BitbaseResult::Loss;
+        case BitbaseResult::Draw:
+            return childResult.value() == BitbaseResult::Win;
+        default:
+            return false;
+    }
+}
+
+std::vector<BoardMove> Searcher::GetPrincipalVariation(const BoardMove &rootMove) {
+    // Follows the hash moves from the root, the line ends where the table no longer has a legal move
+    std::vector<BoardMove> moves {rootMove};
+    std::vector<uint64_t> seenKeys {Zobrist::ComputeKey(*boardStack[0], zobristKeys)};
+    *boardStack[1] = *boardStack[0];
+    boardStack[1]->ExecuteMove(rootMove.move, rootMove.from);
+    for (int ply = 1; ply < MAX_SEARCH_PLY; ply++) {
+        const std::unique_ptr<GameBoard>& gameBoard = boardStack[ply];
+        uint64_t key = Zobrist::ComputeKey(*gameBoard, zobristKeys);
+        // A repetition would loop forever
+        if (std::ranges::find(seenKeys, key) != seenKeys.end()) break;
+        seenKeys.push_back(key);
+
+        const TTEntry* entry = transpositionTable.Probe(key);
+        if (entry == nullptr) break;
+        MoveSearcher::GetAllMoves(moveStack[ply], *gameBoard);
+        std::optional<BoardMove> hashMove = TranspositionTable::FindMove(entry->move, moveStack[ply]);
+        if (!hashMove.has_value()) break;
+
+        PieceColor color = gameBoard->GetSideToMove();
+        *boardStack[ply + 1] = *gameBoard;
+        boardStack[ply + 1]->ExecuteMove(hashMove->move, hashMove->from);
+        if (MoveSearcher::IsInCheck(color, *boardStack[ply + 1])) break;
+        moves.push_back(hashMove.value());
+    }
+    return moves;
+}
+
+void Searcher::OrderMoves(BoardMoveQuery &moveQuery, const std::unique_ptr<GameBoard> &gameBoard, const std::optional<BoardMove> &firstMove) const {
+    std::array<int, MAX_BOARD_MOVES> scores;
+    for (int i = 0; i < moveQuery.moveCount; i++) {
+        const BoardMove& boardMove = moveQuery.moves[i];
+        int score = 0;
+        if (firstMove.has_value() && boardMove == firstMove.value()) {
+            score = INFINITE_SCORE;
+        } else {
+            // Most valuable victim, least valuable attacker
+            const Piece& victim = gameBoard->GetPiece(boardMove.move.position);
+            const Piece& attacker = gameBoard->GetPiece(boardMove.from);
+            if (victim.type != PieceType::None || boardMove.move.type == MoveType::EnPassant) {
+                int victimValue = boardMove.move.type == MoveType::EnPassant ? Evaluator::GetPieceValue(PieceType::Pawn) : Evaluator::GetPieceValue(victim.type);
+                score = 10 * victimValue - Evaluator::GetPieceValue(attacker.type) / 10;
+            }
+            if (boardMove.move.type == MoveType::Promotion) {
+                score += Evaluator::GetPieceValue(boardMove.move.promotion);
+            }
+        }
+        scores[i] = score;
+    }
+
+    // Move lists are short, insertion sort keeps the order stable
+    for (int i = 1; i < moveQuery.moveCount; i++) {
+        BoardMove boardMove = moveQuery.moves[i];
+        int score = scores[i];
+        int j = i - 1;
+        while (j >= 0 && scores[j] < score) {
+            moveQuery.moves[j + 1] = moveQuery.moves[j];
+            scores[j + 1] = scores[j];
+            j--;
+        }
+        moveQuery.moves[j + 1] = boardMove;
+        scores[j + 1] = score;
+    }
+}
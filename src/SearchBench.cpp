@@ -0,0 +1,323 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/SearchBench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <thread>
+
+#include "../include/ArgParse.h"
+#include "../include/BatchMoveGen.h"
+#include "../include/Search.h"
+
+#ifndef CHESSENGINE_COMMIT
+#define CHESSENGINE_COMMIT "unknown"
+#endif
+
+namespace {
+    // Openings, middlegames and endgames, including stalemates and the special moves. Editing the list changes the signature
+    constexpr const char* BENCH_FENS[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+        "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+        "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+        "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+        "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+        "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+        "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+        "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+        "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+        "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+        "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+        "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+        "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+        "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+        "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/3N4 b - - 0 1",
+        "3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+        "2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+        "8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+        "7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+        "8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+        "8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+        "8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+        "8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+        "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+        "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+        "1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+        "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+        "8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 w - - 0 1",
+        "5rk1/q6p/2p3bR/1pPp1rP1/1P1Pp3/P3B1Q1/1K3P2/R7 w - - 93 90",
+        "4rrk1/1p1nq3/p7/2p1P1pp/3P2bp/3Q1Bn1/PPPB4/1K2R1NR w - - 40 21",
+        "r3k2r/3nnpbp/q2pp1p1/p7/Pp1PPPP1/4BNN1/1P5P/R2Q1RK1 w kq - 0 16",
+        "3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
+        "4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1",
+        "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+        "8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+        "8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+        "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+        "8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+        "8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+        "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+        "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+        "r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+        "8/8/8/8/8/6k1/6p1/6K1 w - - 0 1",
+        "7k/7P/6K1/8/3B4/8/8/8 b - - 0 1",
+        "rnbqkb1r/pp1p1ppp/2p5/4P3/2B5/8/PPP1NnPP/RNBQK2R w KQkq - 0 6",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+        "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+    };
+
+    // Perfts with known counts, so a task the pool lost or ran twice shows up as a wrong total
+    struct ScalingPerft {
+        const char* fen;
+        int depth;
+        uint64_t nodes;
+    };
+
+    constexpr ScalingPerft SCALING_PERFTS[] = {
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609},
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603},
+    };
+    // Subtrees this shallow are counted by the worker that reaches them
+    constexpr int SCALING_SERIAL_DEPTH = 2;
+
+    struct ScalingWorker {
+        Searcher searcher;
+        std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    };
+
+    uint64_t CountSerialPerft(const Position &position, int depth) {
+        if (depth == 0) return 1;
+        if (depth == 1) return BatchMoveGen::CountLegalMoves(position);
+        BoardMoveQuery moveQuery;
+        MoveSearcher::GetLegalMoves(moveQuery, position);
+        uint64_t nodes = 0;
+        for (int i = 0; i < moveQuery.moveCount; i++) {
+            Position nextPosition = position;
+            nextPosition.ExecuteMove(moveQuery.moves[i].move, moveQuery.moves[i].from);
+            nodes += CountSerialPerft(nextPosition, depth - 1);
+        }
+        return nodes;
+    }
+
+    std::string EscapeJson(const std::string &text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+}
+
+bool SearchBenchOptions::ParseArgs(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--depth" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], depth)) return false;
+        } else if (arg == "--hash" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], hashMb)) return false;
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (arg == "--scaling") {
+            scaling = true;
+        }
+    }
+    return threadPool.ParseArgs(argc, argv);
+}
+
+SearchBench::SearchBench(SearchBenchOptions options) : options(std::move(options)) {
+}
+
+int SearchBench::Run() {
+    if (options.scaling) return RunScaling();
+
+    Searcher searcher;
+    searcher.SetHashSize(options.hashMb);
+    SearchLimits limits;
+    limits.depth = options.depth;
+
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    SearchBenchResult result;
+    auto startTime = std::chrono::steady_clock::now();
+    for (const char* fen : BENCH_FENS) {
+        if (!gameBoard->LoadFen(fen)) {
+            std::cerr << "Invalid bench FEN: " << fen << '\n';
+            return 1;
+        }
+        result.nodes += searcher.Search(gameBoard, limits).nodes;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    result.timeMs = static_cast<int64_t>(seconds * 1000);
+    result.nodesPerSecond = static_cast<uint64_t>(result.nodes / std::max(seconds, 1e-9));
+
+    std::cout << "positions " << std::size(BENCH_FENS) << " depth " << options.depth << " hash " << searcher.GetHashSizeMb() << '\n'
+              << "nodes " << result.nodes << " time_ms " << result.timeMs << " nps " << result.nodesPerSecond << '\n';
+    if (!options.jsonPath.empty() && !WriteJson(result)) return 1;
+    return 0;
+}
+
+int SearchBench::RunScaling() {
+    int maxThreads = options.threadPool.threads > 0 ? options.threadPool.threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::cout << "positions " << std::size(BENCH_FENS) << " depth " << options.depth << " hash " << options.hashMb
+              << " per worker, perft positions " << std::size(SCALING_PERFTS) << '\n';
+    std::cout << std::fixed << std::setprecision(2);
+    SearchBenchResult baseResults[2];
+    bool valid = true;
+    for (int threads : threadCounts) {
+        ThreadPoolOptions poolOptions = options.threadPool;
+        poolOptions.threads = threads;
+        ThreadPool threadPool(poolOptions);
+
+        for (int workload = 0; workload < 2; workload++) {
+            ThreadPoolStats startStats = threadPool.GetStats();
+            SearchBenchResult result = workload == 0 ? RunScalingSearches(threadPool) : RunScalingPerft(threadPool);
+            ThreadPoolStats stats = threadPool.GetStats();
+            if (threads == 1) baseResults[workload] = result;
+
+            double speedup = static_cast<double>(baseResults[workload].timeMs) / std::max<int64_t>(result.timeMs, 1);
+            std::cout << (workload == 0 ? "search" : "perft") << " threads " << threads << " nodes " << result.nodes
+                      << " time_ms " << result.timeMs << " nps " << result.nodesPerSecond << " speedup " << speedup
+                      << " efficiency " << speedup / threads << " tasks " << stats.executed - startStats.executed
+                      << " steals " << stats.stolen - startStats.stolen << '\n';
+            // Every thread count does the same work, a different total means a task was lost or repeated
+            if (result.nodes == 0 || result.nodes != baseResults[workload].nodes) {
+                std::cerr << "Node count differs from the single thread run\n";
+                valid = false;
+            }
+        }
+    }
+    return valid ? 0 : 1;
+}
+
+SearchBenchResult SearchBench::RunScalingSearches(ThreadPool &threadPool) {
+    SearchLimits limits;
+    limits.depth = options.depth;
+    std::vector<std::unique_ptr<ScalingWorker>> workers(threadPool.GetWorkerCount());
+    std::atomic<uint64_t> nodes = 0;
+
+    auto startTime = std::chrono::steady_clock::now();
+    TaskGroup taskGroup(threadPool);
+    for (const char* fen : BENCH_FENS) {
+        taskGroup.Run([this, &workers, &nodes, &limits, fen] {
+            std::unique_ptr<ScalingWorker>& worker = workers[ThreadPool::GetWorkerIndex()];
+            if (!worker) {
+                worker = std::make_unique<ScalingWorker>();
+                worker->searcher.SetHashSize(options.hashMb);
+            }
+            if (!worker->gameBoard->LoadFen(fen)) return;
+            // Each search starts from an empty table so the total does not depend on which worker ran what
+            worker->searcher.ClearHash();
+            nodes += worker->searcher.Search(worker->gameBoard, limits).nodes;
+        });
+    }
+    taskGroup.Wait();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    SearchBenchResult result;
+    result.nodes = nodes;
+    result.timeMs = static_cast<int64_t>(seconds * 1000);
+    result.nodesPerSecond = static_cast<uint64_t>(result.nodes / std::max(seconds, 1e-9));
+    return result;
+}
+
+SearchBenchResult SearchBench::RunScalingPerft(ThreadPool &threadPool) {
+    SearchBenchResult result;
+    auto startTime = std::chrono::steady_clock::now();
+    for (const ScalingPerft& scalingPerft : SCALING_PERFTS) {
+        GameBoard gameBoard;
+        gameBoard.LoadFen(scalingPerft.fen);
+        uint64_t nodes = 0;
+        TaskGroup taskGroup(threadPool);
+        taskGroup.Run([&threadPool, &gameBoard, &nodes, &scalingPerft] {
+            nodes = CountPerft(threadPool, gameBoard, scalingPerft.depth);
+        });
+        taskGroup.Wait();
+        if (nodes != scalingPerft.nodes) {
+            std::cerr << "Perft of " << scalingPerft.fen << " gave " << nodes << ", expected " << scalingPerft.nodes << '\n';
+            result.nodes = 0;
+            break;
+        }
+        result.nodes += nodes;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    result.timeMs = static_cast<int64_t>(seconds * 1000);
+    result.nodesPerSecond = static_cast<uint64_t>(result.nodes / std::max(seconds, 1e-9));
+    return result;
+}
+
+uint64_t SearchBench::CountPerft(ThreadPool &threadPool, const Position &position, int depth) {
+    if (depth <= SCALING_SERIAL_DEPTH) return CountSerialPerft(position, depth);
+
+    // One nested group per node, the waiting worker runs its children itself until a thief takes them
+    BoardMoveQuery moveQuery;
+    MoveSearcher::GetLegalMoves(moveQuery, position);
+    std::vector<uint64_t> childNodes(moveQuery.moveCount);
+    TaskGroup taskGroup(threadPool);
+    for (int i = 0; i < moveQuery.moveCount; i++) {
+        taskGroup.Run([&threadPool, &position, &moveQuery, &childNodes, depth, i] {
+            Position nextPosition = position;
+            nextPosition.ExecuteMove(moveQuery.moves[i].move, moveQuery.moves[i].from);
+            childNodes[i] = CountPerft(threadPool, nextPosition, depth - 1);
+        });
+    }
+    taskGroup.Wait();
+
+    uint64_t nodes = 0;
+    for (uint64_t count : childNodes) nodes += count;
+    return nodes;
+}
+
+bool SearchBench::WriteJson(const SearchBenchResult &result) const {
+    std::ofstream output(options.jsonPath);
+    if (!output) {
+        std::cerr << "Failed to open bench output: " << options.jsonPath << '\n';
+        return false;
+    }
+    output << "{\"commit\":\"" << EscapeJson(CHESSENGINE_COMMIT) << "\",\"compiler\":\"" << EscapeJson(GetCompiler())
+           << "\",\"cpu\":\"" << EscapeJson(GetCpuModel()) << "\",\"positions\":" << std::size(BENCH_FENS)
+           << ",\"depth\":" << options.depth << ",\"hash_mb\":" << options.hashMb << ",\"nodes\":" << result.nodes
+           << ",\"time_ms\":" << result.timeMs << ",\"nps\":" << result.nodesPerSecond << "}\n";
+    return static_cast<bool>(output);
+}
+
+std::string SearchBench::GetCompiler() {
+#if defined(__clang__)
+    return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc " + std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+}
+
+std::string SearchBench::GetCpuModel() {
+    std::ifstream cpuInfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuInfo, line)) {
+        if (line.rfind("model name", 0) != 0) continue;
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) break;
+        size_t start = line.find_first_not_of(' ', colon + 1);
+        return start == std::string::npos ? "unknown" : line.substr(start);
+    }
+    return "unknown";
+}
@@ -0,0 +1,136 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/Stats.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define STATS_HAS_TSC 1
+#endif
+
+namespace {
+    struct StatsClock {
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        uint64_t startTicks = Stats::ReadTicks();
+    };
+
+    // Namespace scope so the clock starts with the process rather than the first recorded stat
+    const StatsClock statsClock;
+
+#ifdef CHESSENGINE_STATS
+    struct StatsRegistry {
+        std::mutex mutex;
+        // Blocks outlive their threads so totals keep what finished workers recorded
+        std::vector<std::unique_ptr<ThreadStats>> threadStats;
+    };
+
+    StatsRegistry& GetStatsRegistry() {
+        static StatsRegistry statsRegistry;
+        return statsRegistry;
+    }
+#endif
+}
+
+StatsSnapshot Stats::Snapshot() {
+    StatsSnapshot snapshot;
+#ifdef CHESSENGINE_STATS
+    StatsRegistry& registry = GetStatsRegistry();
+    std::lock_guard lock(registry.mutex);
+    for (const std::unique_ptr<ThreadStats>& threadStats : registry.threadStats) {
+        for (int i = 0; i < STAT_COUNTER_COUNT; i++) {
+            snapshot.counters[i] += threadStats->counters[i].load(std::memory_order_relaxed);
+        }
+        for (int i = 0; i < STAT_TIMER_COUNT; i++) {
+            snapshot.timerTicks[i] += threadStats->timerTicks[i].load(std::memory_order_relaxed);
+            snapshot.timerCalls[i] += threadStats->timerCalls[i].load(std::memory_order_relaxed);
+        }
+    }
+#endif
+
+    snapshot.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - statsClock.startTime).count();
+    snapshot.ticksPerSecond = GetTicksPerSecond();
+    return snapshot;
+}
+
+void Stats::WriteJson(std::ostream &output, const StatsSnapshot &snapshot) {
+    output << "{\"enabled\":" << (IsEnabled() ? "true" : "false") << ",\"seconds\":" << snapshot.seconds << ",\"counters\":{";
+    for (int i = 0; i < STAT_COUNTER_COUNT; i++) {
+        if (i > 0) output << ',';
+        output << '"' << GetCounterName(static_cast<StatCounter>(i)) << "\":" << snapshot.counters[i];
+    }
+    output << "},\"timers\":{";
+    for (int i = 0; i < STAT_TIMER_COUNT; i++) {
+        double milliseconds = snapshot.timerTicks[i] / snapshot.ticksPerSecond * 1000.0;
+        double nanosecondsPerCall = snapshot.timerCalls[i] > 0 ? milliseconds * 1e6 / snapshot.timerCalls[i] : 0;
+        if (i > 0) output << ',';
+        output << '"' << GetTimerName(static_cast<StatTimer>(i)) << "\":{\"calls\":" << snapshot.timerCalls[i]
+               << ",\"ms\":" << milliseconds << ",\"ns_per_call\":" << nanosecondsPerCall << '}';
+    }
+    output << "}}\n";
+}
+
+StatCounter Stats::GetMoveCounter(PieceType pieceType) {
+    return static_cast<StatCounter>(static_cast<int>(StatCounter::KingMoves) + static_cast<int>(pieceType) - static_cast<int>(PieceType::King));
+}
+
+const char* Stats::GetCounterName(StatCounter counter) {
+    switch (counter) {
+        case StatCounter::KingMoves: return "king_moves";
+        case StatCounter::QueenMoves: return "queen_moves";
+        case StatCounter::RookMoves: return "rook_moves";
+        case StatCounter::KnightMoves: return "knight_moves";
+        case StatCounter::BishopMoves: return "bishop_moves";
+        case StatCounter::PawnMoves: return "pawn_moves";
+        case StatCounter::ExecuteMoves: return "execute_moves";
+        case StatCounter::BitBoardRecomputes: return "bitboard_recomputes";
+        case StatCounter::Nodes: return "nodes";
+        case StatCounter::QuiescenceNodes: return "quiescence_nodes";
+        case StatCounter::BetaCutoffs: return "beta_cutoffs";
+        case StatCounter::TTProbes: return "tt_probes";
+        case StatCounter::TTHits: return "tt_hits";
+        default: return "unknown";
+    }
+}
+
+const char* Stats::GetTimerName(StatTimer timer) {
+    switch (timer) {
+        case StatTimer::Search: return "search";
+        case StatTimer::MoveGeneration: return "move_generation";
+        case StatTimer::Evaluation: return "evaluation";
+        default: return "unknown";
+    }
+}
+
+uint64_t Stats::ReadTicks() {
+#ifdef STATS_HAS_TSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+double Stats::GetTicksPerSecond() {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - statsClock.startTime).count();
+    uint64_t elapsedTicks = ReadTicks() - statsClock.startTicks;
+    return seconds > 0 && elapsedTicks > 0 ? elapsedTicks / seconds : 1e9;
+}
+
+#ifdef CHESSENGINE_STATS
+ThreadStats* Stats::RegisterThread() {
+    StatsRegistry& registry = GetStatsRegistry();
+    std::lock_guard lock(registry.mutex);
+    registry.threadStats.push_back(std::make_unique<ThreadStats>());
+    return registry.threadStats.back().get();
+}
+#endif
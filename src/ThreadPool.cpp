@@ -0,0 +1,477 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/ThreadPool.h"
+
+#include <algorithm>
+#include <bit>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "../include/ArgParse.h"
+
+namespace {
+    // Rounds of looking for work before an idle worker goes to sleep, waking one costs a system call
+    constexpr int IDLE_SPINS = 64;
+
+    thread_local ThreadPool* currentPool = nullptr;
+    thread_local int currentWorkerIndex = -1;
+
+    ThreadPoolOptions sharedOptions;
+
+    uint64_t NextRandom(uint64_t &state) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    // Parses the kernel's cpulist format, such as "0-3,8-11"
+    std::vector<int> ParseCpuList(const std::string &cpuList) {
+        std::vector<int> cpus;
+        std::istringstream stream(cpuList);
+        std::string range;
+        while (std::getline(stream, range, ',')) {
+            if (range.empty() || range == "\n") continue;
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    std::vector<int> GetAllowedCpus() {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &cpuSet)) cpus.push_back(cpu);
+            }
+        }
+#endif
+        if (cpus.empty()) {
+            for (int cpu = 0; cpu < static_cast<int>(std::max(1u, std::thread::hardware_concurrency())); cpu++) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    // CPUs of each NUMA node this process may run on, one node holding everything when sysfs has no topology
+    std::vector<std::vector<int>> GetNodeCpus(const std::vector<int> &allowedCpus) {
+        std::vector<std::pair<int, std::vector<int>>> nodes;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+            std::string name = entry.path().filename().string();
+            if (!name.starts_with("node") || name.size() == 4 || name.find_first_not_of("0123456789", 4) != std::string::npos) continue;
+            std::ifstream input(entry.path() / "cpulist");
+            std::string cpuList;
+            if (!std::getline(input, cpuList)) continue;
+
+            std::vector<int> cpus;
+            for (int cpu : ParseCpuList(cpuList)) {
+                if (std::find(allowedCpus.begin(), allowedCpus.end(), cpu) != allowedCpus.end()) cpus.push_back(cpu);
+            }
+            if (!cpus.empty()) nodes.emplace_back(std::stoi(name.substr(4)), std::move(cpus));
+        }
+        std::sort(nodes.begin(), nodes.end());
+
+        std::vector<std::vector<int>> nodeCpus;
+        for (auto& node : nodes) nodeCpus.push_back(std::move(node.second));
+        if (nodeCpus.empty()) nodeCpus.push_back(allowedCpus);
+        return nodeCpus;
+    }
+
+    bool PinCurrentThread(const std::vector<int> &cpus) {
+#ifdef __linux__
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (int cpu : cpus) CPU_SET(cpu, &cpuSet);
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+        return false;
+#endif
+    }
+}
+
+bool ThreadPoolOptions::ParseArgs(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], threads)) return false;
+        } else if (arg == "--pin" && hasValue) {
+            std::string mode = argv[++i];
+            if (mode == "none") {
+                pinning = ThreadPinning::None;
+            } else if (mode == "cpu") {
+                pinning = ThreadPinning::Cpu;
+            } else if (mode == "node") {
+                pinning = ThreadPinning::Node;
+            } else {
+                std::cerr << "Unknown pinning: " << mode << ", expected none, cpu or node\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+WorkStealingDeque::Ring::Ring(int64_t capacity) : capacity(capacity), slots(std::make_unique<std::atomic<ThreadTask*>[]>(capacity)) {
+}
+
+WorkStealingDeque::WorkStealingDeque(int64_t capacity) {
+    rings.push_back(std::make_unique<Ring>(std::bit_ceil(static_cast<uint64_t>(std::max<int64_t>(capacity, 2)))));
+    ring.store(rings.back().get(), std::memory_order_relaxed);
+}
+
+void WorkStealingDeque::Push(ThreadTask *task) {
+    int64_t currentBottom = bottom.load(std::memory_order_relaxed);
+    int64_t currentTop = top.load(std::memory_order_acquire);
+    Ring* currentRing = ring.load(std::memory_order_relaxed);
+    if (currentBottom - currentTop > currentRing->capacity - 1) {
+        currentRing = Grow(currentRing, currentTop, currentBottom);
+    }
+    currentRing->Put(currentBottom, task);
+    // Publishes the task to thieves, who load bottom with acquire
+    bottom.store(currentBottom + 1, std::memory_order_release);
+}
+
+ThreadTask* WorkStealingDeque::Pop() {
+    int64_t currentBottom = bottom.load(std::memory_order_relaxed) - 1;
+    Ring* currentRing = ring.load(std::memory_order_relaxed);
+    bottom.store(currentBottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t currentTop = top.load(std::memory_order_relaxed);
+    if (currentTop > currentBottom) {
+        bottom.store(currentBottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    ThreadTask* task = currentRing->Get(currentBottom);
+    if (currentTop == currentBottom) {
+        // The last task, thieves may be taking it from the other end
+        if (!top.compare_exchange_strong(currentTop, currentTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            task = nullptr;
+        }
+        bottom.store(currentBottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+ThreadTask* WorkStealingDeque::Steal() {
+    int64_t currentTop = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t currentBottom = bottom.load(std::memory_order_acquire);
+    if (currentTop >= currentBottom) return nullptr;
+
+    ThreadTask* task = ring.load(std::memory_order_acquire)->Get(currentTop);
+    if (!top.compare_exchange_strong(currentTop, currentTop + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return task;
+}
+
+WorkStealingDeque::Ring* WorkStealingDeque::Grow(Ring *oldRing, int64_t currentTop, int64_t currentBottom) {
+    auto grownRing = std::make_unique<Ring>(oldRing->capacity * 2);
+    for (int64_t i = currentTop; i < currentBottom; i++) {
+        grownRing->Put(i, oldRing->Get(i));
+    }
+    Ring* newRing = grownRing.get();
+    rings.push_back(std::move(grownRing));
+    ring.store(newRing, std::memory_order_release);
+    return newRing;
+}
+
+ThreadPool::ThreadPool(ThreadPoolOptions options) : options(options) {
+    if (this->options.threads <= 0) {
+        this->options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(this->options.threads);
+    for (int i = 0; i < this->options.threads; i++) {
+        workers.push_back(std::make_unique<Worker>());
+        workers.back()->randomState = 0x9E3779B97F4A7C15ULL * (i + 1);
+    }
+    AssignCpus();
+
+    for (int i = 0; i < this->options.threads; i++) {
+        workers[i]->thread = std::thread(&ThreadPool::RunWorker, this, i);
+    }
+    // Every arena exists before the first task can ask for one
+    std::unique_lock lock(sleepMutex);
+    started.wait(lock, [this] { return startedWorkers == workers.size(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (const std::unique_ptr<Worker>& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+int ThreadPool::GetWorkerCount() const {
+    return static_cast<int>(workers.size());
+}
+
+int ThreadPool::GetNodeCount() const {
+    return nodeCount;
+}
+
+ThreadPoolStats ThreadPool::GetStats() const {
+    ThreadPoolStats stats;
+    for (const std::unique_ptr<Worker>& worker : workers) {
+        stats.executed += worker->executed.load(std::memory_order_relaxed);
+        stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void ThreadPool::Configure(const ThreadPoolOptions &options) {
+    sharedOptions = options;
+}
+
+ThreadPool & ThreadPool::GetShared() {
+    // Created on first use, so commands that never run tasks never start the workers
+    static ThreadPool sharedPool(sharedOptions);
+    return sharedPool;
+}
+
+int ThreadPool::GetWorkerIndex() {
+    return currentWorkerIndex;
+}
+
+std::pmr::memory_resource * ThreadPool::GetMemoryResource() {
+    if (currentPool == nullptr) return std::pmr::get_default_resource();
+    return currentPool->workers[currentWorkerIndex]->arena.get();
+}
+
+void ThreadPool::AssignCpus() {
+    if (options.pinning == ThreadPinning::None) return;
+#ifndef __linux__
+    std::cerr << "Thread pinning is only supported on Linux, workers are left unpinned\n";
+    return;
+#endif
+
+    std::vector<std::vector<int>> nodeCpus = GetNodeCpus(GetAllowedCpus());
+    nodeCount = static_cast<int>(nodeCpus.size());
+    int workerCount = static_cast<int>(workers.size());
+    if (options.pinning == ThreadPinning::Node) {
+        // Contiguous blocks of workers per node, so neighbouring workers share a node
+        for (int i = 0; i < workerCount; i++) {
+            int node = i * nodeCount / workerCount;
+            workers[i]->node = node;
+            workers[i]->cpus = nodeCpus[node];
+        }
+        return;
+    }
+
+    // CPUs in node order, workers fill one node before moving to the next
+    std::vector<std::pair<int, int>> cpus;
+    for (int node = 0; node < nodeCount; node++) {
+        for (int cpu : nodeCpus[node]) cpus.emplace_back(cpu, node);
+    }
+    for (int i = 0; i < workerCount; i++) {
+        const auto& [cpu, node] = cpus[i % cpus.size()];
+        workers[i]->node = node;
+        workers[i]->cpus = {cpu};
+    }
+}
+
+void ThreadPool::RunWorker(int index) {
+    Worker& worker = *workers[index];
+    if (!worker.cpus.empty() && !PinCurrentThread(worker.cpus)) {
+        std::cerr << "Failed to pin worker " << index << '\n';
+    }
+    // Created after pinning, so the pages are first touched from the worker's node
+    std::pmr::pool_options arenaOptions;
+    arenaOptions.largest_required_pool_block = THREAD_ARENA_LARGEST_BLOCK;
+    worker.arena = std::make_unique<std::pmr::synchronized_pool_resource>(arenaOptions);
+    currentPool = this;
+    currentWorkerIndex = index;
+    {
+        std::lock_guard lock(sleepMutex);
+        startedWorkers++;
+    }
+    started.notify_all();
+
+    int idleSpins = 0;
+    while (true) {
+        if (ThreadTask* task = FindTask(worker)) {
+            Execute(worker, task);
+            idleSpins = 0;
+            continue;
+        }
+        if (idleSpins++ < IDLE_SPINS) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Announce the sleep before the last look, a task submitted after it is sure to wake someone
+        uint64_t epoch = wakeEpoch.load(std::memory_order_acquire);
+        sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        if (ThreadTask* task = FindTask(worker)) {
+            sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+            Execute(worker, task);
+            idleSpins = 0;
+            continue;
+        }
+        std::unique_lock lock(sleepMutex);
+        wake.wait(lock, [this, epoch] { return stopping || wakeEpoch.load(std::memory_order_relaxed) != epoch; });
+        sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+        if (stopping) break;
+        idleSpins = 0;
+    }
+    currentPool = nullptr;
+    currentWorkerIndex = -1;
+}
+
+void ThreadPool::Submit(ThreadTask *task) {
+    if (currentPool == this) {
+        workers[currentWorkerIndex]->deque.Push(task);
+    } else {
+        std::lock_guard lock(injectionMutex);
+        injectedTasks.push_back(task);
+        hasInjectedTasks.store(true, std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepingWorkers.load(std::memory_order_relaxed) == 0) return;
+    {
+        std::lock_guard lock(sleepMutex);
+        wakeEpoch.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::RunPendingTask() {
+    if (currentPool != this) return false;
+    Worker& worker = *workers[currentWorkerIndex];
+    ThreadTask* task = FindTask(worker);
+    if (task == nullptr) return false;
+    Execute(worker, task);
+    return true;
+}
+
+ThreadTask * ThreadPool::FindTask(Worker &worker) {
+    if (ThreadTask* task = worker.deque.Pop()) return task;
+    if (ThreadTask* task = StealTask(worker, true)) return task;
+    if (nodeCount > 1) {
+        if (ThreadTask* task = StealTask(worker, false)) return task;
+    }
+
+    if (!hasInjectedTasks.load(std::memory_order_seq_cst)) return nullptr;
+    std::lock_guard lock(injectionMutex);
+    if (injectedTasks.empty()) return nullptr;
+    ThreadTask* task = injectedTasks.front();
+    injectedTasks.pop_front();
+    hasInjectedTasks.store(!injectedTasks.empty(), std::memory_order_relaxed);
+    return task;
+}
+
+ThreadTask * ThreadPool::StealTask(Worker &worker, bool sameNode) {
+    size_t workerCount = workers.size();
+    // A random first victim keeps thieves from all queueing on the same deque
+    size_t start = NextRandom(worker.randomState) % workerCount;
+    for (size_t i = 0; i < workerCount; i++) {
+        Worker& victim = *workers[(start + i) % workerCount];
+        if (&victim == &worker) continue;
+        if (nodeCount > 1 && (victim.node == worker.node) != sameNode) continue;
+        if (ThreadTask* task = victim.deque.Steal()) {
+            worker.stolen.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::Execute(Worker &worker, ThreadTask *task) {
+    TaskGroup* group = task->group;
+    if (!group->IsCancelled()) task->function();
+    // The captures go before the group finishes, they may point into the waiting caller's frame
+    delete task;
+    worker.executed.fetch_add(1, std::memory_order_relaxed);
+    group->Finish();
+}
+
+TaskGroup::TaskGroup() : TaskGroup(ThreadPool::GetShared()) {
+}
+
+TaskGroup::TaskGroup(ThreadPool &threadPool) : threadPool(threadPool) {
+}
+
+TaskGroup::~TaskGroup() {
+    Wait();
+}
+
+void TaskGroup::Run(std::function<void()> function) {
+    if (pendingTasks.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        std::lock_guard lock(mutex);
+        done = false;
+    }
+    threadPool.Submit(new ThreadTask{std::move(function), this});
+}
+
+void TaskGroup::RunRange(uint64_t count, uint64_t grain, std::function<void(uint64_t, uint64_t)> body) {
+    if (count == 0) return;
+    auto sharedBody = std::make_shared<std::function<void(uint64_t, uint64_t)>>(std::move(body));
+    Run([this, count, grain, sharedBody] { SplitRange(0, count, std::max<uint64_t>(grain, 1), sharedBody); });
+}
+
+void TaskGroup::SplitRange(uint64_t start, uint64_t end, uint64_t grain, const std::shared_ptr<std::function<void(uint64_t, uint64_t)>> &body) {
+    while (end - start > grain) {
+        uint64_t middle = start + (end - start) / 2;
+        Run([this, middle, end, grain, body] { SplitRange(middle, end, grain, body); });
+        end = middle;
+    }
+    if (!IsCancelled()) (*body)(start, end);
+}
+
+void TaskGroup::Wait() {
+    if (currentPool == &threadPool) {
+        // A blocked worker could hold the very tasks it waits for, so it runs them instead
+        while (pendingTasks.load(std::memory_order_acquire) != 0) {
+            if (!threadPool.RunPendingTask()) std::this_thread::yield();
+        }
+    }
+    std::unique_lock lock(mutex);
+    finished.wait(lock, [this] { return done; });
+}
+
+void TaskGroup::Cancel() {
+    cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool TaskGroup::IsCancelled() const {
+    return cancelled.load(std::memory_order_relaxed);
+}
+
+const std::atomic<bool> * TaskGroup::GetCancelSignal() const {
+    return &cancelled;
+}
+
+ThreadPool & TaskGroup::GetThreadPool() const {
+    return threadPool;
+}
+
+void TaskGroup::Finish() {
+    if (pendingTasks.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    // Checked again under the lock, Run may have added a task since
+    std::lock_guard lock(mutex);
+    if (pendingTasks.load(std::memory_order_acquire) != 0) return;
+    done = true;
+    finished.notify_all();
+}
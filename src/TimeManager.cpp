@@ -0,0 +1,101 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/TimeManager.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+    // The hard limit lets an unsettled search overrun the soft limit this many times over
+    constexpr double HARD_LIMIT_RATIO = 4.0;
+    // Each iteration costs a few times the last one, starting one past this share of the limit rarely finishes
+    constexpr double NEXT_ITERATION_SHARE = 0.6;
+    constexpr int SCORE_DROP_MARGIN = 20;
+}
+
+void TimeManager::Start(const SearchClock &clock) {
+    int64_t available = std::max<int64_t>(1, clock.remainingMs - clock.moveOverheadMs);
+    int movesToGo = clock.movesToGo > 0 ? std::min(clock.movesToGo, TIME_DEFAULT_MOVES_TO_GO) : TIME_DEFAULT_MOVES_TO_GO;
+
+    // Never plan to spend more than a fraction of what is left, however many moves remain
+    softLimitMs = std::min(available / movesToGo + clock.incrementMs * 3 / 4, available / 2);
+    hardLimitMs = std::min(static_cast<int64_t>(softLimitMs * HARD_LIMIT_RATIO), available * 4 / 5);
+    softLimitMs = std::max<int64_t>(1, softLimitMs);
+    hardLimitMs = std::max(softLimitMs, hardLimitMs);
+
+    bestMoveChanges = 0;
+    stableIterations = 0;
+    previousScore = 0;
+    scoreDropFactor = 1;
+    iterations = 0;
+}
+
+bool TimeManager::OnIteration(int64_t elapsedMs, bool bestMoveChanged, int score) {
+    bestMoveChanges = bestMoveChanges / 2 + (bestMoveChanged ? 1 : 0);
+    stableIterations = bestMoveChanged ? 0 : stableIterations + 1;
+    // A falling score means trouble the search has only just seen, so it gets longer to find a way out
+    if (iterations > 0) {
+        int drop = previousScore - score;
+        scoreDropFactor = drop > SCORE_DROP_MARGIN ? 1.0 + std::min(drop, 200) / 200.0 : std::max(1.0, scoreDropFactor * 0.9);
+    }
+    previousScore = score;
+    iterations++;
+
+    return elapsedMs < GetScaledSoftLimitMs() * NEXT_ITERATION_SHARE;
+}
+
+int64_t TimeManager::GetScaledSoftLimitMs() const {
+    double instability = 1.0 + bestMoveChanges * 0.5;
+    double stability = std::max(0.5, 1.0 - 0.1 * std::max(0, stableIterations - 2));
+    double scaled = softLimitMs * instability * stability * scoreDropFactor;
+    return std::min(hardLimitMs, static_cast<int64_t>(scaled));
+}
+
+bool TimeControl::Parse(const std::string &text) {
+    size_t periodSeparator = text.find('/');
+    size_t baseStart = periodSeparator == std::string::npos ? 0 : periodSeparator + 1;
+    size_t separator = text.find('+', baseStart);
+    try {
+        int moves = periodSeparator == std::string::npos ? 0 : std::stoi(text.substr(0, periodSeparator));
+        double baseSeconds = std::stod(text.substr(baseStart, separator == std::string::npos ? std::string::npos : separator - baseStart));
+        double incrementSeconds = separator == std::string::npos ? 0 : std::stod(text.substr(separator + 1));
+        if (moves < 0 || baseSeconds < 0 || incrementSeconds < 0) return false;
+        movesPerPeriod = moves;
+        baseMs = static_cast<int64_t>(baseSeconds * 1000);
+        incrementMs = static_cast<int64_t>(incrementSeconds * 1000);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+bool TimeControl::IsEnabled() const {
+    return baseMs > 0 || incrementMs > 0;
+}
+
+std::string TimeControl::ToString() const {
+    std::ostringstream text;
+    if (movesPerPeriod > 0) text << movesPerPeriod << '/';
+    text << baseMs / 1000.0 << '+' << incrementMs / 1000.0;
+    return text.str();
+}
+
+SearchClock TimeControl::GetClock(int64_t remainingMs, int movesMade) const {
+    SearchClock clock;
+    if (!IsEnabled()) return clock;
+    clock.remainingMs = std::max<int64_t>(1, remainingMs);
+    clock.incrementMs = incrementMs;
+    clock.movesToGo = movesPerPeriod > 0 ? movesPerPeriod - movesMade % movesPerPeriod : 0;
+    clock.moveOverheadMs = moveOverheadMs;
+    return clock;
+}
+
+bool TimeControl::OnMoveMade(int64_t &remainingMs, int64_t elapsedMs, int movesMade) const {
+    remainingMs -= elapsedMs;
+    if (remainingMs < 0) return false;
+    remainingMs += incrementMs;
+    if (movesPerPeriod > 0 && (movesMade + 1) % movesPerPeriod == 0) remainingMs += baseMs;
+    return true;
+}
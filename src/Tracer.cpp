@@ -0,0 +1,115 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/Tracer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    struct TraceRegistry {
+        std::mutex mutex;
+        // Buffers outlive their threads so finished workers still show up in the trace
+        std::vector<std::unique_ptr<TraceBuffer>> traceBuffers;
+        uint64_t startTicks = 0;
+    };
+
+    TraceRegistry& GetTraceRegistry() {
+        static TraceRegistry traceRegistry;
+        return traceRegistry;
+    }
+
+    // Piece move events carry the piece type, name them after the helper that ran
+    const char* GetRecordName(const TraceRecord &record) {
+        static constexpr const char* PIECE_MOVE_NAMES[] = {"GetValidMoves", "GetKingMoves", "GetQueenMoves", "GetRookMoves", "GetKnightMoves", "GetBishopMoves", "GetPawnMoves"};
+        if (record.event == TraceEvent::PieceMoves && record.value >= 0 && record.value < static_cast<int32_t>(std::size(PIECE_MOVE_NAMES))) {
+            return PIECE_MOVE_NAMES[record.value];
+        }
+        return Tracer::GetEventName(record.event);
+    }
+}
+
+void Tracer::Start(uint32_t sampleInterval) {
+    TraceRegistry& registry = GetTraceRegistry();
+    {
+        std::lock_guard lock(registry.mutex);
+        registry.startTicks = Stats::ReadTicks();
+    }
+    Tracer::sampleInterval.store(std::max(1u, sampleInterval), std::memory_order_relaxed);
+    active.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Stop() {
+    active.store(false, std::memory_order_relaxed);
+}
+
+bool Tracer::WriteJson(const std::string &path) {
+    std::ofstream output(path);
+    if (!output) {
+        std::cerr << "Failed to open trace output: " << path << '\n';
+        return false;
+    }
+
+    TraceRegistry& registry = GetTraceRegistry();
+    std::lock_guard lock(registry.mutex);
+    double ticksPerMicrosecond = Stats::GetTicksPerSecond() / 1e6;
+    std::vector<TraceRecord> records;
+    bool first = true;
+
+    output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (const std::unique_ptr<TraceBuffer>& traceBuffer : registry.traceBuffers) {
+        if (!first) output << ',';
+        first = false;
+        output << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << traceBuffer->threadIndex
+               << ",\"args\":{\"name\":\"worker " << traceBuffer->threadIndex << "\"}}";
+
+        // Only the last TRACE_BUFFER_RECORDS survive a wrap
+        uint64_t head = traceBuffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > TRACE_BUFFER_RECORDS ? head - TRACE_BUFFER_RECORDS : 0;
+        records.clear();
+        for (uint64_t i = begin; i < head; i++) {
+            const TraceRecord& record = traceBuffer->records[i % TRACE_BUFFER_RECORDS];
+            if (record.startTicks >= registry.startTicks) records.push_back(record);
+        }
+        std::sort(records.begin(), records.end(), [](const TraceRecord &a, const TraceRecord &b) {
+            return a.startTicks < b.startTicks;
+        });
+
+        for (const TraceRecord& record : records) {
+            double timestamp = (record.startTicks - registry.startTicks) / ticksPerMicrosecond;
+            double duration = (record.endTicks - record.startTicks) / ticksPerMicrosecond;
+            output << ",\n{\"name\":\"" << GetRecordName(record) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << traceBuffer->threadIndex
+                   << ",\"ts\":" << timestamp << ",\"dur\":" << duration << ",\"args\":{\"value\":" << record.value << "}}";
+        }
+    }
+    output << "\n]}\n";
+    return static_cast<bool>(output);
+}
+
+const char* Tracer::GetEventName(TraceEvent event) {
+    switch (event) {
+        case TraceEvent::Iteration: return "Iteration";
+        case TraceEvent::RootMove: return "RootMove";
+        case TraceEvent::MoveGeneration: return "GetAllMoves";
+        case TraceEvent::PieceMoves: return "GetValidMoves";
+        case TraceEvent::ExecuteMove: return "ExecuteMove";
+        case TraceEvent::Evaluation: return "Evaluate";
+        default: return "Unknown";
+    }
+}
+
+#ifdef CHESSENGINE_TRACE
+TraceBuffer* Tracer::RegisterThread() {
+    TraceRegistry& registry = GetTraceRegistry();
+    std::lock_guard lock(registry.mutex);
+    registry.traceBuffers.push_back(std::make_unique<TraceBuffer>());
+    registry.traceBuffers.back()->threadIndex = static_cast<int>(registry.traceBuffers.size());
+    return registry.traceBuffers.back().get();
+}
+#endif
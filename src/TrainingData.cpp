@@ -0,0 +1,313 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/TrainingData.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+#include "../include/Zobrist.h"
+
+// Records are used in place from the mapping, which only matches the file layout on little endian hosts
+static_assert(std::endian::native == std::endian::little);
+
+namespace {
+    constexpr uint8_t BLACK_TO_MOVE = 1 << 0;
+    constexpr int CASTLE_SHIFT = 1;
+    constexpr uint8_t BLACK_PIECE = 1 << 3;
+    constexpr size_t SHUFFLE_BUFFER_POSITIONS = 4096;
+
+    uint8_t GetPieceCode(const Piece &piece) {
+        uint8_t code = static_cast<uint8_t>(piece.type);
+        return piece.color == PieceColor::Black ? code | BLACK_PIECE : code;
+    }
+
+    bool WritePositions(std::ofstream &output, const PackedPosition* positions, size_t count) {
+        output.write(reinterpret_cast<const char*>(positions), static_cast<std::streamsize>(count * sizeof(PackedPosition)));
+        return static_cast<bool>(output);
+    }
+}
+
+PackedPosition TrainingData::Pack(const GameBoard &gameBoard, int score, GameResult result, int ply) {
+    PackedPosition packedPosition {};
+    int pieceIndex = 0;
+    for (int bit = 0; bit < BOARD_SIZE; bit++) {
+        const Piece& piece = gameBoard.GetPiece(PiecePosition{static_cast<short>(bit / GRID_SIZE), static_cast<short>(bit % GRID_SIZE)});
+        if (piece.type == PieceType::None) continue;
+
+        packedPosition.occupancy |= 1ULL << bit;
+        packedPosition.pieces[pieceIndex / 2] |= GetPieceCode(piece) << (pieceIndex % 2 * 4);
+        if (++pieceIndex == 32) break;
+    }
+
+    packedPosition.score = static_cast<int16_t>(std::clamp(score, -INT16_MAX, static_cast<int>(INT16_MAX)));
+    SetResult(packedPosition, result);
+    packedPosition.flags = Zobrist::GetCastleRights(gameBoard) << CASTLE_SHIFT;
+    if (gameBoard.GetSideToMove() == PieceColor::Black) packedPosition.flags |= BLACK_TO_MOVE;
+    if (std::optional<int> enPassantFile = Zobrist::GetEnPassantFile(gameBoard)) {
+        packedPosition.enPassantFile = static_cast<uint8_t>(enPassantFile.value() + 1);
+    }
+    packedPosition.halfmoveClock = static_cast<uint8_t>(std::min(gameBoard.GetHalfmoveClock(), 255));
+    packedPosition.ply = static_cast<uint16_t>(std::min(ply, static_cast<int>(UINT16_MAX)));
+    return packedPosition;
+}
+
+bool TrainingData::Unpack(const PackedPosition &packedPosition, GameBoard &gameBoard) {
+    if (std::popcount(packedPosition.occupancy) > 32 || packedPosition.result > 2) return false;
+    gameBoard.ClearBoard();
+
+    uint64_t occupancy = packedPosition.occupancy;
+    uint64_t blackOccupancy = 0;
+    int pieceIndex = 0;
+    while (occupancy != 0) {
+        int bit = std::countr_zero(occupancy);
+        occupancy &= occupancy - 1;
+
+        uint8_t code = (packedPosition.pieces[pieceIndex / 2] >> (pieceIndex % 2 * 4)) & 0xF;
+        pieceIndex++;
+        uint8_t type = code & ~BLACK_PIECE;
+        if (type < static_cast<uint8_t>(PieceType::King) || type > static_cast<uint8_t>(PieceType::Pawn)) return false;
+
+        PiecePosition piecePosition{static_cast<short>(bit / GRID_SIZE), static_cast<short>(bit % GRID_SIZE)};
+        PieceColor color = code & BLACK_PIECE ? PieceColor::Black : PieceColor::White;
+        if (color == PieceColor::Black) blackOccupancy |= 1ULL << bit;
+        // Move state is what the move generator reads for double pushes and castling rights
+        bool homePawn = type == static_cast<uint8_t>(PieceType::Pawn) && piecePosition.row == (color == PieceColor::White ? 1 : GRID_SIZE - 2);
+        gameBoard.SetPiece(piecePosition, Piece{static_cast<PieceType>(type), color, homePawn ? PieceMoveState::NotMoved : PieceMoveState::Moved});
+    }
+
+    uint8_t castleRights = packedPosition.flags >> CASTLE_SHIFT;
+    for (int right = 0; right < 4; right++) {
+        if (!(castleRights & (1 << right))) continue;
+        // WhiteShort, WhiteLong, BlackShort, BlackLong
+        short homeRow = right < 2 ? 0 : GRID_SIZE - 1;
+        short rookCol = right % 2 == 0 ? 0 : GRID_SIZE - 1;
+        for (PiecePosition piecePosition : {PiecePosition{homeRow, 3}, PiecePosition{homeRow, rookCol}}) {
+            Piece piece = gameBoard.GetPiece(piecePosition);
+            piece.moveState = PieceMoveState::NotMoved;
+            gameBoard.SetPiece(piecePosition, piece);
+        }
+    }
+
+    PieceColor lastMoveColor = packedPosition.flags & BLACK_TO_MOVE ? PieceColor::White : PieceColor::Black;
+    gameBoard.SetLastMove(PieceMove{}, Piece{PieceType::None, lastMoveColor});
+    // En passant is encoded as the double pawn push that made it possible
+    if (packedPosition.enPassantFile != 0) {
+        short pawnRow = lastMoveColor == PieceColor::White ? 3 : 4;
+        PiecePosition pawnPosition{pawnRow, static_cast<short>(GRID_SIZE - packedPosition.enPassantFile)};
+        if (pawnPosition.OutOfBounds()) return false;
+        const Piece& pawn = gameBoard.GetPiece(pawnPosition);
+        if (pawn.type != PieceType::Pawn || pawn.color != lastMoveColor) return false;
+        gameBoard.SetLastMove(PieceMove{MoveType::DoublePawnPush, pawnPosition}, pawn);
+    }
+
+    gameBoard.SetHalfmoveClock(packedPosition.halfmoveClock);
+    // Same result as CalculateBitBoards without rescanning the board
+    gameBoard.SetColorBitBoards(PieceColor::White, ColorBitBoards{packedPosition.occupancy & ~blackOccupancy, 0, 0});
+    gameBoard.SetColorBitBoards(PieceColor::Black, ColorBitBoards{blackOccupancy, 0, 0});
+    return true;
+}
+
+GameResult TrainingData::GetResult(const PackedPosition &packedPosition) {
+    switch (packedPosition.result) {
+        case 0:
+            return GameResult::BlackWins;
+        case 2:
+            return GameResult::WhiteWins;
+        default:
+            return GameResult::Draw;
+    }
+}
+
+void TrainingData::SetResult(PackedPosition &packedPosition, GameResult result) {
+    switch (result) {
+        case GameResult::BlackWins:
+            packedPosition.result = 0;
+            break;
+        case GameResult::Draw:
+            packedPosition.result = 1;
+            break;
+        case GameResult::WhiteWins:
+            packedPosition.result = 2;
+            break;
+    }
+}
+
+std::string TrainingData::GetShardPath(const std::string &prefix, int shard) {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%05d", shard);
+    return prefix + suffix + TRAINING_DATA_EXTENSION;
+}
+
+bool TrainingData::Shuffle(const std::vector<std::string> &inputPaths, const std::string &outputPrefix, int shardCount, uint64_t seed) {
+    if (shardCount <= 0) return false;
+    std::mt19937_64 random(seed);
+
+    std::vector<std::ofstream> shardOutputs(shardCount);
+    std::vector<std::vector<PackedPosition>> shardBuffers(shardCount);
+    for (int shard = 0; shard < shardCount; shard++) {
+        shardOutputs[shard].open(GetShardPath(outputPrefix, shard), std::ios::binary | std::ios::trunc);
+        if (!shardOutputs[shard]) {
+            std::cerr << "Failed to create " << GetShardPath(outputPrefix, shard) << '\n';
+            return false;
+        }
+        shardBuffers[shard].reserve(SHUFFLE_BUFFER_POSITIONS);
+    }
+
+    for (const std::string& inputPath : inputPaths) {
+        TrainingDataReader reader;
+        if (!reader.Open(inputPath)) {
+            std::cerr << "Failed to open training data: " << inputPath << '\n';
+            return false;
+        }
+        for (const PackedPosition& packedPosition : reader.GetPositions()) {
+            int shard = static_cast<int>(random() % shardCount);
+            std::vector<PackedPosition>& buffer = shardBuffers[shard];
+            buffer.push_back(packedPosition);
+            if (buffer.size() < SHUFFLE_BUFFER_POSITIONS) continue;
+            if (!WritePositions(shardOutputs[shard], buffer.data(), buffer.size())) return false;
+            buffer.clear();
+        }
+    }
+    for (int shard = 0; shard < shardCount; shard++) {
+        if (!WritePositions(shardOutputs[shard], shardBuffers[shard].data(), shardBuffers[shard].size())) return false;
+        shardOutputs[shard].close();
+    }
+
+    // Each shard now holds a random subset, shuffling it in memory finishes a uniform permutation
+    for (int shard = 0; shard < shardCount; shard++) {
+        std::string path = GetShardPath(outputPrefix, shard);
+        std::vector<PackedPosition> positions;
+        {
+            TrainingDataReader reader;
+            if (!reader.Open(path)) return false;
+            std::span<const PackedPosition> mapped = reader.GetPositions();
+            positions.assign(mapped.begin(), mapped.end());
+        }
+        std::shuffle(positions.begin(), positions.end(), random);
+
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        if (!WritePositions(output, positions.data(), positions.size())) {
+            std::cerr << "Failed to write " << path << '\n';
+            return false;
+        }
+    }
+    return true;
+}
+
+TrainingDataWriter::~TrainingDataWriter() {
+    Close();
+}
+
+bool TrainingDataWriter::Open(const std::string &prefix, uint64_t shardPositions) {
+    this->prefix = prefix;
+    this->shardPositions = std::max<uint64_t>(1, shardPositions);
+    shardIndex = 0;
+    written = 0;
+    failed = false;
+    closing = false;
+    if (!OpenShard()) return false;
+
+    writerThread = std::thread(&TrainingDataWriter::WriteLoop, this);
+    return true;
+}
+
+void TrainingDataWriter::Submit(std::vector<PackedPosition> &buffer) {
+    if (buffer.empty()) return;
+
+    std::lock_guard lock(mutex);
+    pending.push_back(std::move(buffer));
+    if (spareBuffers.empty()) {
+        buffer = std::vector<PackedPosition>();
+        buffer.reserve(TRAINING_BUFFER_POSITIONS);
+    } else {
+        buffer = std::move(spareBuffers.back());
+        spareBuffers.pop_back();
+    }
+    pendingReady.notify_one();
+}
+
+bool TrainingDataWriter::Close() {
+    if (writerThread.joinable()) {
+        {
+            std::lock_guard lock(mutex);
+            closing = true;
+            pendingReady.notify_one();
+        }
+        writerThread.join();
+    }
+    if (output.is_open()) {
+        output.close();
+        if (!output) failed = true;
+    }
+    return !failed;
+}
+
+uint64_t TrainingDataWriter::GetWritten() const {
+    std::lock_guard lock(mutex);
+    return written;
+}
+
+void TrainingDataWriter::WriteLoop() {
+    while (true) {
+        std::vector<PackedPosition> buffer;
+        {
+            std::unique_lock lock(mutex);
+            pendingReady.wait(lock, [this] { return !pending.empty() || closing; });
+            if (pending.empty()) return;
+            buffer = std::move(pending.front());
+            pending.pop_front();
+        }
+
+        // A buffer can straddle the end of a shard
+        size_t offset = 0;
+        while (offset < buffer.size() && !failed) {
+            if (shardWritten == shardPositions && !OpenShard()) break;
+            size_t count = std::min<uint64_t>(buffer.size() - offset, shardPositions - shardWritten);
+            if (!WritePositions(output, buffer.data() + offset, count)) failed = true;
+            offset += count;
+            shardWritten += count;
+        }
+
+        std::lock_guard lock(mutex);
+        written += offset;
+        buffer.clear();
+        spareBuffers.push_back(std::move(buffer));
+    }
+}
+
+bool TrainingDataWriter::OpenShard() {
+    if (output.is_open()) output.close();
+    std::string path = TrainingData::GetShardPath(prefix, shardIndex++);
+    output.open(path, std::ios::binary | std::ios::trunc);
+    shardWritten = 0;
+    if (!output) {
+        std::cerr << "Failed to create " << path << '\n';
+        failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool TrainingDataReader::Open(const std::string &path, MappedFileAccess access) {
+    if (!mappedFile.Open(path, access)) return false;
+    if (mappedFile.GetSize() % sizeof(PackedPosition) != 0) {
+        std::cerr << path << " is not a whole number of " << sizeof(PackedPosition) << " byte records\n";
+        mappedFile.Close();
+        return false;
+    }
+    return true;
+}
+
+std::span<const PackedPosition> TrainingDataReader::GetPositions() const {
+    if (mappedFile.GetSize() == 0) return {};
+    return {reinterpret_cast<const PackedPosition*>(mappedFile.GetData()), GetCount()};
+}
+
+uint64_t TrainingDataReader::GetCount() const {
+    return mappedFile.GetSize() / sizeof(PackedPosition);
+}
@@ -0,0 +1,141 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/TrainingDataGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "../include/ArgParse.h"
+#include "../include/ThreadPool.h"
+
+namespace {
+    constexpr uint64_t PROGRESS_INTERVAL = 100;
+
+    bool IsQuietMove(const BoardMove &boardMove, const std::unique_ptr<GameBoard> &gameBoard) {
+        if (boardMove.move.type == MoveType::EnPassant || boardMove.move.type == MoveType::Promotion) return false;
+        return gameBoard->GetPiece(boardMove.move.position).type == PieceType::None;
+    }
+}
+
+bool TrainingDataOptions::ParseArgs(int argc, char **argv) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--output" && hasValue) {
+            outputPrefix = argv[++i];
+        } else if (arg == "--games" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], games)) return false;
+        } else if (arg == "--depth" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], limits.depth)) return false;
+        } else if (arg == "--nodes" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], limits.nodes)) return false;
+        } else if (arg == "--random-plies" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], randomPlies)) return false;
+        } else if (arg == "--shard-size" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], shardPositions)) return false;
+        } else if (arg == "--seed" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], seed)) return false;
+        }
+    }
+    return true;
+}
+
+TrainingDataGenerator::TrainingDataGenerator(TrainingDataOptions options) : options(std::move(options)) {
+}
+
+int TrainingDataGenerator::Run() {
+    if (!writer.Open(options.outputPrefix, options.shardPositions)) return 1;
+
+    auto startTime = std::chrono::steady_clock::now();
+    ThreadPool& threadPool = ThreadPool::GetShared();
+    std::vector<std::unique_ptr<TrainingWorker>> workers(threadPool.GetWorkerCount());
+    TaskGroup taskGroup(threadPool);
+    taskGroup.RunRange(options.games, 1, [this, &workers](uint64_t gameIndex, uint64_t) {
+        std::unique_ptr<TrainingWorker>& worker = workers[ThreadPool::GetWorkerIndex()];
+        if (!worker) {
+            worker = std::make_unique<TrainingWorker>();
+            worker->buffer.reserve(TRAINING_BUFFER_POSITIONS);
+        }
+        RunGame(*worker, gameIndex);
+    });
+    taskGroup.Wait();
+    for (const std::unique_ptr<TrainingWorker>& worker : workers) {
+        if (worker) writer.Submit(worker->buffer);
+    }
+    bool written = writer.Close();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::cout << "games " << finishedGames << " positions " << writer.GetWritten()
+              << " positions/s " << static_cast<uint64_t>(writer.GetWritten() / std::max(seconds, 1e-9)) << '\n';
+    if (!written) {
+        std::cerr << "Failed to write training data to " << options.outputPrefix << '\n';
+        return 1;
+    }
+    return 0;
+}
+
+void TrainingDataGenerator::RunGame(TrainingWorker &worker, uint64_t gameIndex) {
+    PlayGame(worker.searcher, gameIndex, worker.gamePositions);
+    worker.buffer.insert(worker.buffer.end(), worker.gamePositions.begin(), worker.gamePositions.end());
+    if (worker.buffer.size() >= TRAINING_BUFFER_POSITIONS) writer.Submit(worker.buffer);
+
+    uint64_t finished = finishedGames.fetch_add(1) + 1;
+    if (finished % PROGRESS_INTERVAL == 0) {
+        std::cerr << "games " << finished << " positions " << writer.GetWritten() << '\n';
+    }
+}
+
+void TrainingDataGenerator::PlayGame(Searcher &searcher, uint64_t gameIndex, std::vector<PackedPosition> &gamePositions) const {
+    gamePositions.clear();
+    // Seeded per game so a run reproduces the same games whatever the thread count
+    std::mt19937_64 random(options.seed * 0x9E3779B97F4A7C15ULL + gameIndex);
+    searcher.ClearHash();
+
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    gameBoard->LoadDefaultBoard();
+    GameTracker gameTracker;
+    gameTracker.Reset(*gameBoard);
+    BoardMoveQuery moveQuery;
+
+    for (int ply = 0; ply < options.randomPlies; ply++) {
+        if (gameTracker.GetGameEnd(gameBoard, moveQuery).has_value()) return;
+        const BoardMove& boardMove = moveQuery.moves[random() % moveQuery.moveCount];
+        gameBoard->ExecuteMove(boardMove.move, boardMove.from);
+        gameTracker.Push(*gameBoard);
+    }
+
+    GameResult result = GameResult::Draw;
+    for (int ply = options.randomPlies; ply < TRAINING_MAX_PLIES; ply++) {
+        if (std::optional<GameEnd> gameEnd = gameTracker.GetGameEnd(gameBoard, moveQuery)) {
+            result = gameEnd->result;
+            break;
+        }
+
+        PieceColor sideToMove = gameBoard->GetSideToMove();
+        SearchResult searchResult = searcher.Search(gameBoard, options.limits);
+        // A found mate decides the game, playing it out adds nothing
+        if (searchResult.IsMateScore()) {
+            bool sideToMoveWins = searchResult.score > 0;
+            result = sideToMoveWins == (sideToMove == PieceColor::White) ? GameResult::WhiteWins : GameResult::BlackWins;
+            break;
+        }
+
+        const BoardMove boardMove = searchResult.bestMove.value_or(moveQuery.moves[0]);
+        // Tuning wants quiet positions whose score the static evaluation can explain
+        if (IsQuietMove(boardMove, gameBoard) && !MoveSearcher::IsInCheck(sideToMove, *gameBoard)) {
+            int whiteScore = sideToMove == PieceColor::White ? searchResult.score : -searchResult.score;
+            gamePositions.push_back(TrainingData::Pack(*gameBoard, whiteScore, GameResult::Draw, ply));
+        }
+
+        gameBoard->ExecuteMove(boardMove.move, boardMove.from);
+        gameTracker.Push(*gameBoard);
+    }
+
+    for (PackedPosition& packedPosition : gamePositions) {
+        TrainingData::SetResult(packedPosition, result);
+    }
+}
@@ -0,0 +1,109 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/TranspositionTable.h"
+
+#include <algorithm>
+
+#include "../include/Search.h"
+
+void TranspositionTable::Resize(size_t megabytes) {
+    // Power of two entries so the index is a mask
+    size_t count = std::max<size_t>(megabytes, 1) * 1024 * 1024 / sizeof(TTEntry);
+    size_t powerOfTwo = 1;
+    while (powerOfTwo * 2 <= count) {
+        powerOfTwo *= 2;
+    }
+    entries.assign(powerOfTwo, TTEntry{});
+    mask = powerOfTwo - 1;
+}
+
+void TranspositionTable::Clear() {
+    std::fill(entries.begin(), entries.end(), TTEntry{});
+}
+
+size_t TranspositionTable::GetSizeMb() const {
+    return entries.size() * sizeof(TTEntry) / (1024 * 1024);
+}
+
+const TTEntry* TranspositionTable::Probe(uint64_t key) const {
+    const TTEntry& entry = entries[key & mask];
+    return entry.key == key && entry.bound != TTBound::None ? &entry : nullptr;
+}
+
+void TranspositionTable::Store(uint64_t key, int depth, int score, TTBound bound, const std::optional<BoardMove> &move, int ply) {
+    TTEntry& entry = entries[key & mask];
+    if (entry.key == key && entry.depth > depth && bound != TTBound::Exact) return;
+
+    // Keep the old move when this search found none, it is still the best guess for ordering
+    uint16_t packedMove = move.has_value() ? PackMove(move.value()) : entry.key == key ? entry.move : 0;
+    entry = TTEntry{key, packedMove, static_cast<int16_t>(ToStoredScore(score, ply)), static_cast<int8_t>(depth), bound};
+}
+
+void TranspositionTable::Store(const TTEntry &entry) {
+    TTEntry& slot = entries[entry.key & mask];
+    if (slot.key == entry.key && slot.depth > entry.depth && entry.bound != TTBound::Exact) return;
+    slot = entry;
+}
+
+uint16_t TranspositionTable::PackMove(const BoardMove &boardMove) {
+    int promotion = boardMove.move.type == MoveType::Promotion ? static_cast<int>(boardMove.move.promotion) : 0;
+    return static_cast<uint16_t>(boardMove.from.GetBitMapPosition() | boardMove.move.position.GetBitMapPosition() << 6 | promotion << 12);
+}
+
+std::optional<BoardMove> TranspositionTable::FindMove(uint16_t packedMove, const BoardMoveQuery &moveQuery) {
+    if (packedMove == 0) return std::nullopt;
+    for (int i = 0; i < moveQuery.moveCount; i++) {
+        if (PackMove(moveQuery.moves[i]) == packedMove) return moveQuery.moves[i];
+    }
+    return std::nullopt;
+}
+
+int TranspositionTable::ToStoredScore(int score, int ply) {
+    // Mates and bitbase wins count plies from the root, the table needs them from the node
+    if (score >= KNOWN_WIN_SCORE - MAX_SEARCH_PLY) return score + ply;
+    if (score <= -KNOWN_WIN_SCORE + MAX_SEARCH_PLY) return score - ply;
+    return score;
+}
+
+int TranspositionTable::FromStoredScore(int score, int ply) {
+    if (score >= KNOWN_WIN_SCORE - MAX_SEARCH_PLY) return score - ply;
+    if (score <= -KNOWN_WIN_SCORE + MAX_SEARCH_PLY) return score + ply;
+    return score;
+}
+
+void SharedEntries::Publish(const TTEntry &entry) {
+    std::lock_guard lock(mutex);
+    if (published.size() >= SHARED_ENTRY_CAPACITY) published.erase(published.begin(), published.begin() + SHARED_ENTRY_CAPACITY / 2);
+    published.push_back(entry);
+}
+
+std::vector<TTEntry> SharedEntries::TakePublished() {
+    std::vector<TTEntry> taken;
+    std::lock_guard lock(mutex);
+    taken.swap(published);
+    return taken;
+}
+
+void SharedEntries::Receive(const std::vector<TTEntry> &entries) {
+    if (entries.empty()) return;
+    std::lock_guard lock(mutex);
+    if (received.size() + entries.size() > SHARED_ENTRY_CAPACITY) received.clear();
+    received.insert(received.end(), entries.begin(), entries.end());
+    hasReceived.store(true, std::memory_order_release);
+}
+
+void SharedEntries::MergeInto(TranspositionTable &table) {
+    // Checked on every clock poll, so the lock is only taken when there is something to merge
+    if (!hasReceived.load(std::memory_order_acquire)) return;
+    std::vector<TTEntry> merged;
+    {
+        std::lock_guard lock(mutex);
+        merged.swap(received);
+        hasReceived.store(false, std::memory_order_relaxed);
+    }
+    for (const TTEntry& entry : merged) {
+        table.Store(entry);
+    }
+}
@@ -0,0 +1,288 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/Tuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "../include/ArgParse.h"
+#include "../include/ThreadPool.h"
+#include "../include/TrainingData.h"
+
+namespace {
+    constexpr double ADAM_BETA1 = 0.9;
+    constexpr double ADAM_BETA2 = 0.999;
+    constexpr double ADAM_EPSILON = 1e-8;
+    constexpr int PROGRESS_INTERVAL = 50;
+    constexpr int SCALING_FACTOR_ITERATIONS = 40;
+
+    const char* TABLE_NAMES[EVAL_PIECE_TYPES] = {"KING_TABLE", "QUEEN_TABLE", "ROOK_TABLE", "KNIGHT_TABLE", "BISHOP_TABLE", "PAWN_TABLE"};
+
+    double GetScale(double scalingFactor) {
+        // 10^(-K * eval / 400) written as exp(-scale * eval)
+        return scalingFactor * std::log(10.0) / 400.0;
+    }
+}
+
+bool TunerOptions::ParseArgs(int argc, char **argv) {
+    // Skips the program name and the subcommand, every other bare argument is an input file
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], threads)) return false;
+        } else if (arg == "--pin" && hasValue) {
+            i++; // the shared thread pool reads it
+        } else if (arg == "--epochs" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], epochs)) return false;
+        } else if (arg == "--lr" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], learningRate)) return false;
+        } else if (arg == "--lambda" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], lambda)) return false;
+        } else if (arg == "--k" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], scalingFactor)) return false;
+        } else if (arg == "--max-positions" && hasValue) {
+            if (!ParseNumber(arg, argv[++i], maxPositions)) return false;
+        } else if (arg == "--output" && hasValue) {
+            outputPath = argv[++i];
+        } else {
+            inputPaths.push_back(arg);
+        }
+    }
+    return true;
+}
+
+Tuner::Tuner(TunerOptions options) : options(std::move(options)) {
+    if (this->options.threads <= 0) {
+        this->options.threads = ThreadPool::GetShared().GetWorkerCount();
+    }
+    std::array<int, EVAL_PARAMETER_COUNT> initialParameters = Evaluator::GetParameters();
+    parameters.assign(initialParameters.begin(), initialParameters.end());
+}
+
+int Tuner::Run() {
+    auto startTime = std::chrono::steady_clock::now();
+    if (!Load()) return 1;
+    size_t positionCount = tuningSet.GetPositionCount();
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "positions " << positionCount << " terms " << tuningSet.terms.size() << " loaded in " << loadSeconds << "s\n";
+    if (positionCount == 0) return 1;
+
+    // K is fitted against the results alone, the blended target needs it for the score part
+    tuningSet.targets = tuningSet.results;
+    double scalingFactor = options.scalingFactor > 0 ? options.scalingFactor : FitScalingFactor();
+    double scale = GetScale(scalingFactor);
+    for (size_t i = 0; i < positionCount; i++) {
+        double scoreTarget = 1.0 / (1.0 + std::exp(-scale * tuningSet.scores[i]));
+        tuningSet.targets[i] = static_cast<float>(options.lambda * tuningSet.results[i] + (1 - options.lambda) * scoreTarget);
+    }
+    std::cout << "K " << scalingFactor << " initial error " << ComputeError(scalingFactor, nullptr) << '\n';
+
+    std::vector<double> gradient(EVAL_PARAMETER_COUNT);
+    std::vector<double> firstMoment(EVAL_PARAMETER_COUNT);
+    std::vector<double> secondMoment(EVAL_PARAMETER_COUNT);
+    auto tuneStart = std::chrono::steady_clock::now();
+    for (int epoch = 1; epoch <= options.epochs; epoch++) {
+        double error = ComputeError(scalingFactor, &gradient);
+
+        double firstCorrection = 1 - std::pow(ADAM_BETA1, epoch);
+        double secondCorrection = 1 - std::pow(ADAM_BETA2, epoch);
+        for (int i = 0; i < EVAL_PARAMETER_COUNT; i++) {
+            firstMoment[i] = ADAM_BETA1 * firstMoment[i] + (1 - ADAM_BETA1) * gradient[i];
+            secondMoment[i] = ADAM_BETA2 * secondMoment[i] + (1 - ADAM_BETA2) * gradient[i] * gradient[i];
+            double step = (firstMoment[i] / firstCorrection) / (std::sqrt(secondMoment[i] / secondCorrection) + ADAM_EPSILON);
+            parameters[i] -= options.learningRate * step;
+        }
+
+        if (epoch % PROGRESS_INTERVAL == 0 || epoch == options.epochs) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - tuneStart).count();
+            std::cout << "epoch " << epoch << " error " << std::setprecision(8) << error << std::setprecision(6)
+                      << " seconds/epoch " << seconds / epoch << '\n';
+        }
+    }
+
+    std::cout << "final error " << std::setprecision(8) << ComputeError(scalingFactor, nullptr) << std::setprecision(6) << '\n';
+    if (!WriteParameters()) {
+        std::cerr << "Failed to write " << options.outputPath << '\n';
+        return 1;
+    }
+    std::cout << "wrote " << options.outputPath << '\n';
+    return 0;
+}
+
+bool Tuner::Load() {
+    for (const std::string& inputPath : options.inputPaths) {
+        TrainingDataReader reader;
+        if (!reader.Open(inputPath)) {
+            std::cerr << "Failed to open training data: " << inputPath << '\n';
+            return false;
+        }
+        std::span<const PackedPosition> positions = reader.GetPositions();
+        if (options.maxPositions > 0) {
+            positions = positions.first(std::min<uint64_t>(positions.size(), options.maxPositions - tuningSet.GetPositionCount()));
+        }
+
+        // Every thread decodes its own slice, the slices are appended in order afterwards
+        std::vector<TuningSet> parts(options.threads);
+        ParallelFor(positions.size(), [&positions, &parts](int thread, size_t start, size_t end) {
+            TuningSet& part = parts[thread];
+            part.termOffsets.reserve(end - start);
+            part.results.reserve(end - start);
+            part.scores.reserve(end - start);
+            GameBoard gameBoard;
+            std::array<EvalCoefficient, EVAL_MAX_COEFFICIENTS> coefficients;
+            for (size_t i = start; i < end; i++) {
+                if (!TrainingData::Unpack(positions[i], gameBoard)) continue;
+
+                part.termOffsets.push_back(part.terms.size());
+                int count = Evaluator::GetCoefficients(gameBoard, coefficients);
+                for (int j = 0; j < count; j++) {
+                    part.terms.push_back(PackTerm(coefficients[j].index, coefficients[j].value));
+                }
+                part.results.push_back(positions[i].result * 0.5f);
+                part.scores.push_back(positions[i].score);
+            }
+        });
+
+        for (const TuningSet& part : parts) {
+            uint64_t termBase = tuningSet.terms.size();
+            for (uint64_t offset : part.termOffsets) {
+                tuningSet.termOffsets.push_back(termBase + offset);
+            }
+            tuningSet.terms.insert(tuningSet.terms.end(), part.terms.begin(), part.terms.end());
+            tuningSet.results.insert(tuningSet.results.end(), part.results.begin(), part.results.end());
+            tuningSet.scores.insert(tuningSet.scores.end(), part.scores.begin(), part.scores.end());
+        }
+        if (options.maxPositions > 0 && tuningSet.GetPositionCount() >= options.maxPositions) break;
+    }
+    tuningSet.termOffsets.push_back(tuningSet.terms.size());
+    return true;
+}
+
+double Tuner::FitScalingFactor() {
+    // Golden section search, the error is unimodal in K
+    const double ratio = (std::sqrt(5.0) - 1) / 2;
+    double low = 0.05, high = 5.0;
+    double left = high - ratio * (high - low);
+    double right = low + ratio * (high - low);
+    double leftError = ComputeError(left, nullptr);
+    double rightError = ComputeError(right, nullptr);
+    for (int i = 0; i < SCALING_FACTOR_ITERATIONS; i++) {
+        if (leftError < rightError) {
+            high = right;
+            right = left;
+            rightError = leftError;
+            left = high - ratio * (high - low);
+            leftError = ComputeError(left, nullptr);
+        } else {
+            low = left;
+            left = right;
+            leftError = rightError;
+            right = low + ratio * (high - low);
+            rightError = ComputeError(right, nullptr);
+        }
+    }
+    return (low + high) / 2;
+}
+
+double Tuner::ComputeError(double scalingFactor, std::vector<double>* gradient) const {
+    double scale = GetScale(scalingFactor);
+    std::vector<double> errors(options.threads);
+    std::vector<std::vector<double>> gradients(gradient != nullptr ? options.threads : 0, std::vector<double>(EVAL_PARAMETER_COUNT));
+
+    ParallelFor(tuningSet.GetPositionCount(), [this, scale, &errors, &gradients](int thread, size_t start, size_t end) {
+        const double* weights = parameters.data();
+        const uint64_t* offsets = tuningSet.termOffsets.data();
+        const uint16_t* terms = tuningSet.terms.data();
+        const float* targets = tuningSet.targets.data();
+        double* threadGradient = gradients.empty() ? nullptr : gradients[thread].data();
+
+        double error = 0;
+        for (size_t i = start; i < end; i++) {
+            double evaluation = 0;
+            for (uint64_t t = offsets[i]; t < offsets[i + 1]; t++) {
+                evaluation += weights[GetTermIndex(terms[t])] * GetTermCoefficient(terms[t]);
+            }
+            double sigmoid = 1.0 / (1.0 + std::exp(-scale * evaluation));
+            double difference = sigmoid - targets[i];
+            error += difference * difference;
+            if (threadGradient == nullptr) continue;
+
+            double factor = 2 * difference * scale * sigmoid * (1 - sigmoid);
+            for (uint64_t t = offsets[i]; t < offsets[i + 1]; t++) {
+                threadGradient[GetTermIndex(terms[t])] += factor * GetTermCoefficient(terms[t]);
+            }
+        }
+        errors[thread] = error;
+    });
+
+    double positionCount = static_cast<double>(tuningSet.GetPositionCount());
+    if (gradient != nullptr) {
+        std::fill(gradient->begin(), gradient->end(), 0.0);
+        for (const std::vector<double>& threadGradient : gradients) {
+            for (int i = 0; i < EVAL_PARAMETER_COUNT; i++) {
+                (*gradient)[i] += threadGradient[i] / positionCount;
+            }
+        }
+    }
+    double error = 0;
+    for (double threadError : errors) error += threadError;
+    return error / positionCount;
+}
+
+void Tuner::ParallelFor(size_t count, const std::function<void(int, size_t, size_t)> &body) const {
+    // Fixed contiguous slices, so results can be merged in slice order whichever worker ran them
+    TaskGroup taskGroup;
+    for (int slice = 0; slice < options.threads; slice++) {
+        taskGroup.Run([this, &body, count, slice] {
+            body(slice, count * slice / options.threads, count * (slice + 1) / options.threads);
+        });
+    }
+    taskGroup.Wait();
+}
+
+bool Tuner::WriteParameters() const {
+    std::ofstream output(options.outputPath);
+    if (!output) return false;
+
+    // Same layout as the tables in Evaluator.cpp so they can be pasted over them
+    output << "constexpr int PIECE_VALUES[] = {0";
+    for (int type = 0; type < EVAL_PIECE_TYPES; type++) {
+        output << ", " << std::lround(parameters[type]);
+    }
+    output << "};\n";
+
+    for (int type = 0; type < EVAL_PIECE_TYPES; type++) {
+        output << "\nconstexpr int " << TABLE_NAMES[type] << "[GRID_SIZE][GRID_SIZE] = {\n";
+        for (int row = 0; row < GRID_SIZE; row++) {
+            output << "    {";
+            for (int col = 0; col < GRID_SIZE; col++) {
+                long value = std::lround(parameters[EVAL_TABLE_OFFSET + type * BOARD_SIZE + row * GRID_SIZE + col]);
+                output << std::setw(4) << value << (col + 1 < GRID_SIZE ? "," : "");
+            }
+            output << (row + 1 < GRID_SIZE ? "},\n" : "}\n");
+        }
+        output << "};\n";
+    }
+    return static_cast<bool>(output);
+}
+
+uint16_t Tuner::PackTerm(int index, int coefficient) {
+    return static_cast<uint16_t>(index << TUNER_COEFFICIENT_BITS | (coefficient & ((1 << TUNER_COEFFICIENT_BITS) - 1)));
+}
+
+int Tuner::GetTermIndex(uint16_t term) {
+    return term >> TUNER_COEFFICIENT_BITS;
+}
+
+int Tuner::GetTermCoefficient(uint16_t term) {
+    // Sign extend the low bits
+    int coefficient = term & ((1 << TUNER_COEFFICIENT_BITS) - 1);
+    return coefficient >= (1 << (TUNER_COEFFICIENT_BITS - 1)) ? coefficient - (1 << TUNER_COEFFICIENT_BITS) : coefficient;
+}
@@ -0,0 +1,124 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+#include "../include/Zobrist.h"
+
+#include <fstream>
+
+uint64_t Zobrist::ComputeKey(const GameBoard &gameBoard, const ZobristKeys &zobristKeys) {
+    uint64_t key = 0;
+    for (short row = 0; row < GRID_SIZE; row++) {
+        for (short col = 0; col < GRID_SIZE; col++) {
+            PiecePosition piecePosition{row, col};
+            const Piece& piece = gameBoard.GetPiece(piecePosition);
+            if (piece.type == PieceType::None) continue;
+            key ^= zobristKeys.keys[GetPieceKeyIndex(piece, piecePosition)];
+        }
+    }
+
+    uint8_t castleRights = GetCastleRights(gameBoard);
+    for (int i = 0; i < 4; i++) {
+        if (castleRights & (1 << i)) key ^= zobristKeys.keys[ZOBRIST_CASTLE_OFFSET + i];
+    }
+
+    if (std::optional<int> enPassantFile = GetEnPassantFile(gameBoard)) {
+        key ^= zobristKeys.keys[ZOBRIST_EN_PASSANT_OFFSET + enPassantFile.value()];
+    }
+
+    if (gameBoard.GetSideToMove() == PieceColor::White) {
+        key ^= zobristKeys.keys[ZOBRIST_TURN_OFFSET];
+    }
+    return key;
+}
+
+const ZobristKeys & Zobrist::GetEngineKeys() {
+    static const ZobristKeys engineKeys = [] {
+        // SplitMix64, so every build hashes positions the same way
+        ZobristKeys zobristKeys;
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for (uint64_t& key : zobristKeys.keys) {
+            uint64_t value = (state += 0x9E3779B97F4A7C15ULL);
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+            key = value ^ (value >> 31);
+        }
+        return zobristKeys;
+    }();
+    return engineKeys;
+}
+
+bool Zobrist::LoadKeys(const std::string &path, ZobristKeys &zobristKeys) {
+    std::ifstream input(path);
+    if (!input) return false;
+
+    std::string line;
+    int count = 0;
+    while (count < ZOBRIST_KEY_COUNT && std::getline(input, line)) {
+        size_t start = line.find_first_not_of(" \t\r,");
+        if (start == std::string::npos) continue;
+        try {
+            zobristKeys.keys[count++] = std::stoull(line.substr(start), nullptr, 16);
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return count == ZOBRIST_KEY_COUNT;
+}
+
+int Zobrist::GetPieceKeyIndex(const Piece &piece, PiecePosition piecePosition) {
+    // Polyglot orders kinds as pawn, knight, bishop, rook, queen, king with black before white
+    int kind;
+    switch (piece.type) {
+        case PieceType::Pawn: kind = 0; break;
+        case PieceType::Knight: kind = 2; break;
+        case PieceType::Bishop: kind = 4; break;
+        case PieceType::Rook: kind = 6; break;
+        case PieceType::Queen: kind = 8; break;
+        default: kind = 10; break;
+    }
+    if (piece.color == PieceColor::White) kind++;
+
+    int file = GRID_SIZE - piecePosition.col - 1;
+    return 64 * kind + 8 * piecePosition.row + file;
+}
+
+uint8_t Zobrist::GetCastleRights(const GameBoard &gameBoard) {
+    uint8_t castleRights = CastleNone;
+    for (PieceColor color : {PieceColor::White, PieceColor::Black}) {
+        short homeRow = color == PieceColor::White ? 0 : GRID_SIZE - 1;
+        const Piece& king = gameBoard.GetPiece(PiecePosition{homeRow, 3});
+        if (king.type != PieceType::King || king.color != color || king.moveState != PieceMoveState::NotMoved) continue;
+
+        const Piece& shortRook = gameBoard.GetPiece(PiecePosition{homeRow, 0});
+        const Piece& longRook = gameBoard.GetPiece(PiecePosition{homeRow, GRID_SIZE - 1});
+        bool shortRight = shortRook.type == PieceType::Rook && shortRook.color == color && shortRook.moveState == PieceMoveState::NotMoved;
+        bool longRight = longRook.type == PieceType::Rook && longRook.color == color && longRook.moveState == PieceMoveState::NotMoved;
+
+        if (color == PieceColor::White) {
+            if (shortRight) castleRights |= WhiteShort;
+            if (longRight) castleRights |= WhiteLong;
+        } else {
+            if (shortRight) castleRights |= BlackShort;
+            if (longRight) castleRights |= BlackLong;
+        }
+    }
+    return castleRights;
+}
+
+std::optional<int> Zobrist::GetEnPassantFile(const GameBoard &gameBoard) {
+    const PieceMoveHistory& lastMove = gameBoard.GetLastMove();
+    if (lastMove.piece.type != PieceType::Pawn || lastMove.move.type != MoveType::DoublePawnPush) return std::nullopt;
+
+    PiecePosition pawnPosition = lastMove.move.position;
+    PieceColor sideToMove = gameBoard.GetSideToMove();
+    for (int dx : {-1, 1}) {
+        PiecePosition adjacentPosition(pawnPosition.row, pawnPosition.col + dx);
+        if (adjacentPosition.OutOfBounds()) continue;
+        const Piece& piece = gameBoard.GetPiece(adjacentPosition);
+        if (piece.type == PieceType::Pawn && piece.color == sideToMove) {
+            return GRID_SIZE - pawnPosition.col - 1;
+        }
+    }
+    return std::nullopt;
+}
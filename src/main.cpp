@@ -1,28 +1,322 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 #include <SFML/Graphics.hpp>
 
+#include "../include/ArgParse.h"
+#include "../include/BatchAnalyzer.h"
+#include "../include/BitbaseGenerator.h"
 #include "../include/BoardRenderer.h"
+#include "../include/Cluster.h"
 #include "../include/Debug.h"
+#include "../include/EngineOpponent.h"
+#include "../include/GameIndex.h"
+#include "../include/GameServer.h"
+#include "../include/LiveAnalysis.h"
+#include "../include/MateSolver.h"
+#include "../include/MatchRunner.h"
+#include "../include/Notation.h"
+#include "../include/Perft.h"
+#include "../include/PgnReader.h"
+#include "../include/PolyglotBook.h"
+#include "../include/PositionPublisher.h"
+#include "../include/SearchBench.h"
+#include "../include/Stats.h"
+#include "../include/ThreadPool.h"
+#include "../include/Tracer.h"
+#include "../include/TrainingDataGenerator.h"
+#include "../include/Tuner.h"
+
+static int RunPgnReplay(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: ChessEngine pgn <file> [--threads N]\n";
+        return 1;
+    }
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 3; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--threads" && !ParseNumber(argv[i], argv[i + 1], threads)) return 1;
+    }
+
+    PgnReader pgnReader;
+    if (!pgnReader.Open(argv[2])) {
+        std::cerr << "Failed to open PGN: " << argv[2] << '\n';
+        return 1;
+    }
+
+    std::atomic<uint64_t> reportedErrors = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    PgnReadStats stats = pgnReader.Read(threads, [&reportedErrors](const PgnGame& game, const std::unique_ptr<GameBoard>&) {
+        if (game.errorToken.empty() || reportedErrors.fetch_add(1) >= 10) return;
+        std::cerr << "Game at byte " << game.offset << ": cannot resolve " << game.errorToken << '\n';
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::cout << "games " << stats.games << " moves " << stats.moves << " errors " << stats.errors
+              << " moves/s " << static_cast<uint64_t>(stats.moves / std::max(seconds, 1e-9)) << '\n';
+    return 0;
+}
+
+static int RunBookProbe(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: ChessEngine book <book.bin> [fen] [--keys path]\n";
+        return 1;
+    }
+    std::string fen;
+    std::string keysPath = POLYGLOT_KEYS_PATH;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--keys" && i + 1 < argc) {
+            keysPath = argv[++i];
+        } else {
+            fen = arg;
+        }
+    }
+
+    PolyglotBook book;
+    if (!book.Open(argv[2], keysPath)) return 1;
+
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    if (fen.empty()) {
+        gameBoard->LoadDefaultBoard();
+    } else if (!gameBoard->LoadFen(fen)) {
+        std::cerr << "Invalid FEN: " << fen << '\n';
+        return 1;
+    }
+
+    std::array<BookMove, 64> bookMoves;
+    int count = book.GetBookMoves(gameBoard, bookMoves);
+    std::cout << "key " << std::hex << book.GetKey(gameBoard) << std::dec << '\n';
+    for (int i = 0; i < count; i++) {
+        std::cout << Notation::GetMoveName(bookMoves[i].boardMove) << ' ' << bookMoves[i].weight << '\n';
+    }
+    return 0;
+}
+
+static int RunShuffle(int argc, char** argv) {
+    if (argc < 5) {
+        std::cerr << "Usage: ChessEngine shuffle <output prefix> <shards> <input.pos>... [--seed N]\n";
+        return 1;
+    }
+    uint64_t seed = 1;
+    std::vector<std::string> inputPaths;
+    for (int i = 4; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            if (!ParseNumber(arg, argv[++i], seed)) return 1;
+        } else {
+            inputPaths.push_back(arg);
+        }
+    }
+    int shards = 0;
+    if (!ParseNumber("<shards>", argv[3], shards)) return 1;
+    return TrainingData::Shuffle(inputPaths, argv[2], shards, seed) ? 0 : 1;
+}
+
+static int RunCluster(int argc, char** argv) {
+#ifndef CHESSENGINE_NETWORK
+    std::cerr << "Clustering is compiled out, it needs epoll on Linux\n";
+    return 1;
+#else
+    ClusterOptions clusterOptions;
+    if (!clusterOptions.ParseArgs(argc, argv)) return 1;
+    if (clusterOptions.mode == "worker") {
+        ClusterWorker clusterWorker(clusterOptions);
+        return clusterWorker.Run();
+    }
+    if (clusterOptions.mode == "search") {
+        ClusterCoordinator clusterCoordinator(clusterOptions);
+        return clusterCoordinator.Run();
+    }
+    std::cerr << "Usage: ChessEngine cluster worker [--port N] [--bind address] [--hash MB]\n"
+              << "       ChessEngine cluster search [fen] --peers host:port,... [--depth N] [--hash MB] [--compare]\n";
+    return 1;
+#endif
+}
+
+static int RunGameIndex(int argc, char** argv) {
+    GameIndexOptions indexOptions;
+    if (!indexOptions.ParseArgs(argc, argv)) return 1;
+    if (indexOptions.mode == "build" && !indexOptions.indexPath.empty()) {
+        GameIndexBuilder gameIndexBuilder(indexOptions);
+        return gameIndexBuilder.Run();
+    }
+    if (indexOptions.mode != "query" || indexOptions.indexPath.empty()) {
+        std::cerr << "Usage: ChessEngine index build <games.pgn> <out.idx> [--threads N] [--memory MB] [--temp dir] [--max-ply N]\n"
+                  << "       ChessEngine index query <games.idx> [fen] [--games N]\n";
+        return 1;
+    }
+
+    GameIndex gameIndex;
+    if (!gameIndex.Open(indexOptions.indexPath)) return 1;
+    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+    if (indexOptions.fen.empty()) {
+        gameBoard->LoadDefaultBoard();
+    } else if (!gameBoard->LoadFen(indexOptions.fen)) {
+        std::cerr << "Invalid FEN: " << indexOptions.fen << '\n';
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    GameIndexQuery query = gameIndex.Query(*gameBoard, indexOptions.gameLimit);
+    auto queryTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+    PieceColor sideToMove = gameBoard->GetSideToMove();
+    std::cout << std::fixed << std::setprecision(3) << "games " << query.total.games << " white " << query.total.whiteWins
+              << " draws " << query.total.draws << " black " << query.total.blackWins << " time_us " << queryTime << '\n';
+    for (const GameIndexMoveStats& moveStats : query.moves) {
+        std::cout << Notation::GetSanName(moveStats.boardMove, gameBoard) << " games " << moveStats.score.games
+                  << " white " << moveStats.score.whiteWins << " draws " << moveStats.score.draws << " black " << moveStats.score.blackWins
+                  << " score " << moveStats.score.GetScore(sideToMove) << '\n';
+    }
+    for (uint64_t gameOffset : query.gameOffsets) {
+        std::cout << "game at byte " << gameOffset << '\n';
+    }
+    return 0;
+}
+
+// Headless modes never open a window, returns nothing when the command is the GUI
+static std::optional<int> RunHeadlessCommand(int argc, char** argv) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "batch") {
+        BatchOptions batchOptions;
+        if (!batchOptions.ParseArgs(argc, argv)) return 1;
+        BatchAnalyzer batchAnalyzer(batchOptions);
+        return batchAnalyzer.Run();
+    }
+    if (command == "pgn") {
+        return RunPgnReplay(argc, argv);
+    }
+    if (command == "book") {
+        return RunBookProbe(argc, argv);
+    }
+    if (command == "match") {
+        MatchOptions matchOptions;
+        if (!matchOptions.ParseArgs(argc, argv)) return 1;
+        MatchRunner matchRunner(matchOptions);
+        return matchRunner.Run();
+    }
+    if (command == "datagen") {
+        TrainingDataOptions trainingOptions;
+        if (!trainingOptions.ParseArgs(argc, argv)) return 1;
+        TrainingDataGenerator trainingDataGenerator(trainingOptions);
+        return trainingDataGenerator.Run();
+    }
+    if (command == "shuffle") {
+        return RunShuffle(argc, argv);
+    }
+    if (command == "tune") {
+        TunerOptions tunerOptions;
+        if (!tunerOptions.ParseArgs(argc, argv)) return 1;
+        Tuner tuner(tunerOptions);
+        return tuner.Run();
+    }
+    if (command == "bench") {
+        SearchBenchOptions benchOptions;
+        if (!benchOptions.ParseArgs(argc, argv)) return 1;
+        SearchBench searchBench(benchOptions);
+        return searchBench.Run();
+    }
+    if (command == "serve") {
+#ifdef CHESSENGINE_NETWORK
+        GameServerOptions serverOptions;
+        if (!serverOptions.ParseArgs(argc, argv)) return 1;
+        GameServer gameServer(serverOptions);
+        return gameServer.Run();
+#else
+        std::cerr << "The server is compiled out, it needs epoll on Linux\n";
+        return 1;
+#endif
+    }
+    if (command == "mate") {
+        MateSolverOptions mateOptions;
+        if (!mateOptions.ParseArgs(argc, argv)) return 1;
+        MateSolver mateSolver(mateOptions);
+        return mateSolver.Run();
+    }
+    if (command == "cluster") {
+        return RunCluster(argc, argv);
+    }
+    if (command == "index") {
+        return RunGameIndex(argc, argv);
+    }
+    if (command == "perft") {
+        PerftOptions perftOptions;
+        if (!perftOptions.ParseArgs(argc, argv)) return 1;
+        Perft perft(perftOptions);
+        return perft.Run();
+    }
+    if (command == "bitbase") {
+        BitbaseGeneratorOptions generatorOptions;
+        if (!generatorOptions.ParseArgs(argc, argv)) return 1;
+        BitbaseGenerator bitbaseGenerator(generatorOptions);
+        return bitbaseGenerator.Run();
+    }
+    return std::nullopt;
+}
+
+static void StartRun(const DebugOptions &debugOptions) {
+    if (debugOptions.tracePath.empty()) return;
+    if (!Tracer::IsCompiled()) {
+        std::cerr << "Tracing is compiled out, rebuild with CHESSENGINE_TRACE\n";
+        return;
+    }
+    Tracer::Start(debugOptions.traceSampleInterval);
+}
+
+static int FinishRun(int exitCode, const DebugOptions &debugOptions) {
+    if (debugOptions.flags & StatsOverlay) Stats::WriteJson(std::cerr, Stats::Snapshot());
+    if (Tracer::IsActive()) {
+        Tracer::Stop();
+        if (!Tracer::WriteJson(debugOptions.tracePath) && exitCode == 0) exitCode = 1;
+    }
+    return exitCode;
+}
 
 int main(int argc, char** argv) {
     DebugOptions debugOptions;
-    for (int i = 0; i < argc; i++) {
-        debugOptions.ParseArg(argv[i]);
+    if (!debugOptions.ParseArgs(argc, argv)) return 1;
+    StartRun(debugOptions);
+    ThreadPoolOptions threadPoolOptions;
+    if (!threadPoolOptions.ParseArgs(argc, argv)) return 1;
+    ThreadPool::Configure(threadPoolOptions);
+
+    if (std::optional<int> exitCode = RunHeadlessCommand(argc, argv)) {
+        return FinishRun(exitCode.value(), debugOptions);
     }
 
     std::cout << "Program starting with flags " << static_cast<int>(debugOptions.flags) << '\n';
 
-    std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
-    gameBoard->LoadDefaultBoard();
+    GameBoard startBoard;
+    startBoard.LoadDefaultBoard();
+    PositionPublisher positionPublisher(startBoard);
 
     // May want to increase window size later when ui is needed
     std::unique_ptr<sf::RenderWindow> window = std::make_unique<sf::RenderWindow>(sf::VideoMode({GRID_SIZE*TILE_SIZE, GRID_SIZE*TILE_SIZE}), "Chess Engine");
     window->setFramerateLimit(144);
 
-    std::unique_ptr<BoardRenderer> boardRenderer = std::make_unique<BoardRenderer>(gameBoard, PieceColor::Black,debugOptions);
+    std::unique_ptr<BoardRenderer> boardRenderer = std::make_unique<BoardRenderer>(positionPublisher, PieceColor::Black,debugOptions);
     boardRenderer->LoadChessIcon(window);
 
+    EngineOpponentOptions engineOptions;
+    if (!engineOptions.ParseArgs(argc, argv)) return 1;
+    EngineOpponent engineOpponent(engineOptions);
+    if (engineOptions.color.has_value()) boardRenderer->LockColor(engineOptions.color.value());
+
+    LiveAnalysisOptions analysisOptions;
+    if (!analysisOptions.ParseArgs(argc, argv)) return 1;
+    LiveAnalysis liveAnalysis(analysisOptions);
+
+    OpeningExplorerOptions explorerOptions;
+    if (!explorerOptions.ParseArgs(argc, argv)) return 1;
+    OpeningExplorer openingExplorer(explorerOptions);
+
     while (window->isOpen())
     {
         while (const std::optional event = window->pollEvent())
@@ -41,9 +335,27 @@ int main(int argc, char** argv) {
             }
         }
 
+        engineOpponent.Update(positionPublisher);
+        if (std::optional<BoardMove> engineMove = engineOpponent.PollMove()) {
+            boardRenderer->ApplyMove(engineMove.value());
+        }
+        liveAnalysis.Update(positionPublisher);
+        if (std::optional<SearchResult> analysis = liveAnalysis.PollResult()) {
+            boardRenderer->SetAnalysisLines(analysis->lines);
+        }
+        if (std::optional<GameIndexQuery> openingStats = openingExplorer.Update(positionPublisher)) {
+            boardRenderer->SetOpeningStats(openingStats.value());
+        }
+
         window->clear();
 
         boardRenderer->Render(window);
         window->display();
+        boardRenderer->OnFrameDisplayed();
+    }
+    if (!boardRenderer->WriteFrameTimes(debugOptions.frameCsvPath)) {
+        std::cerr << "Failed to write frame times to " << debugOptions.frameCsvPath << '\n';
+        return FinishRun(1, debugOptions);
     }
+    return FinishRun(0, debugOptions);
 }
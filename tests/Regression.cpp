@@ -0,0 +1,112 @@
+//
+// Created by Isaac on 2026-10-19.
+//
+
+// Known-answer checks run by ctest: perft node counts for move generation and short mates for the mate solver.
+// Each mode prints every failure and exits with 1 if there was one
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "../include/MateSolver.h"
+#include "../include/Notation.h"
+#include "../include/Perft.h"
+
+namespace {
+    struct PerftCase {
+        const char* fen;
+        int depth;
+        uint64_t nodes;
+    };
+
+    // The standard positions from the chess programming wiki, deep enough to reach castling, en passant and promotions
+    constexpr PerftCase PERFT_CASES[] = {
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281},
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3, 97862},
+        {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+        {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+        {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 3, 62379},
+        {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 3, 89890},
+    };
+
+    struct MateCase {
+        const char* fen;
+        int maxMoves;
+        int moves; // 0 when there is no mate within maxMoves
+        const char* firstMove;
+    };
+
+    constexpr MateCase MATE_CASES[] = {
+        {"6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", 3, 1, "d1d8"},
+        {"r1bqkb1r/pppp1ppp/2n2n2/4p2Q/2B1P3/8/PPPP1PPP/RNB1K1NR w KQkq - 4 4", 3, 1, "h5f7"},
+        // Philidor's smothered mate
+        {"5r1k/6pp/7N/8/8/1Q6/8/6K1 w - - 0 1", 3, 2, "b3g8"},
+        {"r1b1kb1r/pppp1ppp/5q2/4n3/3KP3/2N3PN/PPP4P/R1BQ1BR1 b kq - 0 1", 4, 3, "f8c5"},
+        {"7k/8/5K2/8/8/8/8/1R6 w - - 0 1", 3, 0, ""},
+    };
+
+    bool LoadPosition(const char* fen, GameBoard &gameBoard) {
+        if (gameBoard.LoadFen(fen)) return true;
+        std::cerr << "Invalid FEN: " << fen << '\n';
+        return false;
+    }
+
+    int CheckPerft() {
+        int failures = 0;
+        for (const PerftCase& perftCase : PERFT_CASES) {
+            GameBoard gameBoard;
+            if (!LoadPosition(perftCase.fen, gameBoard)) {
+                failures++;
+                continue;
+            }
+            // Every batched count is redone with MoveSearcher, so the kernels and the searcher are both checked
+            PerftOptions options;
+            options.verify = true;
+            Perft perft(options);
+            PerftResult result = perft.Count(gameBoard, perftCase.depth);
+            if (result.nodes != perftCase.nodes || result.mismatches != 0) {
+                std::cerr << "perft " << perftCase.depth << " of " << perftCase.fen << ": " << result.nodes
+                          << " nodes, expected " << perftCase.nodes << ", " << result.mismatches << " mismatches\n";
+                failures++;
+            }
+        }
+        return failures;
+    }
+
+    int CheckMates() {
+        int failures = 0;
+        for (const MateCase& mateCase : MATE_CASES) {
+            std::unique_ptr<GameBoard> gameBoard = std::make_unique<GameBoard>();
+            if (!LoadPosition(mateCase.fen, *gameBoard)) {
+                failures++;
+                continue;
+            }
+            MateSolver mateSolver(MateSolverOptions{});
+            MateSolverResult result = mateSolver.Solve(gameBoard, mateCase.maxMoves);
+            int moves = result.mate ? result.moves : 0;
+            std::string firstMove = result.line.empty() ? "" : Notation::GetMoveName(result.line.front());
+            if (moves != mateCase.moves || firstMove != mateCase.firstMove) {
+                std::cerr << "mate search of " << mateCase.fen << ": mate in " << moves << " starting " << firstMove
+                          << ", expected mate in " << mateCase.moves << " starting " << mateCase.firstMove << '\n';
+                failures++;
+            }
+        }
+        return failures;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    int failures;
+    if (mode == "perft") {
+        failures = CheckPerft();
+    } else if (mode == "mate") {
+        failures = CheckMates();
+    } else {
+        std::cerr << "Usage: chess_regression perft|mate\n";
+        return 1;
+    }
+    return failures == 0 ? 0 : 1;
+}